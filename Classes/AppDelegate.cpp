@@ -30,6 +30,9 @@
 
 #include "AppDelegate.h"
 #include "PictogramGridScene.h"
+#include "PictogramNode.h"
+#include "PictoSettings.h"
+#include "PictoTextureCache.h"
 
 USING_NS_CC;
 
@@ -37,6 +40,7 @@ AppDelegate::AppDelegate() {
 }
 
 AppDelegate::~AppDelegate() {
+    PictogramNode::purgePool();
     picto::database::unload();
 }
 
@@ -59,8 +63,21 @@ bool AppDelegate::applicationDidFinishLaunching() {
     
     picto::database::load();
     
+    // Loaded on the main thread, before any worker reads it
+    PictoSettings::sharedSettings();
+    
+    // Chrome shared by all the scenes stays loaded across navigations
+    PictoTextureCache::pin("white_frame.png");
+    PictoTextureCache::pin("speaker.png");
+    PictoTextureCache::pin("speaker_background.png");
+    PictoTextureCache::pin("back_button_background_normal.png");
+    PictoTextureCache::pin("back_button_background_pressed.png");
+    PictoTextureCache::pin("back_button_normal.png");
+    PictoTextureCache::pin("back_button_pressed.png");
+    PictoTextureCache::pin("settings.png");
+    
     // create a scene. it's an autorelease object
-    CCArray* pictograms = CCArray::create(CCString::create("picto_connection"), NULL);
+    CCArray* pictograms = CCArray::create(CCString::create(ROOT_PICTOGRAM), NULL);
     CCScene *scene = PictogramGrid::scene(pictograms);
 
     // run
@@ -72,9 +89,19 @@ bool AppDelegate::applicationDidFinishLaunching() {
 // This function will be called when the app is inactive. When comes a phone call,it's be invoked too
 void AppDelegate::applicationDidEnterBackground() {
     CCDirector::sharedDirector()->stopAnimation();
+    
+    // The process may be killed while in the background
+    PictoSettings::sharedSettings()->flush();
 }
 
 // this function will be called when the app is active again
 void AppDelegate::applicationWillEnterForeground() {
     CCDirector::sharedDirector()->startAnimation();
 }
+
+// this function will be called when the system is low on memory
+void AppDelegate::applicationDidReceiveMemoryWarning() {
+    picto::database::purge();
+    PictogramNode::purgePool();
+    PictoTextureCache::evict();
+}
@@ -68,6 +68,11 @@ public: // public methods
      @param  the pointer of the application
      */
     void applicationWillEnterForeground();
+    
+    /**
+     @brief  The function be called when the system is running low on memory
+     */
+    static void applicationDidReceiveMemoryWarning();
 };
 
 #endif // _APP_DELEGATE_H_
@@ -33,6 +33,9 @@
 #include "AppDelegate.h"
 #include "CustomMenuItemLabel.h"
 #include "PictoDatabase.h"
+#include "PictoImagePyramid.h"
+#include "PictoRawTexture.h"
+#include "PictoTheme.h"
 #include "PictogramGridScene.h"
 #include "PictogramObject.h"
 #include "SettingsScene.h"
@@ -40,6 +43,20 @@
 
 USING_NS_CC;
 
+// Time crumbs take to slide, fade in or fade out
+#define PICTO_NAVIGATION_BAR_ANIMATION_TIME 0.15
+
+static bool same_path(CCArray* a, CCArray* b) {
+    
+    if (!a || !b || a->count() != b->count())
+        return false;
+    for (unsigned int i=0; i < a->count(); i++) {
+        if (static_cast<CCString*>(a->objectAtIndex(i))->compare(static_cast<CCString*>(b->objectAtIndex(i))->getCString()) != 0)
+            return false;
+    }
+    return true;
+}
+
 NavigationBar* NavigationBar::create(const CCSize& size, const char* title)
 {
     NavigationBar *bar = new NavigationBar();
@@ -70,7 +87,13 @@ NavigationBar* NavigationBar::create(const CCSize& size, CCArray* pictograms)
 
 NavigationBar::NavigationBar() :
 labels_(NULL),
-pictograms_(NULL) {}
+pictograms_(NULL),
+title_label_(NULL),
+menu_(NULL),
+help_button_(NULL),
+settings_button_(NULL),
+separator_(NULL),
+ellipsis_(NULL) {}
 
 NavigationBar::~NavigationBar() {
     
@@ -99,14 +122,15 @@ bool NavigationBar::init(const CCSize& size, const char* title) {
     // Add Home and Auxiliary Button
     addHomeButton(menu, sprite_size, ccp(0.5*sprite_size.width, 0.5*sprite_size.height));
     
-    CCLabelTTF* separator = picto::cocos2d_utils::createLabel(">", font_size);
+    PictoLabel* separator = picto::cocos2d_utils::createLabel(">", font_size);
     separator->setColor(picto::resources::navigationBarTextColor());
     labels_->addObject(separator);
     separator->setAnchorPoint(ccp(0, 0.5));
     separator->setPosition(ccp(sprite_size.width, 0.5*sprite_size.height));
     addChild(separator);
     
-    CCLabelTTF* title_label = picto::cocos2d_utils::createLabel(title, font_size);
+    PictoLabel* title_label = picto::cocos2d_utils::createLabel(title, font_size);
+    title_label_ = title_label;
     title_label->setColor(picto::resources::navigationBarTextColor());
     labels_->addObject(title_label);
     title_label->setAnchorPoint(ccp(-0.1, 0.5));
@@ -129,183 +153,317 @@ bool NavigationBar::init(const CCSize& size, CCArray* pictograms) {
     labels_ = CCArray::create();
     CC_SAFE_RETAIN(labels_);
     
-    pictograms_ = pictograms;
-    CC_SAFE_RETAIN(pictograms_);
-    
     CCSize sprite_size(size.height, size.height);
     float font_size = 0.4*size.height;
     
-    CCMenu* menu = CCMenu::create();
-    menu->setAnchorPoint(ccp(0, 0));
-    menu->setPosition(ccp(0, 0));
+    menu_ = CCMenu::create();
+    menu_->setAnchorPoint(ccp(0, 0));
+    menu_->setPosition(ccp(0, 0));
     
     ////////////////////////////////
     // Add Home and Auxiliary Button
-    addHomeButton(menu, sprite_size, ccp(0.5*sprite_size.width, 0.5*sprite_size.height));
+    addHomeButton(menu_, sprite_size, ccp(0.5*sprite_size.width, 0.5*sprite_size.height));
+    help_button_ = addHelpButton(menu_, sprite_size, ccp(size.width - 0.5*sprite_size.width, 0.5*sprite_size.height));
+    settings_button_ = addSettingsButton(menu_, sprite_size, ccp(size.width - 0.5*sprite_size.width, 0.5*sprite_size.height));
+    
+    separator_ = picto::cocos2d_utils::createLabel(">", font_size);
+    separator_->setColor(picto::resources::navigationBarTextColor());
+    labels_->addObject(separator_);
+    separator_->setAnchorPoint(ccp(0, 0.5));
+    separator_->setPosition(ccp(sprite_size.width, 0.5*sprite_size.height));
+    addChild(separator_);
+    
+    // Replaces the name of the level before the ones shown when the path
+    // doesn't fit
+    PictoLabel* ellipsis = picto::cocos2d_utils::createLabel("...", font_size);
+    ellipsis->setColor(picto::resources::navigationBarTextColor());
+    labels_->addObject(ellipsis);
+    ellipsis_ = CustomMenuItemLabel::create(ellipsis,
+                                            this,
+                                            menu_selector(NavigationBar::menuNavigationCallback), false);
+    ellipsis_->setAnchorPoint(ccp(0, 0.5));
+    ellipsis_->setVisible(false);
+    menu_->addChild(ellipsis_);
+    
+    addChild(menu_);
+    
+    setPictograms(pictograms);
     
-    bool is_root = (pictograms->count() == 1);
+    return true;
+}
+
+void NavigationBar::setPictograms(CCArray* pictograms) {
+    
+    if (same_path(pictograms, pictograms_))
+        return;
+    
+    // The first path is shown at once, later ones animate what changes
+    bool animated = (pictograms_ != NULL);
+    
+    // Scenes edit their path in place and set it again, so the bar keeps a
+    // copy to compare the next one with
+    CCArray* path = CCArray::createWithArray(pictograms);
+    path->retain();
+    CC_SAFE_RELEASE(pictograms_);
+    pictograms_ = path;
+    
+    // Levels under the root both paths share keep their nodes, usually all
+    // but one, so moving a level up or down edits a single crumb
+    unsigned int kept = 0;
+    while (kept < crumbs_.size() && kept + 1 < pictograms->count() &&
+           crumbs_[kept].identifier == static_cast<CCString*>(pictograms->objectAtIndex(kept + 1))->getCString()) {
+        kept++;
+    }
+    while (crumbs_.size() > kept) {
+        popCrumb(animated);
+    }
+    for (unsigned int i=kept + 1; i < pictograms->count(); i++) {
+        pushCrumb(i);
+    }
     
-    if (!is_root) {
-        addHelpButton(menu, sprite_size, ccp(size.width - 0.5*sprite_size.width, 0.5*sprite_size.height));
-    } else {
-        addSettingsButton(menu, sprite_size, ccp(size.width - 0.5*sprite_size.width, 0.5*sprite_size.height));
+    layout(animated);
+}
+
+void NavigationBar::setTitle(const char* title) {
+    
+    if (title_label_) {
+        title_label_->setString(title);
     }
+}
+
+void NavigationBar::pushCrumb(unsigned int level) {
+    
+    CCSize size = getContentSize();
+    CCSize sprite_size(size.height, size.height);
+    CCSize icon_size(0.7*sprite_size.width, 0.7*sprite_size.height);
+    float font_size = 0.4*size.height;
     
-    if (pictograms->count() == 1) {
-        addChild(menu);
-        return true;
+    const char* identifier = static_cast<CCString*>(pictograms_->objectAtIndex(level))->getCString();
+    PictogramObject* object = picto::database::pictogram(identifier);
+    
+    Crumb crumb;
+    crumb.identifier = identifier;
+    crumb.image = NULL;
+    crumb.width = 0;
+    
+    // Levels below the last one are categories, only the last one can be a
+    // pictogram, which the bar doesn't show
+    crumb.leaf = (level == pictograms_->count() - 1) && picto::database::countChilds(identifier) == 0;
+    
+    // Virtual categories have no image and show their filter
+    if (object) {
+        CCTexture2D* texture = PictoRawTexture::load(PictoImagePyramid::image(object, icon_size).c_str());
+        crumb.image = CCMenuItemSprite::create(CCSprite::createWithTexture(texture),
+                                               CCSprite::createWithTexture(texture),
+                                               this,
+                                               menu_selector(NavigationBar::menuNavigationCallback));
+        crumb.image->setTag(level + 1);
+        crumb.image->setAnchorPoint(ccp(0.5, 0.5));
+        crumb.image->setScale(0.7*sprite_size.height/crumb.image->getContentSize().height);
+        crumb.image->setVisible(false);
+        menu_->addChild(crumb.image);
+        crumb.width += sprite_size.width;
     }
     
-    CCLabelTTF* separator = picto::cocos2d_utils::createLabel(">", font_size);
-    separator->setColor(picto::resources::navigationBarTextColor());
-    labels_->addObject(separator);
-    separator->setAnchorPoint(ccp(0, 0.5));
-    separator->setPosition(ccp(sprite_size.width, 0.5*sprite_size.height));
-    addChild(separator);
+    const char* name = object? object->getName()->getCString() : identifier + 1;
+    PictoLabel* label = picto::cocos2d_utils::createLabel(name, font_size);
+    label->setColor(picto::resources::navigationBarTextColor());
+    labels_->addObject(label);
+    crumb.label = CustomMenuItemLabel::create(label,
+                                              this,
+                                              menu_selector(NavigationBar::menuNavigationCallback), false);
+    crumb.label->setTag(level + 1);
+    crumb.label->setAnchorPoint(ccp(0, 0.5));
+    crumb.label->setVisible(false);
+    menu_->addChild(crumb.label);
+    
+    // Measured from the glyph advances once, when the level is pushed
+    crumb.width += label->getContentSize().width;
+    
+    crumb.separator = picto::cocos2d_utils::createLabel(">", font_size);
+    crumb.separator->setColor(picto::resources::navigationBarTextColor());
+    labels_->addObject(crumb.separator);
+    crumb.separator->setAnchorPoint(ccp(0, 0.5));
+    crumb.separator->setVisible(false);
+    addChild(crumb.separator);
+    
+    crumbs_.push_back(crumb);
+}
+
+void NavigationBar::popCrumb(bool animated) {
     
-    //PictoDatabase* database = AppDelegate::sharedDatabase();
+    Crumb& crumb = crumbs_.back();
     
-    //////////////////////////////////////////////
-    // Compute number of items that fit in nav bar
-    
-    float character_width = separator->getContentSize().width;
-    float available_width = size.width - 2*sprite_size.width - 2*character_width;
-    int num_items_in_nav_bar = 0;
-    
-    // From last item, compute the approximate width
-    bool first_is_ellipsized = false;
-    for (int i=pictograms->count()-1; i > 0; i--) {
-        CCString* identifier = dynamic_cast<CCString*>(pictograms->objectAtIndex(i));
-        PictogramObject* object = picto::database::pictogram(identifier->getCString());
-        float item_width = sprite_size.width + (strlen(object->getName()->getCString()) + 1)*character_width;
-        if (item_width <= available_width) {
-            available_width -= item_width;
-            num_items_in_nav_bar++;
+    labels_->removeObject(crumb.label->getLabel());
+    labels_->removeObject(crumb.separator);
+    
+    CCNode* nodes[] = { crumb.image, crumb.label, crumb.separator };
+    for (int i=0; i < 3; i++) {
+        CCNode* node = nodes[i];
+        if (!node)
+            continue;
+        
+        CCMenuItem* item = dynamic_cast<CCMenuItem*>(node);
+        if (item) {
+            item->setEnabled(false);
+        }
+        
+        node->stopAllActions();
+        if (animated && node->isVisible()) {
+            node->runAction(CCSequence::create(CCFadeOut::create(PICTO_NAVIGATION_BAR_ANIMATION_TIME),
+                                               CCCallFuncN::create(this, callfuncN_selector(NavigationBar::removeNode)),
+                                               NULL));
         } else {
-            first_is_ellipsized = true;
-            break;
+            node->removeFromParentAndCleanup(true);
         }
     }
     
-    ///////////////////////////
-    // Add navigation bar items
+    crumbs_.pop_back();
+}
+
+void NavigationBar::removeNode(CCNode* node) {
+    node->removeFromParentAndCleanup(true);
+}
+
+void NavigationBar::layout(bool animated) {
     
-    CCPoint position(sprite_size.width + character_width, 0.5*size.height);
+    CCSize size = getContentSize();
+    CCSize sprite_size(size.height, size.height);
+    float separator_width = separator_->getContentSize().width;
     
-    if (first_is_ellipsized) {
-        int index = pictograms->count() - num_items_in_nav_bar - 1;
-        CCString* identifier = dynamic_cast<CCString*>(pictograms->objectAtIndex(index));
-        
-        // Add item sprite
-        PictogramObject* object = picto::database::pictogram(identifier->getCString());
-        CCMenuItemImage* item_image = CCMenuItemImage::create(object->getImage()->getCString(),
-                                                              object->getImage()->getCString(),
-                                                              this,
-                                                              menu_selector(NavigationBar::menuNavigationCallback));
-        item_image->setTag(index + 1);
-        item_image->setAnchorPoint(ccp(0.5, 0.5));
-        item_image->setPosition(ccp(position.x + 0.5*sprite_size.width, position.y));
-        item_image->setScale(0.7*sprite_size.height/item_image->getContentSize().height);
-        
-        menu->addChild(item_image);
-        
-        position.x += sprite_size.width;
-        
-        // Add item label
-        CCLabelTTF* label = picto::cocos2d_utils::createLabel("...", font_size);
-        label->setColor(picto::resources::navigationBarTextColor());
-        labels_->addObject(label);
-        CustomMenuItemLabel* item_label = CustomMenuItemLabel::create(label,
-                                                                      this,
-                                                                      menu_selector(NavigationBar::menuNavigationCallback), false);
-        item_label->setTag(index + 1);
-        item_label->setAnchorPoint(ccp(0, 0.5));
-        item_label->setPosition(position);
-        menu->addChild(item_label);
-        
-        position.x += item_label->getContentSize().width;
-        
-        // Add item separator
-        CCLabelTTF* item_separator = picto::cocos2d_utils::createLabel(">", font_size);
-        label->setColor(picto::resources::navigationBarTextColor());
-        labels_->addObject(item_separator);
-        item_separator->setAnchorPoint(ccp(0, 0.5));
-        item_separator->setPosition(position);
-        
-        addChild(item_separator);
-        
-        position.x += item_separator->getContentSize().width;
+    bool is_root = crumbs_.empty();
+    help_button_->setVisible(!is_root);
+    settings_button_->setVisible(is_root);
+    separator_->setVisible(!is_root);
+    
+    //////////////////////////////////////////////
+    // Compute the levels that fit in the nav bar
+    
+    // From the last level, add up the cached widths
+    int last = (int)crumbs_.size() - 1;
+    int first = last + 1;
+    float available_width = size.width - 2*sprite_size.width - 2*separator_width;
+    for (int i=last; i >= 0; i--) {
+        if (i == last && crumbs_[i].leaf) {
+            first = i;
+            continue;
+        }
+        float width = crumbs_[i].width + (i < last? separator_width : 0);
+        if (width > available_width)
+            break;
+        available_width -= width;
+        first = i;
     }
     
-    for (int i=pictograms->count() - num_items_in_nav_bar; i < pictograms->count(); i++) {
-        bool is_last_item = (i == (pictograms->count() - 1));
-        
-        CCString* identifier = dynamic_cast<CCString*>(pictograms->objectAtIndex(i));
+    // The level before the first one shown stands for the ones hidden
+    int ellipsized = first - 1;
+    
+    ////////////////////////////
+    // Place navigation bar items
+    
+    CCPoint position(sprite_size.width + separator_width, 0.5*size.height);
+    
+    for (int i=0; i <= last; i++) {
+        Crumb& crumb = crumbs_[i];
+        bool shown = (i >= first) && !(i == last && crumb.leaf);
         
-        if (is_last_item && picto::database::countChilds(identifier->getCString()) == 0) {
+        if (i == ellipsized) {
+            if (crumb.image) {
+                place(crumb.image, ccp(position.x + 0.5*sprite_size.width, position.y), animated);
+                position.x += sprite_size.width;
+            }
+            setCrumbEnabled(crumb, true);
+            
+            ellipsis_->setTag(crumb.label->getTag());
+            place(ellipsis_, position, animated);
+            position.x += ellipsis_->getContentSize().width;
+            
+            crumb.label->setVisible(false);
+            place(crumb.separator, position, animated);
+            position.x += separator_width;
             continue;
         }
         
-        // Add item sprite
-        PictogramObject* object = picto::database::pictogram(identifier->getCString());
-        CCMenuItemImage* item_image = CCMenuItemImage::create(object->getImage()->getCString(),
-                                                              object->getImage()->getCString(),
-                                                              this,
-                                                              menu_selector(NavigationBar::menuNavigationCallback));
-        item_image->setTag(i + 1);
-        item_image->setAnchorPoint(ccp(0.5, 0.5));
-        item_image->setPosition(ccp(position.x + 0.5*sprite_size.width, position.y));
-        item_image->setScale(0.7*sprite_size.height/item_image->getContentSize().height);
-        item_image->setEnabled(!is_last_item);
-        
-        menu->addChild(item_image);
-        
-        position.x += sprite_size.width;
+        if (!shown) {
+            if (crumb.image) {
+                crumb.image->setVisible(false);
+            }
+            crumb.label->setVisible(false);
+            crumb.separator->setVisible(false);
+            continue;
+        }
         
-        // Add item label
-        CCLabelTTF* label = picto::cocos2d_utils::createLabel(object->getName()->getCString(), font_size);
-        label->setColor(picto::resources::navigationBarTextColor());
-        labels_->addObject(label);
+        bool is_last_item = (i == last);
         
-        CustomMenuItemLabel* item_label = CustomMenuItemLabel::create(label,
-                                                                      this,
-                                                                      menu_selector(NavigationBar::menuNavigationCallback), false);
-        item_label->setEnabled(!is_last_item);
-        item_label->setTag(i + 1);
-        item_label->setAnchorPoint(ccp(0, 0.5));
-        item_label->setPosition(position);
+        setCrumbEnabled(crumb, !is_last_item);
         
-        menu->addChild(item_label);
+        if (crumb.image) {
+            place(crumb.image, ccp(position.x + 0.5*sprite_size.width, position.y), animated);
+            position.x += sprite_size.width;
+        }
         
-        position.x += label->getContentSize().width;
+        place(crumb.label, position, animated);
+        position.x += crumb.label->getContentSize().width;
         
         // Separator is not added at the last element
         if (!is_last_item) {
-            
-            // Add item separator
-            CCLabelTTF* item_separator = picto::cocos2d_utils::createLabel(">", font_size);
-            item_separator->setColor(picto::resources::navigationBarTextColor());
-            labels_->addObject(item_separator);
-            item_separator->setAnchorPoint(ccp(0, 0.5));
-            item_separator->setPosition(position);
-            
-            addChild(item_separator);
-            
-            position.x += item_separator->getContentSize().width;
-            
+            place(crumb.separator, position, animated);
+            position.x += separator_width;
+        } else {
+            crumb.separator->setVisible(false);
         }
     }
     
-    addChild(menu);
+    if (ellipsized < 0) {
+        ellipsis_->setVisible(false);
+    }
+}
+
+void NavigationBar::setCrumbEnabled(Crumb& crumb, bool enabled) {
     
-    return true;
+    if (crumb.label->isEnabled() == enabled)
+        return;
+    
+    if (crumb.image) {
+        crumb.image->setEnabled(enabled);
+    }
+    crumb.label->setEnabled(enabled);
+    
+    // Labels keep the bar text color, disabled or not
+    dynamic_cast<PictoLabel*>(crumb.label->getLabel())->setColor(picto::resources::navigationBarTextColor());
+}
+
+void NavigationBar::place(CCNode* node, const CCPoint& position, bool animated) {
+    
+    CCRGBAProtocol* rgba = dynamic_cast<CCRGBAProtocol*>(node);
+    
+    // Nodes already shown slide to their place, new ones fade in there
+    if (animated && node->isVisible()) {
+        if (!node->getPosition().equals(position)) {
+            node->stopAllActions();
+            rgba->setOpacity(255);
+            node->runAction(CCMoveTo::create(PICTO_NAVIGATION_BAR_ANIMATION_TIME, position));
+        }
+        return;
+    }
+    
+    node->stopAllActions();
+    node->setPosition(position);
+    node->setVisible(true);
+    if (animated) {
+        rgba->setOpacity(0);
+        node->runAction(CCFadeIn::create(PICTO_NAVIGATION_BAR_ANIMATION_TIME));
+    } else {
+        rgba->setOpacity(255);
+    }
 }
 
-void NavigationBar::addHelpButton(cocos2d::CCMenu *menu, const cocos2d::CCSize& size, const cocos2d::CCPoint& position) {
+CCMenuItem* NavigationBar::addHelpButton(cocos2d::CCMenu *menu, const cocos2d::CCSize& size, const cocos2d::CCPoint& position) {
     
     PictogramObject* object = picto::database::pictogram("help");
-    CCMenuItemImage* item = CCMenuItemImage::create(object->getImage()->getCString(),
-                                                    object->getImage()->getCString(),
+    CCTexture2D* texture = PictoRawTexture::load(PictoImagePyramid::image(object, size).c_str());
+    CCMenuItemSprite* item = CCMenuItemSprite::create(CCSprite::createWithTexture(texture),
+                                                      CCSprite::createWithTexture(texture),
                                                     this,
                                                     menu_selector(NavigationBar::helpPressed));
     item->setTag(1); // Root Stack level
@@ -314,13 +472,16 @@ void NavigationBar::addHelpButton(cocos2d::CCMenu *menu, const cocos2d::CCSize&
     item->setScale(size.height/item->getContentSize().height);
     
     menu->addChild(item);
+    
+    return item;
 }
 
 void NavigationBar::addHomeButton(cocos2d::CCMenu *menu, const cocos2d::CCSize& size, const cocos2d::CCPoint& position) {
     
-    PictogramObject* object = picto::database::pictogram("picto_connection");
-    CCMenuItemImage* item = CCMenuItemImage::create(object->getImage()->getCString(),
-                                                    object->getImage()->getCString(),
+    PictogramObject* object = picto::database::pictogram(ROOT_PICTOGRAM);
+    CCTexture2D* texture = PictoRawTexture::load(PictoImagePyramid::image(object, size).c_str());
+    CCMenuItemSprite* item = CCMenuItemSprite::create(CCSprite::createWithTexture(texture),
+                                                      CCSprite::createWithTexture(texture),
                                                     this,
                                                     menu_selector(NavigationBar::homePressed));
     item->setTag(1); // Root Stack level
@@ -331,7 +492,7 @@ void NavigationBar::addHomeButton(cocos2d::CCMenu *menu, const cocos2d::CCSize&
     menu->addChild(item);
 }
 
-void NavigationBar::addSettingsButton(cocos2d::CCMenu *menu, const cocos2d::CCSize& size, const cocos2d::CCPoint& position) {
+CCMenuItem* NavigationBar::addSettingsButton(cocos2d::CCMenu *menu, const cocos2d::CCSize& size, const cocos2d::CCPoint& position) {
     
     CCMenuItem* item = CCMenuItem::create(this,
                                           menu_selector(NavigationBar::settingsPressed));
@@ -355,23 +516,31 @@ void NavigationBar::addSettingsButton(cocos2d::CCMenu *menu, const cocos2d::CCSi
     item->setPosition(position);
     item->setScale(size.height/item->getContentSize().height);
     menu->addChild(item);
+    
+    return item;
 }
 
 void NavigationBar::onEnter() {
     CCLayerColor::onEnter();
+    themeChanged(NULL);
+    PictoTheme::subscribe(this, callfuncO_selector(NavigationBar::themeChanged));
+}
+
+void NavigationBar::onExit() {
+    PictoTheme::unsubscribe(this);
+    CCLayerColor::onExit();
+}
+
+void NavigationBar::themeChanged(CCObject* theme) {
     setColor(picto::resources::navigationBarBackgroundColor());
     
     CCObject* it;
     CCARRAY_FOREACH(labels_, it) {
-        CCLabelTTF* label = dynamic_cast<CCLabelTTF*>(it);
+        PictoLabel* label = dynamic_cast<PictoLabel*>(it);
         label->setColor(picto::resources::navigationBarTextColor());
     }
 }
 
-void NavigationBar::onExit() {
-    CCLayerColor::onExit();
-}
-
 void NavigationBar::helpPressed(CCObject* sender) {
     // TODO
 }
@@ -379,7 +548,7 @@ void NavigationBar::helpPressed(CCObject* sender) {
 void NavigationBar::homePressed(CCObject* sender) {
     
     if (pictograms_) {
-        CCArray* pictograms = CCArray::create(CCString::create("picto_connection"), NULL);
+        CCArray* pictograms = CCArray::create(CCString::create(ROOT_PICTOGRAM), NULL);
         CCDirector::sharedDirector()->replaceScene(PictogramGrid::scene(pictograms));
     }
 }
@@ -33,8 +33,12 @@
 
 #include "cocos2d.h"
 
+#include "PictoLabel.h"
 #include "PictogramObject.h"
 
+#include <string>
+#include <vector>
+
 class NavigationBar : public cocos2d::CCLayerColor
 {
     
@@ -46,13 +50,35 @@ public: // constructors and creators
     NavigationBar();
     ~NavigationBar();
     
+public: // public methods
+    
+    // Shows the path to the last of pictograms. Only the levels that differ
+    // from the path shown are built or removed. The bar keeps a copy, so the
+    // caller may edit pictograms afterwards
+    void setPictograms(cocos2d::CCArray* pictograms);
+    
+    // Title of a bar created with one
+    void setTitle(const char* title);
+    
 private: // init methods
     
     bool init(const cocos2d::CCSize& size, const char* title);
     bool init(const cocos2d::CCSize& size, cocos2d::CCArray* pictograms);
-    void addHelpButton(cocos2d::CCMenu* menu, const cocos2d::CCSize& size, const cocos2d::CCPoint& position);
+    cocos2d::CCMenuItem* addHelpButton(cocos2d::CCMenu* menu, const cocos2d::CCSize& size, const cocos2d::CCPoint& position);
     void addHomeButton(cocos2d::CCMenu* menu, const cocos2d::CCSize& size, const cocos2d::CCPoint& position);
-    void addSettingsButton(cocos2d::CCMenu* menu, const cocos2d::CCSize& size, const cocos2d::CCPoint& position);
+    cocos2d::CCMenuItem* addSettingsButton(cocos2d::CCMenu* menu, const cocos2d::CCSize& size, const cocos2d::CCPoint& position);
+    
+private: // private types
+    
+    // Nodes of a level of the path, built when the level is pushed
+    struct Crumb {
+        std::string identifier;
+        cocos2d::CCMenuItem* image; // NULL for virtual categories
+        cocos2d::CCMenuItemLabel* label;
+        PictoLabel* separator;
+        float width; // Of the image and the label
+        bool leaf; // Last level without children, not shown
+    };
     
 private: // private methods
     
@@ -62,11 +88,28 @@ private: // private methods
     void homePressed(cocos2d::CCObject* sender);
     void menuNavigationCallback(cocos2d::CCObject* sender);
     void settingsPressed(cocos2d::CCObject* sender);
+    void themeChanged(cocos2d::CCObject* theme);
+    
+    void pushCrumb(unsigned int level);
+    void popCrumb(bool animated);
+    void layout(bool animated);
+    void setCrumbEnabled(Crumb& crumb, bool enabled);
+    void place(cocos2d::CCNode* node, const cocos2d::CCPoint& position, bool animated);
+    void removeNode(cocos2d::CCNode* node);
     
 private: // private variables
     
     cocos2d::CCArray* labels_;
     cocos2d::CCArray* pictograms_;
+    PictoLabel* title_label_;
+    
+    // Path bars
+    cocos2d::CCMenu* menu_;
+    cocos2d::CCMenuItem* help_button_;
+    cocos2d::CCMenuItem* settings_button_;
+    PictoLabel* separator_;
+    cocos2d::CCMenuItemLabel* ellipsis_;
+    std::vector<Crumb> crumbs_;
 };
 
 #endif // __NAVIGATION_BAR_H__
\ No newline at end of file
@@ -47,29 +47,24 @@ public: // constructors and creators
     
 private:
     
-    cocos2d::CCSize computeOptimumGrid(const int num_elements,
-                                       const cocos2d::CCSize& gridSize,
-                                       const float nodeRatio,
-                                       const float margin);
-    
     cocos2d::CCMenuItem* createThemeItem(const cocos2d::CCSize& size,
                                          const cocos2d::ccColor3B& color);
     
     bool init();
-    void initBottomBar(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
     void initContent(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
-    void initTopBar(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
     
 private: // private methods
     
     void backPressed(CCObject* sender);
     void keyBackClicked();
     void onEnter();
+    void onExit();
     void menuThemeCallback(CCObject* sender);
+    void themeChanged(cocos2d::CCObject* theme);
     
 private: // private variables
     
-    cocos2d::CCMenuItem* back_button_;
+    cocos2d::CCMenu* menu_;
     cocos2d::CCArray* labels_;
 };
 
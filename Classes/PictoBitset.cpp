@@ -0,0 +1,245 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoBitset.cpp
+ * @brief Fixed size bitset with vectorized boolean operations
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoBitset.h"
+
+#include <algorithm>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PICTO_BITSET_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PICTO_BITSET_SSE2
+#endif
+
+#define WORD_BITS 32
+#define BLOCK_WORDS 4
+
+static inline size_t blocks(size_t size) {
+    return (size + BLOCK_WORDS*WORD_BITS - 1) / (BLOCK_WORDS*WORD_BITS);
+}
+
+static inline unsigned int popcount(uint32_t word) {
+#if defined(__GNUC__)
+    return __builtin_popcount(word);
+#else
+    word = word - ((word >> 1) & 0x55555555);
+    word = (word & 0x33333333) + ((word >> 2) & 0x33333333);
+    return (((word + (word >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+}
+
+PictoBitset::PictoBitset(size_t size, bool value) :
+size_(size),
+words_(blocks(size)*BLOCK_WORDS, 0) {
+    if (value)
+        fill(true);
+}
+
+void PictoBitset::set(size_t i) {
+    words_[i / WORD_BITS] |= (1u << (i % WORD_BITS));
+}
+
+void PictoBitset::reset(size_t i) {
+    words_[i / WORD_BITS] &= ~(1u << (i % WORD_BITS));
+}
+
+bool PictoBitset::test(size_t i) const {
+    return (words_[i / WORD_BITS] >> (i % WORD_BITS)) & 1u;
+}
+
+void PictoBitset::fill(bool value) {
+    std::fill(words_.begin(), words_.end(), value? 0xFFFFFFFFu : 0u);
+    clearPadding();
+}
+
+void PictoBitset::clearPadding() {
+    size_t full_words = size_ / WORD_BITS;
+    if (full_words < words_.size()) {
+        words_[full_words] &= (1u << (size_ % WORD_BITS)) - 1u;
+        std::fill(words_.begin() + full_words + 1, words_.end(), 0u);
+    }
+}
+
+PictoBitset& PictoBitset::operator&=(const PictoBitset& other) {
+    
+    size_t n = std::min(words_.size(), other.words_.size());
+    uint32_t* a = words_.empty()? NULL : &words_[0];
+    const uint32_t* b = other.words_.empty()? NULL : &other.words_[0];
+    
+#if defined(PICTO_BITSET_NEON)
+    for (size_t i=0; i < n; i += BLOCK_WORDS)
+        vst1q_u32(a + i, vandq_u32(vld1q_u32(a + i), vld1q_u32(b + i)));
+#elif defined(PICTO_BITSET_SSE2)
+    for (size_t i=0; i < n; i += BLOCK_WORDS) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(a + i), _mm_and_si128(va, vb));
+    }
+#else
+    for (size_t i=0; i < n; i++)
+        a[i] &= b[i];
+#endif
+    
+    // Missing words in the other bitset are zero
+    std::fill(words_.begin() + n, words_.end(), 0u);
+    
+    return *this;
+}
+
+PictoBitset& PictoBitset::operator|=(const PictoBitset& other) {
+    
+    size_t n = std::min(words_.size(), other.words_.size());
+    uint32_t* a = words_.empty()? NULL : &words_[0];
+    const uint32_t* b = other.words_.empty()? NULL : &other.words_[0];
+    
+#if defined(PICTO_BITSET_NEON)
+    for (size_t i=0; i < n; i += BLOCK_WORDS)
+        vst1q_u32(a + i, vorrq_u32(vld1q_u32(a + i), vld1q_u32(b + i)));
+#elif defined(PICTO_BITSET_SSE2)
+    for (size_t i=0; i < n; i += BLOCK_WORDS) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(a + i), _mm_or_si128(va, vb));
+    }
+#else
+    for (size_t i=0; i < n; i++)
+        a[i] |= b[i];
+#endif
+    
+    clearPadding();
+    
+    return *this;
+}
+
+PictoBitset& PictoBitset::andNot(const PictoBitset& other) {
+    
+    size_t n = std::min(words_.size(), other.words_.size());
+    uint32_t* a = words_.empty()? NULL : &words_[0];
+    const uint32_t* b = other.words_.empty()? NULL : &other.words_[0];
+    
+#if defined(PICTO_BITSET_NEON)
+    for (size_t i=0; i < n; i += BLOCK_WORDS)
+        vst1q_u32(a + i, vbicq_u32(vld1q_u32(a + i), vld1q_u32(b + i)));
+#elif defined(PICTO_BITSET_SSE2)
+    for (size_t i=0; i < n; i += BLOCK_WORDS) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(a + i), _mm_andnot_si128(vb, va));
+    }
+#else
+    for (size_t i=0; i < n; i++)
+        a[i] &= ~b[i];
+#endif
+    
+    return *this;
+}
+
+PictoBitset& PictoBitset::flip() {
+    
+    for (size_t i=0; i < words_.size(); i++)
+        words_[i] = ~words_[i];
+    clearPadding();
+    
+    return *this;
+}
+
+size_t PictoBitset::count() const {
+    
+    size_t total = 0;
+    size_t i = 0;
+    
+#if defined(PICTO_BITSET_NEON)
+    // Per-byte counts are accumulated in 16 bit lanes, which can't overflow
+    // before 4096 blocks, and folded into the total every 2048 blocks
+    while (i < words_.size()) {
+        uint16x8_t acc = vdupq_n_u16(0);
+        size_t end = std::min(words_.size(), i + 2048*BLOCK_WORDS);
+        for (; i < end; i += BLOCK_WORDS) {
+            uint8x16_t bytes = vreinterpretq_u8_u32(vld1q_u32(&words_[i]));
+            acc = vpadalq_u8(acc, vcntq_u8(bytes));
+        }
+        uint32x4_t sum32 = vpaddlq_u16(acc);
+        uint64x2_t sum64 = vpaddlq_u32(sum32);
+        total += vgetq_lane_u64(sum64, 0) + vgetq_lane_u64(sum64, 1);
+    }
+#elif defined(PICTO_BITSET_SSE2)
+    // SSE2 has no population count: bits are added in pairs, nibbles and
+    // bytes within the register, and bytes summed into 64 bit lanes by psadbw
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (; i < words_.size(); i += BLOCK_WORDS) {
+        __m128i v = _mm_loadu_si128((const __m128i*)&words_[i]);
+        v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v, 1), m1));
+        v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi16(v, 2), m2));
+        v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi16(v, 4)), m4);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    total += lanes[0] + lanes[1];
+#endif
+    
+    for (; i < words_.size(); i++)
+        total += popcount(words_[i]);
+    
+    return total;
+}
+
+size_t PictoBitset::next(size_t from) const {
+    
+    if (from >= size_)
+        return size_;
+    
+    size_t w = from / WORD_BITS;
+    uint32_t word = words_[w] & (0xFFFFFFFFu << (from % WORD_BITS));
+    
+    while (true) {
+        if (word != 0) {
+#if defined(__GNUC__)
+            size_t bit = w*WORD_BITS + __builtin_ctz(word);
+#else
+            size_t bit = w*WORD_BITS;
+            while (!(word & 1u)) {
+                word >>= 1;
+                bit++;
+            }
+#endif
+            return std::min(bit, size_);
+        }
+        if (++w >= words_.size())
+            return size_;
+        word = words_[w];
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoBitset.h
+ * @brief Fixed size bitset with vectorized boolean operations
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_BITSET_H__
+#define __PICTO_BITSET_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Bitset whose words are padded to 128 bits so AND/OR/ANDNOT and population
+ * count run on whole SSE2/NEON registers. Bits past size() are always zero.
+ */
+class PictoBitset {
+    
+public: // constructors
+    
+    explicit PictoBitset(size_t size = 0, bool value = false);
+    
+public: // public methods
+    
+    size_t size() const { return size_; }
+    
+    void set(size_t i);
+    void reset(size_t i);
+    bool test(size_t i) const;
+    void fill(bool value);
+    
+    PictoBitset& operator&=(const PictoBitset& other);
+    PictoBitset& operator|=(const PictoBitset& other);
+    PictoBitset& andNot(const PictoBitset& other);
+    PictoBitset& flip();
+    
+    size_t count() const;
+    
+    // Index of the first set bit at or after "from", or size() if there is none
+    size_t next(size_t from) const;
+    
+private: // private methods
+    
+    void clearPadding();
+    
+private: // private variables
+    
+    size_t size_;
+    std::vector<uint32_t> words_;
+};
+
+#endif // __PICTO_BITSET_H__
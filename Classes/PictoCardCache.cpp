@@ -0,0 +1,450 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoCardCache.cpp
+ * @brief Pictogram cards baked into a single texture
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoCardCache.h"
+
+#include "PictoDefs.h"
+#include "PictoImagePyramid.h"
+#include "PictoRawTexture.h"
+#include "PictoSettings.h"
+
+#include <algorithm>
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+USING_NS_CC;
+
+#define PICTO_CARD_DIRECTORY "cards/"
+#define PICTO_ATLAS_DIRECTORY "atlases/"
+
+// Longest side of a sheet, in pixels
+#define PICTO_CARD_SHEET_MAX_SIZE 2048
+
+// Bytes of the cards stored on disk
+#define PICTO_CARD_DISK_BUDGET (32*1024*1024)
+
+static std::string g_atlas_category_;
+static int g_atlas_pages_ = 0;
+
+// Bytes stored in the cards directory, unknown until it is first listed
+static long long g_disk_bytes_ = -1;
+
+struct StoredCard {
+    time_t mtime;
+    off_t bytes;
+    std::string path;
+    
+    bool operator<(const StoredCard& other) const {
+        return mtime < other.mtime;
+    }
+};
+
+// 64 bit FNV-1a, stable across runs so the files on disk can be found again
+static unsigned long long fnv1a(const std::string& text) {
+    
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i=0; i < text.size(); i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+CCTexture2D* PictoCardCache::card(PictogramObject* pictogram, const CCSize& size) {
+    
+    return load(CCArray::create(pictogram, NULL), size, 1, path("", key(pictogram, size)));
+}
+
+CCArray* PictoCardCache::sheet(CCArray* pictograms, const CCSize& size) {
+    
+    int count = pictograms->count();
+    int cols;
+    std::string sheet_path = sheetPath(pictograms, size, &cols);
+    if (sheet_path.empty())
+        return NULL;
+    
+    CCTexture2D* texture = load(pictograms, size, cols, sheet_path);
+    float cell_width = ceilf(size.width);
+    float cell_height = ceilf(size.height);
+    
+    CCArray* frames = CCArray::createWithCapacity(count);
+    for (int i=0; i < count; i++) {
+        CCRect rect = CCRectMake((i % cols)*cell_width, (i / cols)*cell_height, size.width, size.height);
+        frames->addObject(CCSpriteFrame::createWithTexture(texture, rect));
+    }
+    return frames;
+}
+
+void PictoCardCache::loadAtlases(const char* category) {
+    
+    if (g_atlas_category_ == category)
+        return;
+    
+    CCSpriteFrameCache* frame_cache = CCSpriteFrameCache::sharedSpriteFrameCache();
+    CCFileUtils* file_utils = CCFileUtils::sharedFileUtils();
+    
+    for (int i=0; i < g_atlas_pages_; i++) {
+        CCString* plist = CCString::createWithFormat(PICTO_ATLAS_DIRECTORY "%s-%d.plist", atlasName(g_atlas_category_.c_str()).c_str(), i);
+        frame_cache->removeSpriteFramesFromFile(plist->getCString());
+    }
+    
+    g_atlas_category_ = category;
+    g_atlas_pages_ = 0;
+    
+    for (;;) {
+        CCString* plist = CCString::createWithFormat(PICTO_ATLAS_DIRECTORY "%s-%d.plist", atlasName(category).c_str(), g_atlas_pages_);
+        if (!file_utils->isFileExist(file_utils->fullPathForFilename(plist->getCString())))
+            break;
+        
+        frame_cache->addSpriteFramesWithFile(plist->getCString());
+        g_atlas_pages_++;
+    }
+}
+
+void PictoCardCache::sources(const char* category, CCArray* pictograms, const CCSize& size, std::vector<Source>& sources) {
+    
+    CCFileUtils* file_utils = CCFileUtils::sharedFileUtils();
+    float scale = CCDirector::sharedDirector()->getContentScaleFactor();
+    size_t card_bytes = (size_t)(ceilf(size.width*scale)*ceilf(size.height*scale)*4);
+    
+    int cols;
+    std::string sheet_path = sheetPath(pictograms, size, &cols);
+    if (!sheet_path.empty() && file_utils->isFileExist(sheet_path)) {
+        int rows = (pictograms->count() + cols - 1) / cols;
+        Source source = { sheet_path, cols*rows*card_bytes };
+        sources.push_back(source);
+        return;
+    }
+    
+    // Same choice of images as compose
+    CCSize image_size = CCSizeMake(4*size.height/5, 4*size.height/5);
+    size_t image_bytes = (size_t)(image_size.width*scale*image_size.height*scale*4);
+    
+    if (image_size.width <= 128) {
+        int page = 0;
+        for (;; page++) {
+            CCString* plist = CCString::createWithFormat(PICTO_ATLAS_DIRECTORY "%s-%d.plist", atlasName(category).c_str(), page);
+            if (!file_utils->isFileExist(file_utils->fullPathForFilename(plist->getCString())))
+                break;
+            
+            // Pages are at most 1024 pixels wide and high
+            CCString* image = CCString::createWithFormat(PICTO_ATLAS_DIRECTORY "%s-%d.png", atlasName(category).c_str(), page);
+            Source source = { image->getCString(), 1024*1024*4 };
+            sources.push_back(source);
+        }
+        if (page > 0)
+            return;
+    }
+    
+    CCObject* it;
+    CCARRAY_FOREACH(pictograms, it) {
+        PictogramObject* pictogram = dynamic_cast<PictogramObject*>(it);
+        Source source;
+        source.path = image_size.width <= 128? pictogram->getThumb()->getCString() : PictoImagePyramid::image(pictogram, image_size);
+        source.bytes = image_bytes;
+        sources.push_back(source);
+    }
+}
+
+CCRect PictoCardCache::speakerRect(const CCSize& size) {
+    
+    CCSize speaker_size(size.width - 0.04*size.width, size.height/5 - 0.03*size.width);
+    return CCRectMake(0.5*(size.width - speaker_size.width), 0.5*(size.height/5.0 - speaker_size.height),
+                      speaker_size.width, speaker_size.height);
+}
+
+void PictoCardCache::purge() {
+    
+    std::string dir = directory();
+    DIR* handle = opendir(dir.c_str());
+    if (!handle)
+        return;
+    
+    struct dirent* entry;
+    while ((entry = readdir(handle)) != NULL) {
+        if (entry->d_name[0] != '.')
+            unlink((dir + entry->d_name).c_str());
+    }
+    closedir(handle);
+    g_disk_bytes_ = 0;
+}
+
+std::string PictoCardCache::directory() {
+    
+    static std::string g_directory_;
+    if (g_directory_.empty()) {
+        g_directory_ = CCFileUtils::sharedFileUtils()->getWritablePath() + PICTO_CARD_DIRECTORY;
+        if (mkdir(g_directory_.c_str(), 0755) != 0 && errno != EEXIST) {
+            CCLOGERROR("Can't create %s", g_directory_.c_str());
+        }
+    }
+    return g_directory_;
+}
+
+void PictoCardCache::stored(const std::string& path) {
+    
+    struct stat info;
+    if (g_disk_bytes_ >= 0 && stat(path.c_str(), &info) == 0)
+        g_disk_bytes_ += info.st_size;
+    
+    if (g_disk_bytes_ < 0 || g_disk_bytes_ > PICTO_CARD_DISK_BUDGET)
+        trimDirectory();
+}
+
+void PictoCardCache::trimDirectory() {
+    
+    std::string dir = directory();
+    DIR* handle = opendir(dir.c_str());
+    if (!handle)
+        return;
+    
+    std::vector<StoredCard> cards;
+    g_disk_bytes_ = 0;
+    struct dirent* entry;
+    while ((entry = readdir(handle)) != NULL) {
+        StoredCard card;
+        struct stat info;
+        card.path = dir + entry->d_name;
+        if (entry->d_name[0] == '.' || stat(card.path.c_str(), &info) != 0)
+            continue;
+        card.mtime = info.st_mtime;
+        card.bytes = info.st_size;
+        cards.push_back(card);
+        g_disk_bytes_ += card.bytes;
+    }
+    closedir(handle);
+    
+    // Used cards are touched, so the oldest modification goes first
+    std::sort(cards.begin(), cards.end());
+    for (size_t i=0; i < cards.size() && g_disk_bytes_ > PICTO_CARD_DISK_BUDGET; i++) {
+        if (unlink(cards[i].path.c_str()) == 0)
+            g_disk_bytes_ -= cards[i].bytes;
+    }
+}
+
+std::string PictoCardCache::key(PictogramObject* pictogram, const CCSize& size) {
+    
+    // Everything that changes the look of the card is part of its key
+    bool use_capitals = PictoSettings::sharedSettings()->getBool("use_capitals", true);
+    CCString* key = CCString::createWithFormat("%s|%s|%s|%.1fx%.1f@%.2f|%06x|%06x|%d|%d",
+                                               pictogram->getIdentifier()->getCString(),
+                                               pictogram->getName()->getCString(),
+                                               pictogram->getImage()->getCString(),
+                                               size.width, size.height,
+                                               CCDirector::sharedDirector()->getContentScaleFactor(),
+                                               picto::conversions::color2int(picto::resources::speakerButtonBackgroundColor()),
+                                               picto::conversions::color2int(picto::resources::speakerButtonTextColor()),
+                                               use_capitals,
+                                               bakesName(pictogram));
+    return key->getCString();
+}
+
+std::string PictoCardCache::path(const char* prefix, const std::string& key) {
+    
+    char name[48];
+    snprintf(name, sizeof(name), "%s%016llx.png", prefix, fnv1a(key));
+    return directory() + name;
+}
+
+std::string PictoCardCache::sheetPath(CCArray* pictograms, const CCSize& size, int* cols) {
+    
+    int count = pictograms->count();
+    if (count == 0)
+        return "";
+    
+    // Cards in whole pixel cells, in a square-ish arrangement
+    *cols = (int)ceilf(sqrtf(count));
+    int rows = (count + *cols - 1) / *cols;
+    float cell_width = ceilf(size.width);
+    float cell_height = ceilf(size.height);
+    
+    float scale = CCDirector::sharedDirector()->getContentScaleFactor();
+    if (*cols*cell_width*scale > PICTO_CARD_SHEET_MAX_SIZE || rows*cell_height*scale > PICTO_CARD_SHEET_MAX_SIZE)
+        return "";
+    
+    std::string keys;
+    CCObject* it;
+    CCARRAY_FOREACH(pictograms, it) {
+        keys += key(dynamic_cast<PictogramObject*>(it), size) + "\n";
+    }
+    
+    return path("sheet-", keys);
+}
+
+std::string PictoCardCache::atlasName(const char* category) {
+    
+    // Same as atlas_name in tools/pack_atlases.py
+    std::string name = category;
+    for (size_t i=0; i < name.size(); i++) {
+        if (!isalnum((unsigned char)name[i]) && name[i] != '_' && name[i] != '-')
+            name[i] = '_';
+    }
+    return name;
+}
+
+CCNode* PictoCardCache::compose(PictogramObject* pictogram, const CCSize& size, bool baked) {
+    
+    CCNode* card = CCNode::create();
+    card->setContentSize(size);
+    
+    // Background
+    CCSprite* background = CCSprite::create("white_frame.png");
+    background->setAnchorPoint(ccp(0.5, 0.5));
+    background->setPosition(ccp(0.5*size.width, 0.5*size.height));
+    background->setScale(size.width / background->getContentSize().width);
+    card->addChild(background);
+    
+    // Image sprite, thumbnails are enough for images up to 128 points and
+    // bigger ones take the pyramid level that fits them
+    CCSize image_size = CCSizeMake(4*size.height/5, 4*size.height/5);
+    CCSprite* image = NULL;
+    
+    if (image_size.width <= 128) {
+        CCSpriteFrame* frame = CCSpriteFrameCache::sharedSpriteFrameCache()->spriteFrameByName(pictogram->getIdentifier()->getCString());
+        if (frame) {
+            image = CCSprite::createWithSpriteFrame(frame);
+        } else {
+            image = CCSprite::createWithTexture(PictoRawTexture::load(pictogram->getThumb()->getCString()));
+        }
+    } else {
+        image = CCSprite::createWithTexture(PictoRawTexture::load(PictoImagePyramid::image(pictogram, image_size).c_str()));
+    }
+    
+    image->setAnchorPoint(ccp(0.5, 0.5));
+    image->setPosition(ccp(0.5*size.width, 3*size.height/5));
+    image->setScale(image_size.width/image->getContentSize().width);
+    card->addChild(image);
+    
+    //////////////////
+    // Speaker button
+    
+    CCRect speaker_rect = speakerRect(size);
+    CCNode* speaker_button = CCNode::create();
+    speaker_button->setContentSize(speaker_rect.size);
+    speaker_button->setPosition(speaker_rect.origin);
+    
+    // Speaker background rounded frame
+    CCSprite* speaker_background = CCSprite::create("speaker_background.png");
+    speaker_background->setScaleX(speaker_rect.size.width / speaker_background->getContentSize().width);
+    speaker_background->setScaleY(speaker_rect.size.height / speaker_background->getContentSize().height);
+    speaker_background->setAnchorPoint(CCPointZero);
+    speaker_background->setPosition(CCPointZero);
+    speaker_background->setColor(picto::resources::speakerButtonBackgroundColor());
+    speaker_button->addChild(speaker_background);
+    
+    // Speaker icon sprite
+    CCSprite* speaker_icon = CCSprite::create("speaker.png");
+    speaker_icon->setPosition(ccp(0.1*speaker_rect.size.height, 0.5*speaker_rect.size.height));
+    speaker_icon->setAnchorPoint(ccp(0, 0.5));
+    speaker_icon->setScale(0.5*speaker_rect.size.height / speaker_icon->getContentSize().height);
+    speaker_icon->setColor(picto::resources::speakerButtonTextColor());
+    speaker_button->addChild(speaker_icon);
+    
+    card->addChild(speaker_button);
+    
+    // Title label, left to the nodes when it would be rasterized
+    if (!baked) {
+        card->addChild(name(pictogram, size, true));
+    } else if (bakesName(pictogram)) {
+        card->addChild(name(pictogram, size, false));
+    }
+    
+    return card;
+}
+
+bool PictoCardCache::bakesName(PictogramObject* pictogram) {
+    
+    return picto::cocos2d_utils::labelCovered(pictogram->getName()->getCString());
+}
+
+PictoLabel* PictoCardCache::name(PictogramObject* pictogram, const CCSize& size, bool async) {
+    
+    CCRect speaker_rect = speakerRect(size);
+    float font_size = 0.7*speaker_rect.size.height;
+    const char* text = pictogram->getName()->getCString();
+    PictoLabel* label = async? picto::cocos2d_utils::createLabelAsync(text, font_size) : picto::cocos2d_utils::createLabel(text, font_size);
+    label->setAnchorPoint(ccp(0.5, 0.5));
+    label->setPosition(ccp(speaker_rect.getMidX(), speaker_rect.getMidY()));
+    label->setColor(picto::resources::speakerButtonTextColor());
+    
+    // Scale the label to not overlap the speaker icon
+    label->setMaxWidth(0.75*speaker_rect.size.width);
+    
+    return label;
+}
+
+CCTexture2D* PictoCardCache::load(CCArray* pictograms, const CCSize& size, int cols, const std::string& path) {
+    
+    CCTexture2D* texture = CCTextureCache::sharedTextureCache()->textureForKey(path.c_str());
+    if (texture) {
+        utime(path.c_str(), NULL);
+        return texture;
+    }
+    
+    // Stored cards the prefetcher didn't get to are decoded here, on the GL
+    // thread. Scenes lay out their cells around the card frames, so a card
+    // can't be late like the images of the other nodes
+    if (CCFileUtils::sharedFileUtils()->isFileExist(path)) {
+        utime(path.c_str(), NULL);
+        return CCTextureCache::sharedTextureCache()->addImage(path.c_str());
+    }
+    
+    // Bake the cards row by row from the top, in whole pixel cells
+    int count = pictograms->count();
+    int rows = (count + cols - 1) / cols;
+    float cell_width = ceilf(size.width);
+    float cell_height = ceilf(size.height);
+    
+    CCRenderTexture* render_texture = CCRenderTexture::create((int)(cols*cell_width), (int)(rows*cell_height));
+    render_texture->beginWithClear(0, 0, 0, 0);
+    for (int i=0; i < count; i++) {
+        CCNode* card = compose(dynamic_cast<PictogramObject*>(pictograms->objectAtIndex(i)), size, true);
+        card->setPosition(ccp((i % cols)*cell_width, (rows - 1 - i / cols)*cell_height));
+        card->visit();
+    }
+    render_texture->end();
+    
+    // Reload the saved file, so baked and stored cards are premultiplied alike
+    CCImage* image = render_texture->newCCImage(true);
+    if (image->saveToFile(path.c_str(), false)) {
+        texture = CCTextureCache::sharedTextureCache()->addImage(path.c_str());
+        stored(path);
+    } else {
+        CCLOGERROR("Can't store cards %s", path.c_str());
+        texture = CCTextureCache::sharedTextureCache()->addUIImage(image, path.c_str());
+    }
+    image->release();
+    
+    return texture;
+}
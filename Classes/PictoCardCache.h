@@ -0,0 +1,113 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoCardCache.h
+ * @brief Pictogram cards baked into a single texture
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_CARD_CACHE_H__
+#define __PICTO_CARD_CACHE_H__
+
+#include "cocos2d.h"
+
+#include "PictoLabel.h"
+#include "PictogramObject.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Renders the static parts of a pictogram card (frame, image, speaker button
+ * and label) once into a texture, so a card draws as a single quad. Cards
+ * are kept in the texture cache and as PNG files in the writable path, keyed
+ * by pictogram, size, theme colors and capitals setting, so a theme or a
+ * setting change never reuses a stale card. The files take at most
+ * PICTO_CARD_DISK_BUDGET bytes, the least recently used are deleted first.
+ *
+ * Names no glyph atlas covers are left out of the baked cards, so baking
+ * never rasterizes text. Nodes draw those names over the card with labels
+ * rasterized off the main thread.
+ *
+ * The cards of a grid page can be baked together in a sheet, so the page
+ * loads one texture and draws through a single sprite batch. Thumbnails are
+ * taken from the category atlases built by tools/pack_atlases.py when they
+ * are available.
+ */
+class PictoCardCache {
+    
+public: // public types
+    
+    struct Source {
+        std::string path;
+        size_t bytes; // Of its texture
+    };
+    
+public: // public methods
+    
+    static cocos2d::CCTexture2D* card(PictogramObject* pictogram, const cocos2d::CCSize& size);
+    
+    // Frames of the cards of all the pictograms in one texture, or NULL when
+    // they don't fit a texture
+    static cocos2d::CCArray* sheet(cocos2d::CCArray* pictograms, const cocos2d::CCSize& size);
+    
+    // Thumbnail atlas pages of the children of category, replacing the ones
+    // of the previous category
+    static void loadAtlases(const char* category);
+    
+    // Files a sheet of the cards of the children of category would load: the
+    // sheet once stored, otherwise the images the cards are baked from
+    static void sources(const char* category, cocos2d::CCArray* pictograms, const cocos2d::CCSize& size, std::vector<Source>& sources);
+    
+    // Parts of a card, for baking or for nodes that would be the only users
+    // of their card. Names no atlas covers are left out of baked cards and
+    // rasterized off the main thread for the others
+    static cocos2d::CCNode* compose(PictogramObject* pictogram, const cocos2d::CCSize& size, bool baked);
+    
+    // Whether baked cards of the pictogram draw its name
+    static bool bakesName(PictogramObject* pictogram);
+    
+    // Name of the pictogram placed on a card of the given size
+    static PictoLabel* name(PictogramObject* pictogram, const cocos2d::CCSize& size, bool async);
+    
+    // Speaker button rect inside a card of the given size
+    static cocos2d::CCRect speakerRect(const cocos2d::CCSize& size);
+    
+    // Deletes the cards stored on disk
+    static void purge();
+    
+private: // private methods
+    
+    static std::string directory();
+    static void stored(const std::string& path);
+    static void trimDirectory();
+    static std::string key(PictogramObject* pictogram, const cocos2d::CCSize& size);
+    static std::string path(const char* prefix, const std::string& key);
+    static std::string sheetPath(cocos2d::CCArray* pictograms, const cocos2d::CCSize& size, int* cols);
+    static std::string atlasName(const char* category);
+    static cocos2d::CCTexture2D* load(cocos2d::CCArray* pictograms, const cocos2d::CCSize& size, int cols, const std::string& path);
+};
+
+#endif // __PICTO_CARD_CACHE_H__
@@ -0,0 +1,140 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoCatalogShard.cpp
+ * @brief In-memory subset of the catalog rooted at a top level category
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoCatalogShard.h"
+
+USING_NS_CC;
+
+PictoCatalogShard* PictoCatalogShard::create(const char* root, const char* locale, bool complete) {
+    
+    PictoCatalogShard* shard = new PictoCatalogShard();
+    if (shard && shard->init(root, locale, complete)) {
+        shard->autorelease();
+        return shard;
+    }
+    CC_SAFE_DELETE(shard);
+    
+    return NULL;
+}
+
+PictoCatalogShard::PictoCatalogShard() :
+childs_(NULL),
+complete_(false),
+indices_(NULL),
+locale_(NULL),
+pictograms_(NULL),
+root_(NULL) {}
+
+PictoCatalogShard::~PictoCatalogShard() {
+    CC_SAFE_RELEASE_NULL(childs_);
+    CC_SAFE_RELEASE_NULL(indices_);
+    CC_SAFE_RELEASE_NULL(locale_);
+    CC_SAFE_RELEASE_NULL(pictograms_);
+    CC_SAFE_RELEASE_NULL(root_);
+}
+
+bool PictoCatalogShard::init(const char* root, const char* locale, bool complete) {
+    
+    root_ = CCString::create(root);
+    CC_SAFE_RETAIN(root_);
+    
+    locale_ = CCString::create(locale);
+    CC_SAFE_RETAIN(locale_);
+    
+    complete_ = complete;
+    
+    childs_ = CCDictionary::create();
+    CC_SAFE_RETAIN(childs_);
+    
+    indices_ = CCDictionary::create();
+    CC_SAFE_RETAIN(indices_);
+    
+    pictograms_ = CCDictionary::create();
+    CC_SAFE_RETAIN(pictograms_);
+    
+    // The root is always expanded, even when it has no childs
+    childs_->setObject(CCArray::create(), root);
+    
+    return true;
+}
+
+void PictoCatalogShard::addPictogram(const char* identifier, PictogramObject* pictogram) {
+    pictograms_->setObject(pictogram, identifier);
+}
+
+void PictoCatalogShard::addChild(const char* parent, const char* child) {
+    
+    PictogramObject* pictogram = this->pictogram(child);
+    if (pictogram == NULL)
+        return;
+    
+    CCArray* childs = dynamic_cast<CCArray*>(childs_->objectForKey(parent));
+    if (childs == NULL) {
+        childs = CCArray::create();
+        childs_->setObject(childs, parent);
+    }
+    
+    // Siblings are resolved by position, so a swipe doesn't scan the childs
+    CCDictionary* indices = dynamic_cast<CCDictionary*>(indices_->objectForKey(parent));
+    if (indices == NULL) {
+        indices = CCDictionary::create();
+        indices_->setObject(indices, parent);
+    }
+    if (indices->objectForKey(child) == NULL)
+        indices->setObject(CCInteger::create(childs->count()), child);
+    
+    childs->addObject(pictogram);
+}
+
+bool PictoCatalogShard::covers(const char* identifier) const {
+    
+    if (childs_->objectForKey(identifier) != NULL)
+        return true;
+    
+    return complete_ && pictograms_->objectForKey(identifier) != NULL;
+}
+
+PictogramObject* PictoCatalogShard::pictogram(const char* identifier) const {
+    return dynamic_cast<PictogramObject*>(pictograms_->objectForKey(identifier));
+}
+
+CCArray* PictoCatalogShard::childs(const char* identifier) const {
+    return dynamic_cast<CCArray*>(childs_->objectForKey(identifier));
+}
+
+int PictoCatalogShard::indexOf(const char* parent, const char* child) const {
+    
+    CCDictionary* indices = dynamic_cast<CCDictionary*>(indices_->objectForKey(parent));
+    if (indices == NULL)
+        return -1;
+    
+    CCInteger* index = dynamic_cast<CCInteger*>(indices->objectForKey(child));
+    return (index != NULL)? index->getValue() : -1;
+}
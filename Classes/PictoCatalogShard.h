@@ -0,0 +1,81 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoCatalogShard.h
+ * @brief In-memory subset of the catalog rooted at a top level category
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_CATALOG_SHARD_H__
+#define __PICTO_CATALOG_SHARD_H__
+
+#include "cocos2d.h"
+
+#include "PictogramObject.h"
+
+/**
+ * Pictograms and relationships of one subtree of the catalog. A complete shard
+ * knows the childs of every pictogram it contains, while a partial one (the
+ * root shard) only knows the childs of its root.
+ */
+class PictoCatalogShard : public cocos2d::CCObject {
+    
+public: // constructors and creators
+    
+    static PictoCatalogShard* create(const char* root, const char* locale, bool complete);
+    
+    PictoCatalogShard();
+    ~PictoCatalogShard();
+    
+private: // initializers
+    
+    bool init(const char* root, const char* locale, bool complete);
+    
+public: // public methods
+    
+    void addPictogram(const char* identifier, PictogramObject* pictogram);
+    void addChild(const char* parent, const char* child);
+    
+    bool covers(const char* identifier) const;
+    PictogramObject* pictogram(const char* identifier) const;
+    cocos2d::CCArray* childs(const char* identifier) const;
+    
+    // Position of child among the childs of parent, or -1 if it isn't one
+    int indexOf(const char* parent, const char* child) const;
+    
+public: // public variables
+    
+    CC_SYNTHESIZE_READONLY(cocos2d::CCString*, root_, Root);
+    CC_SYNTHESIZE_READONLY(cocos2d::CCString*, locale_, Locale);
+    CC_SYNTHESIZE_READONLY(bool, complete_, Complete);
+    
+private: // private variables
+    
+    cocos2d::CCDictionary* childs_;
+    cocos2d::CCDictionary* indices_;
+    cocos2d::CCDictionary* pictograms_;
+};
+
+#endif // __PICTO_CATALOG_SHARD_H__
@@ -0,0 +1,198 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoChrome.cpp
+ * @brief Back button and navigation bar shared by every scene
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoChrome.h"
+
+#include "NavigationBar.h"
+#include "PictoDefs.h"
+#include "PictoTheme.h"
+
+USING_NS_CC;
+
+static PictoChrome* g_shared_chrome_ = NULL;
+
+PictoChrome* PictoChrome::sharedChrome() {
+    
+    if (!g_shared_chrome_) {
+        g_shared_chrome_ = new PictoChrome();
+        g_shared_chrome_->init();
+        
+        // Drawn after the running scene. Nothing calls onEnter on the
+        // notification node, it runs from now on
+        CCDirector::sharedDirector()->setNotificationNode(g_shared_chrome_);
+        g_shared_chrome_->onEnter();
+        g_shared_chrome_->onEnterTransitionDidFinish();
+    }
+    return g_shared_chrome_;
+}
+
+PictoChrome::PictoChrome() :
+
+path_bar_(NULL),
+title_bar_(NULL),
+back_button_(NULL),
+back_target_(NULL),
+back_selector_(NULL) {
+    
+}
+
+PictoChrome::~PictoChrome() {
+    removeAllChildrenWithCleanup(true);
+}
+
+bool PictoChrome::init() {
+    
+    if (!CCNode::init()) {
+        return false;
+    }
+    
+    CCSize visible_size = CCDirector::sharedDirector()->getVisibleSize();
+    CCPoint visible_origin = CCDirector::sharedDirector()->getVisibleOrigin();
+    
+    CCSize bottom_bar_size(visible_size.width, PICTO_CHROME_BOTTOM_BAR_SIZE*MIN(visible_size.width, visible_size.height));
+    initBottomBar(bottom_bar_size, visible_origin);
+    
+    // Bars are created by the first scene showing them
+    top_bar_size_ = CCSizeMake(visible_size.width, PICTO_CHROME_TOP_BAR_SIZE*MIN(visible_size.width, visible_size.height));
+    top_bar_origin_ = ccp(visible_origin.x, visible_origin.y + visible_size.height - top_bar_size_.height);
+    
+    return true;
+}
+
+void PictoChrome::initBottomBar(const CCSize& size, const CCPoint& origin) {
+    
+    CCSprite* normal = CCSprite::create("back_button_background_normal.png");
+    CCSprite* normal_overlay = CCSprite::create("back_button_normal.png");
+    normal_overlay->setAnchorPoint(ccp(0.5, 0.5));
+    normal_overlay->setPosition(ccp(0.5*normal->getContentSize().width,
+                                    0.5*normal->getContentSize().height));
+    normal->addChild(normal_overlay);
+    
+    CCSprite* selected = CCSprite::create("back_button_background_pressed.png");
+    selected->setPosition(ccp(0.5*(normal->getContentSize().width - selected->getContentSize().width),
+                              0.5*(normal->getContentSize().height - selected->getContentSize().height)));
+    selected->setOpacity(160);
+    CCSprite* selected_overlay = CCSprite::create("back_button_pressed.png");
+    selected_overlay->setAnchorPoint(ccp(0.5, 0.5));
+    selected_overlay->setPosition(ccp(0.5*selected->getContentSize().width,
+                                      0.5*selected->getContentSize().height));
+    selected->addChild(selected_overlay);
+    
+    back_button_ = CCMenuItemSprite::create(normal,
+                                            selected,
+                                            this,
+                                            menu_selector(PictoChrome::backPressed));
+    back_button_->setAnchorPoint(ccp(0.5, 0.5));
+    back_button_->setContentSize(normal->getContentSize());
+    back_button_->setPosition(ccp(0.5*size.width, 0.5*size.height));
+    back_button_->setVisible(false);
+    
+    CCMenu* menu = CCMenu::create(back_button_, NULL);
+    menu->setPosition(origin);
+    addChild(menu);
+}
+
+void PictoChrome::show(CCArray* pictograms, CCObject* target, SEL_MenuHandler selector) {
+    
+    if (!path_bar_) {
+        path_bar_ = NavigationBar::create(top_bar_size_, pictograms);
+        path_bar_->setPosition(top_bar_origin_);
+        addChild(path_bar_);
+    } else {
+        path_bar_->setPictograms(pictograms);
+    }
+    path_bar_->setVisible(true);
+    
+    if (title_bar_) {
+        title_bar_->setVisible(false);
+    }
+    
+    setBackTarget(target, selector);
+}
+
+void PictoChrome::show(const char* title, CCObject* target, SEL_MenuHandler selector) {
+    
+    if (!title_bar_) {
+        title_bar_ = NavigationBar::create(top_bar_size_, title);
+        title_bar_->setPosition(top_bar_origin_);
+        addChild(title_bar_);
+    } else {
+        title_bar_->setTitle(title);
+    }
+    title_bar_->setVisible(true);
+    
+    if (path_bar_) {
+        path_bar_->setVisible(false);
+    }
+    
+    setBackTarget(target, selector);
+}
+
+void PictoChrome::contentArea(bool bottom_bar, CCSize& size, CCPoint& origin) {
+    
+    CCSize visible_size = CCDirector::sharedDirector()->getVisibleSize();
+    CCPoint visible_origin = CCDirector::sharedDirector()->getVisibleOrigin();
+    float min_side = MIN(visible_size.width, visible_size.height);
+    
+    float bottom_bar_height = bottom_bar? PICTO_CHROME_BOTTOM_BAR_SIZE*min_side : 0;
+    size = CCSizeMake(visible_size.width, visible_size.height - bottom_bar_height - PICTO_CHROME_TOP_BAR_SIZE*min_side);
+    origin = ccp(visible_origin.x, bottom_bar_height);
+}
+
+void PictoChrome::onEnter() {
+    CCNode::onEnter();
+    themeChanged(NULL);
+    PictoTheme::subscribe(this, callfuncO_selector(PictoChrome::themeChanged));
+}
+
+void PictoChrome::onExit() {
+    PictoTheme::unsubscribe(this);
+    CCNode::onExit();
+}
+
+void PictoChrome::setBackTarget(CCObject* target, SEL_MenuHandler selector) {
+    
+    // Scenes set the target again on every enter, it is never kept past
+    // the scene that set it
+    back_target_ = target;
+    back_selector_ = selector;
+    back_button_->setVisible(target != NULL);
+}
+
+void PictoChrome::backPressed(CCObject* sender) {
+    
+    if (back_target_ && back_selector_) {
+        (back_target_->*back_selector_)(sender);
+    }
+}
+
+void PictoChrome::themeChanged(CCObject* theme) {
+    back_button_->setColor(picto::resources::navigationBarBackgroundColor());
+}
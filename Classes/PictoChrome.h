@@ -0,0 +1,91 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoChrome.h
+ * @brief Back button and navigation bar shared by every scene
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_CHROME_H__
+#define __PICTO_CHROME_H__
+
+#include "cocos2d.h"
+
+class NavigationBar;
+
+// Fractions of the shorter side of the screen taken by the bars
+#define PICTO_CHROME_BOTTOM_BAR_SIZE 0.2
+#define PICTO_CHROME_TOP_BAR_SIZE 0.1
+
+/**
+ * Back button and navigation bar drawn over every scene. They are built
+ * once and drawn as the notification node of the director, so replacing a
+ * scene only swaps its content. Scenes tell the chrome in onEnter what the
+ * bar shows and where the back button leads; the bar is rebuilt only when
+ * the path differs from the one of the previous scene.
+ */
+class PictoChrome : public cocos2d::CCNode {
+    
+public: // constructors and creators
+    
+    static PictoChrome* sharedChrome();
+    
+    PictoChrome();
+    ~PictoChrome();
+    
+public: // public methods
+    
+    // Shows the path to the last of pictograms, or a title, and a back
+    // button calling selector on target when there is a target
+    void show(cocos2d::CCArray* pictograms, cocos2d::CCObject* target, cocos2d::SEL_MenuHandler selector);
+    void show(const char* title, cocos2d::CCObject* target, cocos2d::SEL_MenuHandler selector);
+    
+    // Space left between the bars
+    static void contentArea(bool bottom_bar, cocos2d::CCSize& size, cocos2d::CCPoint& origin);
+    
+private: // private methods
+    
+    bool init();
+    void initBottomBar(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
+    
+    void onEnter();
+    void onExit();
+    void setBackTarget(cocos2d::CCObject* target, cocos2d::SEL_MenuHandler selector);
+    void backPressed(cocos2d::CCObject* sender);
+    void themeChanged(cocos2d::CCObject* theme);
+    
+private: // private variables
+    
+    NavigationBar* path_bar_;
+    NavigationBar* title_bar_;
+    cocos2d::CCSize top_bar_size_;
+    cocos2d::CCPoint top_bar_origin_;
+    
+    cocos2d::CCMenuItem* back_button_;
+    cocos2d::CCObject* back_target_;
+    cocos2d::SEL_MenuHandler back_selector_;
+};
+
+#endif // __PICTO_CHROME_H__
@@ -32,10 +32,36 @@
 
 #include <iostream>
 #include <fstream>
+#include <set>
+#include <string>
 #include <unistd.h>
+#include <vector>
 
+#include "PictoCatalogShard.h"
+#include "PictoNameIndex.h"
+#include "PictoSQLiteProfile.h"
+#include "PictoTagIndex.h"
 #include "sqlite3.h"
 
+// Maximum number of pictograms returned by a name search
+#ifndef PICTO_SEARCH_MAX_RESULTS
+#define PICTO_SEARCH_MAX_RESULTS 50
+#endif
+
+// Edits allowed to the queries of search categories, one from 3 letters on
+// and two from 6 on
+#ifndef PICTO_SEARCH_MAX_EDITS
+#define PICTO_SEARCH_MAX_EDITS 2
+#endif
+
+// Number of identifiers sent in a single "IN (...)" query while loading a shard
+#define PICTO_CATALOG_BATCH_SIZE 256
+
+// Number of tag filters whose matching pictograms are kept in memory
+#ifndef PICTO_FILTER_MAX_RESULTS
+#define PICTO_FILTER_MAX_RESULTS 4
+#endif
+
 USING_NS_CC;
 
 namespace picto
@@ -44,6 +70,39 @@ namespace picto
     {
         sqlite3* g_db_ = NULL;
         
+        // Loaded shards, most recently used first. The root shard is kept apart
+        // because the first grid and the navigation bar always need it.
+        static PictoCatalogShard* g_root_shard_ = NULL;
+        static CCArray* g_shards_ = NULL;
+        
+        // Tag index over the whole catalog, built the first time a filter is used
+        static PictoTagIndex* g_tags_ = NULL;
+        
+        // Matches of the last filters used, most recently used first. Each one
+        // is a partial shard rooted at its virtual category
+        static CCArray* g_filters_ = NULL;
+        
+        // Name index of a single locale, built the first time a search is made
+        static PictoNameIndex* g_names_ = NULL;
+        static std::string g_names_locale_;
+        
+        static void configure(const std::string& path) {
+            
+            // sqlite3_config must run before sqlite3_initialize, which is not
+            // called implicitly when building with SQLITE_OMIT_AUTOINIT
+            int rc = sqlite_profile::configure();
+            if (rc != SQLITE_OK)
+                CCLOGERROR("SQLite memory couldn't be configured [rc=%d]", rc);
+            
+            // Pages of another size than the slots would all go to the heap
+            int page_size = sqlite_profile::pageSize(path.c_str());
+            if (page_size != PICTO_SQLITE_PAGE_SIZE)
+                CCLOGERROR("Database pages don't fit the page cache [page_size=%d]", page_size);
+            
+            rc = sqlite3_initialize();
+            CCAssert(rc == SQLITE_OK, "SQLite couldn't be initialized");
+        }
+        
         void load()
         {
             CCFileUtils *fileUtils = CCFileUtils::sharedFileUtils();
@@ -73,24 +132,53 @@ namespace picto
             
             CCAssert(fileUtils->isFileExist(path), "Database doesn't exists");
             
+            configure(path);
+            
             g_db_ = NULL;
             int rc = sqlite3_open(path.c_str(), &g_db_);
             CCAssert(rc == SQLITE_OK, sqlite3_errmsg(g_db_));
             
+            rc = sqlite_profile::limit(g_db_);
+            if (rc != SQLITE_OK)
+                CCLOGERROR("SQLite cache size couldn't be set [rc=%d]", rc);
+            
+            g_shards_ = CCArray::create();
+            CC_SAFE_RETAIN(g_shards_);
+            
+            g_filters_ = CCArray::create();
+            CC_SAFE_RETAIN(g_filters_);
+            
             CCLOG("Database opened successfully");
         }
         
         void unload() {
+            CC_SAFE_RELEASE_NULL(g_root_shard_);
+            CC_SAFE_RELEASE_NULL(g_shards_);
+            CC_SAFE_RELEASE_NULL(g_filters_);
+            CC_SAFE_DELETE(g_tags_);
+            CC_SAFE_DELETE(g_names_);
+            
             if (g_db_ != NULL) {
                 CCLOG("Closing database");
                 sqlite3_close(g_db_);
                 g_db_ = NULL;
+                sqlite3_shutdown();
             }
         }
         
-        static int pictogram_callback(void *data, int argc, char **argv, char **azColName) {
+        void purge() {
             
-            CCArray *results = static_cast<CCArray*>(data);
+            // Keep the subtree the user is currently visiting
+            while (g_shards_ && g_shards_->count() > 1) {
+                CCLOG("Evicting catalog shard %s", dynamic_cast<PictoCatalogShard*>(g_shards_->lastObject())->getRoot()->getCString());
+                g_shards_->removeLastObject();
+            }
+            
+            while (g_filters_ && g_filters_->count() > 1)
+                g_filters_->removeLastObject();
+        }
+        
+        static PictogramObject* create_pictogram(int argc, char **argv, char **azColName, const char **raw_identifier) {
             
             char *identifier = NULL;
             char *image = NULL;
@@ -115,15 +203,24 @@ namespace picto
                     thumb = argv[i];
             }
             
-            PictogramObject *pictogram = PictogramObject::create(identifier, locale, name, image, sound, thumb);
+            if (raw_identifier != NULL)
+                *raw_identifier = identifier;
+            
+            return PictogramObject::create(identifier, locale, name, image, sound, thumb);
+        }
+        
+        static int pictogram_callback(void *data, int argc, char **argv, char **azColName) {
+            
+            CCArray *results = static_cast<CCArray*>(data);
+            
+            PictogramObject *pictogram = create_pictogram(argc, argv, azColName, NULL);
             if (pictogram != NULL)
                 results->addObject(pictogram);
             
             return 0;
         }
         
-        PictogramObject *pictogram(const char* identifier, const char* locale) {
-            CCAssert(g_db_, "Database isn't loaded");
+        static PictogramObject *query_pictogram(const char* identifier, const char* locale) {
             
             char sql[256];
             sprintf(sql, "SELECT * FROM pictograms WHERE id='%s'", identifier);
@@ -153,71 +250,531 @@ namespace picto
             return result;
         }
         
-        static int childs_callback(void *data, int argc, char **argv, char **azColName) {
+        ///////////////////
+        // Catalog shards
+        
+        struct ShardContext {
+            PictoCatalogShard* shard;
+            const char* locale;
+            std::set<std::string> exact;
+        };
+        
+        struct RelationshipsContext {
+            std::vector<std::string> parents;
+            std::vector<std::string> childs;
+        };
+        
+        static int shard_pictogram_callback(void *data, int argc, char **argv, char **azColName) {
             
-            CCArray *results = static_cast<CCArray*>(data);
+            ShardContext *context = static_cast<ShardContext*>(data);
+            
+            const char *identifier = NULL;
+            PictogramObject *pictogram = create_pictogram(argc, argv, azColName, &identifier);
+            if (pictogram == NULL || context->exact.count(identifier) > 0)
+                return 0;
+            
+            // Same locale preference as query_pictogram: the requested locale
+            // wins, otherwise the last row with a locale is kept
+            if (strcmp(pictogram->getLocale()->getCString(), context->locale) == 0) {
+                context->exact.insert(identifier);
+                context->shard->addPictogram(identifier, pictogram);
+            } else if (strcmp(pictogram->getLocale()->getCString(), ""))
+                context->shard->addPictogram(identifier, pictogram);
+            
+            return 0;
+        }
+        
+        static int relationships_callback(void *data, int argc, char **argv, char **azColName) {
+            
+            RelationshipsContext *context = static_cast<RelationshipsContext*>(data);
+            
+            char *parent = NULL;
+            char *child = NULL;
             
             int i;
             for (i=0; i < argc; i++) {
-                if (strcmp("child", azColName[i]) == 0) {
-                    results->addObject(CCString::create(argv[i]));
+                if (strcmp("parent", azColName[i]) == 0)
+                    parent = argv[i];
+                else if (strcmp("child", azColName[i]) == 0)
+                    child = argv[i];
+            }
+            
+            if (parent != NULL && child != NULL) {
+                context->parents.push_back(parent);
+                context->childs.push_back(child);
+            }
+            
+            return 0;
+        }
+        
+        // Runs "format" once per batch of identifiers, replacing its %s with a
+        // quoted, comma separated list of them
+        static void exec_in(const char* format,
+                            const std::vector<std::string>& identifiers,
+                            int (*callback)(void*, int, char**, char**),
+                            void* data) {
+            
+            for (size_t begin=0; begin < identifiers.size(); begin += PICTO_CATALOG_BATCH_SIZE) {
+                size_t end = MIN(begin + PICTO_CATALOG_BATCH_SIZE, identifiers.size());
+                
+                std::string list;
+                for (size_t i=begin; i < end; i++) {
+                    char *quoted = sqlite3_mprintf("%Q", identifiers[i].c_str());
+                    if (i > begin)
+                        list += ',';
+                    list += quoted;
+                    sqlite3_free(quoted);
+                }
+                
+                char *sql = sqlite3_mprintf(format, list.c_str());
+                char *zErrMsg = 0;
+                int rc = sqlite3_exec(g_db_, sql, callback, data, &zErrMsg);
+                sqlite3_free(sql);
+                
+                if (rc != SQLITE_OK) {
+                    CCLOGERROR("SQL error: %s\n", zErrMsg);
+                    sqlite3_free(zErrMsg);
+                }
+            }
+        }
+        
+        static PictoCatalogShard* load_shard(const char* root, const char* locale, bool complete) {
+            
+            PictoCatalogShard* shard = PictoCatalogShard::create(root, locale, complete);
+            
+            // Walk the subtree level by level. A partial shard stops after
+            // the childs of its root.
+            RelationshipsContext relationships;
+            std::vector<std::string> identifiers(1, root);
+            std::vector<std::string> frontier(1, root);
+            std::set<std::string> visited(identifiers.begin(), identifiers.end());
+            
+            while (!frontier.empty()) {
+                size_t first = relationships.childs.size();
+                exec_in("SELECT parent, child FROM relationships WHERE parent IN (%s)",
+                        frontier, relationships_callback, &relationships);
+                
+                frontier.clear();
+                for (size_t i=first; i < relationships.childs.size(); i++) {
+                    if (visited.insert(relationships.childs[i]).second) {
+                        identifiers.push_back(relationships.childs[i]);
+                        frontier.push_back(relationships.childs[i]);
+                    }
+                }
+                
+                if (!complete)
                     break;
+            }
+            
+            ShardContext context;
+            context.shard = shard;
+            context.locale = locale;
+            exec_in("SELECT * FROM pictograms WHERE id IN (%s)",
+                    identifiers, shard_pictogram_callback, &context);
+            
+            for (size_t i=0; i < relationships.childs.size(); i++)
+                shard->addChild(relationships.parents[i].c_str(), relationships.childs[i].c_str());
+            
+            CCLOG("Catalog shard %s loaded [%lu pictograms]", root, (unsigned long)identifiers.size());
+            
+            return shard;
+        }
+        
+        // Finds the child of the root whose subtree contains the identifier
+        static std::string top_level_of(const char* identifier) {
+            
+            if (g_root_shard_->pictogram(identifier) != NULL)
+                return identifier;
+            
+            std::string current = identifier;
+            std::set<std::string> visited;
+            
+            while (visited.insert(current).second) {
+                RelationshipsContext relationships;
+                exec_in("SELECT parent, child FROM relationships WHERE child IN (%s)",
+                        std::vector<std::string>(1, current), relationships_callback, &relationships);
+                
+                if (relationships.parents.empty())
+                    break;
+                
+                for (size_t i=0; i < relationships.parents.size(); i++) {
+                    if (relationships.parents[i] == ROOT_PICTOGRAM)
+                        return current;
+                }
+                
+                current = relationships.parents[0];
+            }
+            
+            // Pictograms outside the tree get a shard of their own
+            return identifier;
+        }
+        
+        static PictoCatalogShard* shard_for(const char* identifier, const char* locale) {
+            CCAssert(g_db_, "Database isn't loaded");
+            
+            if (g_root_shard_ == NULL || strcmp(g_root_shard_->getLocale()->getCString(), locale)) {
+                CC_SAFE_RELEASE_NULL(g_root_shard_);
+                g_root_shard_ = load_shard(ROOT_PICTOGRAM, locale, false);
+                CC_SAFE_RETAIN(g_root_shard_);
+            }
+            
+            if (g_root_shard_->covers(identifier))
+                return g_root_shard_;
+            
+            for (unsigned int i=0; i < g_shards_->count(); i++) {
+                PictoCatalogShard* shard = dynamic_cast<PictoCatalogShard*>(g_shards_->objectAtIndex(i));
+                if (strcmp(shard->getLocale()->getCString(), locale) == 0 && shard->covers(identifier)) {
+                    if (i > 0) {
+                        shard->retain();
+                        g_shards_->removeObjectAtIndex(i);
+                        g_shards_->insertObject(shard, 0);
+                        shard->release();
+                    }
+                    return shard;
                 }
             }
             
+            PictoCatalogShard* shard = load_shard(top_level_of(identifier).c_str(), locale, true);
+            g_shards_->insertObject(shard, 0);
+            
+            while (g_shards_->count() > PICTO_CATALOG_MAX_SHARDS) {
+                CCLOG("Evicting catalog shard %s", dynamic_cast<PictoCatalogShard*>(g_shards_->lastObject())->getRoot()->getCString());
+                g_shards_->removeLastObject();
+            }
+            
+            return shard->covers(identifier) ? shard : NULL;
+        }
+        
+        ///////////////
+        // Tag index
+        
+        static int tag_index_callback(void *data, int argc, char **argv, char **azColName) {
+            
+            PictoTagIndex *index = static_cast<PictoTagIndex*>(data);
+            
+            char *identifier = NULL;
+            char *tag = NULL;
+            char *level = NULL;
+            
+            int i;
+            for (i=0; i < argc; i++) {
+                if (strcmp("id", azColName[i]) == 0 || strcmp("pictogram", azColName[i]) == 0)
+                    identifier = argv[i];
+                else if (strcmp("tag", azColName[i]) == 0)
+                    tag = argv[i];
+                else if (strcmp("level", azColName[i]) == 0)
+                    level = argv[i];
+            }
+            
+            if (identifier == NULL)
+                return 0;
+            
+            if (tag != NULL)
+                index->tag(identifier, tag);
+            else if (level != NULL)
+                index->level(identifier, atoi(level));
+            else
+                index->add(identifier);
+            
             return 0;
         }
         
-        CCArray *childs(const char* identifier, const char* locale) {
+        static PictoTagIndex* tag_index() {
             CCAssert(g_db_, "Database isn't loaded");
             
-            CCArray *childs = CCArray::create();
+            if (g_tags_ != NULL)
+                return g_tags_;
             
-            CCArray *childs_ids = CCArray::create();
+            g_tags_ = new PictoTagIndex();
             
-            char sql[256];
-            sprintf(sql, "SELECT * FROM relationships WHERE parent='%s'", identifier);
+            // Every pictogram gets an ordinal first so tag bitsets never grow
+            const char* queries[] = {
+                "SELECT DISTINCT id FROM pictograms",
+                "SELECT pictogram, tag FROM tags",
+                "SELECT pictogram, level FROM levels"
+            };
             
-            char *zErrMsg = 0;
-            int rc = sqlite3_exec(g_db_, sql, childs_callback, (void*)childs_ids, &zErrMsg);
+            for (size_t i=0; i < sizeof(queries)/sizeof(queries[0]); i++) {
+                char *zErrMsg = 0;
+                int rc = sqlite3_exec(g_db_, queries[i], tag_index_callback, (void*)g_tags_, &zErrMsg);
+                
+                if (rc != SQLITE_OK) {
+                    CCLOGERROR("SQL error: %s\n", zErrMsg);
+                    sqlite3_free(zErrMsg);
+                }
+            }
             
-            if (rc != SQLITE_OK) {
-                CCLOGERROR("SQL error: %s\n", zErrMsg);
-                sqlite3_free(zErrMsg);
+            CCLOG("Tag index built [%lu pictograms]", (unsigned long)g_tags_->size());
+            
+            return g_tags_;
+        }
+        
+        bool isVirtual(const char* identifier) {
+            return identifier != NULL && (identifier[0] == VIRTUAL_CATEGORY_PREFIX || identifier[0] == SEARCH_CATEGORY_PREFIX);
+        }
+        
+        // Pictogram already held by a loaded shard, without querying the database
+        static PictogramObject* loaded_pictogram(const char* identifier, const char* locale) {
+            
+            if (g_root_shard_ && strcmp(g_root_shard_->getLocale()->getCString(), locale) == 0) {
+                PictogramObject *result = g_root_shard_->pictogram(identifier);
+                if (result != NULL)
+                    return result;
             }
             
             CCObject *it;
-            CCARRAY_FOREACH(childs_ids, it) {
-                CCString *id = dynamic_cast<CCString*>(it);
-                PictogramObject *pictogram = picto::database::pictogram(id->getCString(), locale);
+            CCARRAY_FOREACH(g_shards_, it) {
+                PictoCatalogShard* shard = dynamic_cast<PictoCatalogShard*>(it);
+                if (strcmp(shard->getLocale()->getCString(), locale) == 0) {
+                    PictogramObject *result = shard->pictogram(identifier);
+                    if (result != NULL)
+                        return result;
+                }
+            }
+            
+            return NULL;
+        }
+        
+        static PictoNameIndex* name_index(const char* locale);
+        
+        // Pictograms of a virtual category, in catalog order for tag filters
+        // and best first for name searches
+        static void filter_matches(const char* root, const char* locale, std::vector<std::string>& identifiers) {
+            
+            if (root[0] == SEARCH_CATEGORY_PREFIX) {
+                size_t length = PictoNameIndex::fold(root + 1).size();
+                unsigned int max_edits = MIN(PICTO_SEARCH_MAX_EDITS, length >= 6? 2 : length >= 3? 1 : 0);
+                
+                PictoNameIndex *index = name_index(locale);
+                std::vector<PictoNameIndex::Match> matches = index->search(root + 1, max_edits, PICTO_SEARCH_MAX_RESULTS);
+                for (size_t i=0; i < matches.size(); i++)
+                    identifiers.push_back(index->identifier(matches[i].entry));
+                return;
+            }
+            
+            PictoTagIndex *index = tag_index();
+            PictoBitset matches = index->evaluate(root + 1);
+            for (size_t i=matches.next(0); i < matches.size(); i=matches.next(i + 1))
+                identifiers.push_back(index->identifier(i));
+        }
+        
+        static PictoCatalogShard* load_filter(const char* root, const char* locale) {
+            
+            std::vector<std::string> identifiers;
+            filter_matches(root, locale, identifiers);
+            
+            PictoCatalogShard* shard = PictoCatalogShard::create(root, locale, false);
+            
+            // Matches in loaded shards are shared, the rest come in batches
+            std::vector<std::string> missing;
+            for (size_t i=0; i < identifiers.size(); i++) {
+                PictogramObject *pictogram = loaded_pictogram(identifiers[i].c_str(), locale);
                 if (pictogram != NULL)
-                    childs->addObject(pictogram);
+                    shard->addPictogram(identifiers[i].c_str(), pictogram);
+                else
+                    missing.push_back(identifiers[i]);
             }
             
-            return childs;
+            ShardContext context;
+            context.shard = shard;
+            context.locale = locale;
+            exec_in("SELECT * FROM pictograms WHERE id IN (%s)",
+                    missing, shard_pictogram_callback, &context);
+            
+            // Matches without a pictogram in this locale are left out here, so
+            // counts and positions agree with the childs
+            for (size_t i=0; i < identifiers.size(); i++)
+                shard->addChild(root, identifiers[i].c_str());
+            
+            CCLOG("Filter %s loaded [%u pictograms]", root, shard->childs(root)->count());
+            
+            return shard;
         }
         
-        size_t countChilds(const char* identifier, const char* locale) {
+        static PictoCatalogShard* filter_for(const char* root, const char* locale) {
             CCAssert(g_db_, "Database isn't loaded");
             
-            size_t count = 0;
+            for (unsigned int i=0; i < g_filters_->count(); i++) {
+                PictoCatalogShard* shard = dynamic_cast<PictoCatalogShard*>(g_filters_->objectAtIndex(i));
+                if (strcmp(shard->getLocale()->getCString(), locale) == 0 && strcmp(shard->getRoot()->getCString(), root) == 0) {
+                    if (i > 0) {
+                        shard->retain();
+                        g_filters_->removeObjectAtIndex(i);
+                        g_filters_->insertObject(shard, 0);
+                        shard->release();
+                    }
+                    return shard;
+                }
+            }
             
-            CCArray *childs_ids = CCArray::create();
+            PictoCatalogShard* shard = load_filter(root, locale);
+            g_filters_->insertObject(shard, 0);
             
-            char sql[256];
-            sprintf(sql, "SELECT * FROM relationships WHERE parent='%s'", identifier);
+            while (g_filters_->count() > PICTO_FILTER_MAX_RESULTS)
+                g_filters_->removeLastObject();
+            
+            return shard;
+        }
+        
+        // Shard that knows the childs of a pictogram or virtual category
+        static PictoCatalogShard* parent_shard(const char* identifier, const char* locale) {
+            return isVirtual(identifier)? filter_for(identifier, locale) : shard_for(identifier, locale);
+        }
+        
+        CCArray *filter(const char* expression, const char* locale) {
+            std::string root = std::string(1, VIRTUAL_CATEGORY_PREFIX) + expression;
+            return childs(root.c_str(), locale);
+        }
+        
+        ////////////////
+        // Name index
+        
+        static int name_index_callback(void *data, int argc, char **argv, char **azColName) {
+            
+            PictoNameIndex *index = static_cast<PictoNameIndex*>(data);
+            
+            char *identifier = NULL;
+            char *name = NULL;
+            
+            int i;
+            for (i=0; i < argc; i++) {
+                if (strcmp("id", azColName[i]) == 0)
+                    identifier = argv[i];
+                else if (strcmp("name", azColName[i]) == 0)
+                    name = argv[i];
+            }
+            
+            if (identifier != NULL && name != NULL)
+                index->add(identifier, name);
             
+            return 0;
+        }
+        
+        static PictoNameIndex* name_index(const char* locale) {
+            CCAssert(g_db_, "Database isn't loaded");
+            
+            if (g_names_ != NULL && g_names_locale_ == locale)
+                return g_names_;
+            
+            CC_SAFE_DELETE(g_names_);
+            g_names_ = new PictoNameIndex();
+            g_names_locale_ = locale;
+            
+            char *sql = sqlite3_mprintf("SELECT id, name FROM pictograms WHERE locale=%Q", locale);
             char *zErrMsg = 0;
-            int rc = sqlite3_exec(g_db_, sql, childs_callback, (void*)childs_ids, &zErrMsg);
+            int rc = sqlite3_exec(g_db_, sql, name_index_callback, (void*)g_names_, &zErrMsg);
+            sqlite3_free(sql);
             
             if (rc != SQLITE_OK) {
                 CCLOGERROR("SQL error: %s\n", zErrMsg);
                 sqlite3_free(zErrMsg);
-            } else
-                count = childs_ids->count();
+            }
+            
+            CCLOG("Name index built [%lu pictograms]", (unsigned long)g_names_->size());
+            
+            return g_names_;
+        }
+        
+        CCArray *search(const char* query, unsigned int max_edits, const char* locale) {
+            
+            PictoNameIndex *index = name_index(locale);
+            std::vector<PictoNameIndex::Match> matches = index->search(query, max_edits, PICTO_SEARCH_MAX_RESULTS);
+            
+            CCArray *results = CCArray::createWithCapacity(matches.size());
+            for (size_t i=0; i < matches.size(); i++) {
+                PictogramObject *pictogram = picto::database::pictogram(index->identifier(matches[i].entry).c_str(), locale);
+                if (pictogram != NULL)
+                    results->addObject(pictogram);
+            }
+            
+            return results;
+        }
+        
+        PictogramObject *pictogram(const char* identifier, const char* locale) {
+            CCAssert(g_db_, "Database isn't loaded");
+            
+            if (isVirtual(identifier))
+                return NULL;
+            
+            // Only shards that are already loaded are looked up here, so asking
+            // for a single pictogram never pulls a whole subtree into memory
+            PictogramObject *result = loaded_pictogram(identifier, locale);
+            if (result != NULL)
+                return result;
+            
+            return query_pictogram(identifier, locale);
+        }
+        
+        CCArray *childs(const char* identifier, const char* locale) {
             
-            return count;
+            PictoCatalogShard* shard = parent_shard(identifier, locale);
+            if (shard == NULL)
+                return CCArray::create();
+            
+            // Callers get their own copy of the cached array
+            CCArray *childs = shard->childs(identifier);
+            return (childs != NULL)? CCArray::createWithArray(childs) : CCArray::create();
+        }
+        
+        // Childs of identifier if shard knows them, otherwise NULL
+        static CCArray *known_childs(PictoCatalogShard* shard, const char* identifier, const char* locale) {
+            
+            if (shard == NULL || strcmp(shard->getLocale()->getCString(), locale) || !shard->covers(identifier))
+                return NULL;
+            
+            CCArray *childs = shard->childs(identifier);
+            return (childs != NULL)? CCArray::createWithArray(childs) : CCArray::create();
+        }
+        
+        CCArray *loadedChilds(const char* identifier, const char* locale) {
+            
+            bool virtual_category = isVirtual(identifier);
+            
+            CCArray *childs = virtual_category? NULL : known_childs(g_root_shard_, identifier, locale);
+            if (childs != NULL)
+                return childs;
+            
+            CCArray *shards = virtual_category? g_filters_ : g_shards_;
+            CCObject *it;
+            CCARRAY_FOREACH(shards, it) {
+                childs = known_childs(dynamic_cast<PictoCatalogShard*>(it), identifier, locale);
+                if (childs != NULL)
+                    return childs;
+            }
+            
+            return NULL;
+        }
+        
+        size_t countChilds(const char* identifier, const char* locale) {
+            
+            PictoCatalogShard* shard = parent_shard(identifier, locale);
+            if (shard == NULL)
+                return 0;
+            
+            CCArray *childs = shard->childs(identifier);
+            return (childs != NULL)? childs->count() : 0;
+        }
+        
+        int indexOfChild(const char* parent, const char* identifier, const char* locale) {
+            
+            PictoCatalogShard* shard = parent_shard(parent, locale);
+            return (shard != NULL)? shard->indexOf(parent, identifier) : -1;
+        }
+        
+        PictogramObject *sibling(const char* parent, const char* identifier, int offset, const char* locale) {
+            
+            PictoCatalogShard* shard = parent_shard(parent, locale);
+            if (shard == NULL)
+                return NULL;
+            
+            int index = shard->indexOf(parent, identifier);
+            CCArray *siblings = shard->childs(parent);
+            if (index < 0 || siblings == NULL || siblings->count() == 0)
+                return NULL;
+            
+            int count = siblings->count();
+            int position = ((index + offset) % count + count) % count;
+            return dynamic_cast<PictogramObject*>(siblings->objectAtIndex(position));
         }
     }
 }
-
@@ -35,6 +35,21 @@
 
 #include "PictogramObject.h"
 
+#define ROOT_PICTOGRAM "picto_connection"
+
+// Number of top level subtrees kept in memory besides the root shard
+#ifndef PICTO_CATALOG_MAX_SHARDS
+#define PICTO_CATALOG_MAX_SHARDS 3
+#endif
+
+// Identifiers starting with this character are virtual categories whose
+// childs are the pictograms matching a tag filter, e.g. "?food&level<=2&!hidden"
+#define VIRTUAL_CATEGORY_PREFIX '?'
+
+// Identifiers starting with this character are virtual categories whose
+// childs are the pictograms found by a name search, e.g. "~galleta"
+#define SEARCH_CATEGORY_PREFIX '~'
+
 namespace picto {
     
     namespace database {
@@ -42,9 +57,31 @@ namespace picto {
         void load();
         void unload();
         
+        // Releases every catalog shard and filter result but the root and the
+        // most recently used ones
+        void purge();
+        
         PictogramObject *pictogram(const char* identifier, const char* locale = "es");
         cocos2d::CCArray *childs(const char* identifier, const char* locale = "es");
         size_t countChilds(const char* identifier, const char* locale = "es");
+        
+        // Childs of a pictogram whose shard or filter is already in memory,
+        // NULL when getting them would need the database
+        cocos2d::CCArray *loadedChilds(const char* identifier, const char* locale = "es");
+        
+        // Position of a child among the childs of its parent, -1 if it isn't one
+        int indexOfChild(const char* parent, const char* identifier, const char* locale = "es");
+        
+        // Child "offset" positions away from identifier, wrapping around
+        PictogramObject *sibling(const char* parent, const char* identifier, int offset, const char* locale = "es");
+        
+        // Whether the identifier is a tag filter or a name search
+        bool isVirtual(const char* identifier);
+        cocos2d::CCArray *filter(const char* expression, const char* locale = "es");
+        
+        // Pictograms whose name has a word starting with the query, best first.
+        // With max_edits > 0 misspelled words within that many edits match too.
+        cocos2d::CCArray *search(const char* query, unsigned int max_edits = 0, const char* locale = "es");
     }
 }
 
@@ -0,0 +1,446 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoDecoder.cpp
+ * @brief Image decoding off the main thread
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoDecoder.h"
+
+#include "PictoPremultiply.h"
+#include "PictoRawTexture.h"
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+#include "platform/android/CCFileUtilsAndroid.h"
+#endif
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS)
+#include "png.h"
+#endif
+
+#include <string.h>
+
+USING_NS_CC;
+
+// Textures created on each frame, so decoded images don't stall a frame
+#define PICTO_DECODER_UPLOADS_PER_FRAME 2
+
+// Android rasterizes text through Java classes that can only be looked up
+// from the main thread
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+#define PICTO_DECODER_TEXT_ON_WORKERS 0
+#else
+#define PICTO_DECODER_TEXT_ON_WORKERS 1
+#endif
+
+static PictoDecoder* g_shared_decoder_ = NULL;
+
+// CCImage::initWithString draws into a bitmap shared by all callers on
+// some platforms, so texts are rasterized one at a time
+static pthread_mutex_t g_text_mutex_ = PTHREAD_MUTEX_INITIALIZER;
+
+// On Android files are read from the APK through a zip handle that isn't
+// thread-safe. getFileDataForAsync reads through a second handle, kept for
+// a single background reader, so the workers take turns on it
+static pthread_mutex_t g_read_mutex_ = PTHREAD_MUTEX_INITIALIZER;
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS)
+
+// CCImage over pixels decoded and premultiplied here
+class DecodedImage : public CCImage {
+    
+public:
+    
+    DecodedImage(unsigned char* pixels, int width, int height, bool has_alpha) {
+        m_pData = pixels;
+        m_nWidth = width;
+        m_nHeight = height;
+        m_nBitsPerComponent = 8;
+        m_bHasAlpha = has_alpha;
+        m_bPreMulti = has_alpha;
+    }
+    
+    // Once the texture is uploaded and can be reloaded from its file
+    void releasePixels() {
+        CC_SAFE_DELETE_ARRAY(m_pData);
+    }
+};
+
+struct PngSource {
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+};
+
+static void read_png(png_structp png, png_bytep out, png_size_t length) {
+    
+    PngSource* source = (PngSource*)png_get_io_ptr(png);
+    if (source->offset + length > source->size)
+        png_error(png, "Truncated image");
+    
+    memcpy(out, source->data + source->offset, length);
+    source->offset += length;
+}
+
+// 8 bit RGB, or premultiplied RGBA for images with transparency
+static CCImage* decode_png(const unsigned char* data, size_t size) {
+    
+    if (size < 8 || png_sig_cmp((png_bytep)data, 0, 8) != 0)
+        return NULL;
+    
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png? png_create_info_struct(png) : NULL;
+    if (!info) {
+        png_destroy_read_struct(&png, NULL, NULL);
+        return NULL;
+    }
+    
+    unsigned char* volatile pixels = NULL;
+    png_bytep* volatile rows = NULL;
+    
+    if (setjmp(png_jmpbuf(png))) {
+        delete[] pixels;
+        delete[] rows;
+        png_destroy_read_struct(&png, &info, NULL);
+        return NULL;
+    }
+    
+    PngSource source = { data, size, 0 };
+    png_set_read_fn(png, &source, read_png);
+    png_read_info(png, info);
+    
+    png_uint_32 width, height;
+    int bit_depth, color_type;
+    png_get_IHDR(png, info, &width, &height, &bit_depth, &color_type, NULL, NULL, NULL);
+    
+    if (color_type == PNG_COLOR_TYPE_PALETTE)
+        png_set_palette_to_rgb(png);
+    if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8)
+        png_set_expand_gray_1_2_4_to_8(png);
+    if (png_get_valid(png, info, PNG_INFO_tRNS))
+        png_set_tRNS_to_alpha(png);
+    if (bit_depth == 16)
+        png_set_strip_16(png);
+    if (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA)
+        png_set_gray_to_rgb(png);
+    png_set_interlace_handling(png);
+    png_read_update_info(png, info);
+    
+    bool has_alpha = png_get_channels(png, info) == 4;
+    size_t row_bytes = png_get_rowbytes(png, info);
+    
+    pixels = new unsigned char[row_bytes*height];
+    rows = new png_bytep[height];
+    for (png_uint_32 y=0; y < height; y++) {
+        rows[y] = pixels + y*row_bytes;
+    }
+    
+    png_read_image(png, rows);
+    png_read_end(png, NULL);
+    png_destroy_read_struct(&png, &info, NULL);
+    delete[] rows;
+    
+    if (has_alpha) {
+        picto::conversions::premultiply(pixels, (size_t)width*height);
+    }
+    return new DecodedImage(pixels, width, height, has_alpha);
+}
+
+#endif
+
+PictoDecoder* PictoDecoder::sharedDecoder() {
+    
+    if (!g_shared_decoder_) {
+        g_shared_decoder_ = new PictoDecoder();
+    }
+    return g_shared_decoder_;
+}
+
+PictoDecoder::PictoDecoder() :
+
+pending_(0),
+uploads_per_frame_(PICTO_DECODER_UPLOADS_PER_FRAME),
+rasterize_ms_(0),
+rasterized_(0),
+started_(false),
+quit_(false) {
+    
+    pthread_mutex_init(&mutex_, NULL);
+    pthread_cond_init(&condition_, NULL);
+}
+
+PictoDecoder::~PictoDecoder() {
+    
+    if (started_) {
+        pthread_mutex_lock(&mutex_);
+        quit_ = true;
+        pthread_cond_broadcast(&condition_);
+        pthread_mutex_unlock(&mutex_);
+        
+        for (int i=0; i < PICTO_DECODER_THREADS; i++) {
+            pthread_join(threads_[i], NULL);
+        }
+    }
+    
+    for (size_t i=0; i < jobs_.size(); i++) {
+        CC_SAFE_RELEASE(jobs_[i].target);
+    }
+    for (size_t i=0; i < decoded_.size(); i++) {
+        CC_SAFE_RELEASE(decoded_[i].target);
+        CC_SAFE_RELEASE(decoded_[i].image);
+        PictoRawTexture::release(decoded_[i].pixels);
+    }
+    
+    pthread_cond_destroy(&condition_);
+    pthread_mutex_destroy(&mutex_);
+}
+
+void PictoDecoder::load(const char* image, CCObject* target, SEL_CallFuncO selector) {
+    
+    std::string path = CCFileUtils::sharedFileUtils()->fullPathForFilename(image);
+    
+    // Cached textures need no decoding
+    CCTexture2D* texture = CCTextureCache::sharedTextureCache()->textureForKey(path.c_str());
+    if (texture) {
+        if (target && selector)
+            (target->*selector)(texture);
+        return;
+    }
+    
+    Job job = Job();
+    job.path = path;
+    job.raw = PictoRawTexture::exists(path.c_str());
+    job.target = target;
+    job.selector = selector;
+    push(job, false);
+}
+
+void PictoDecoder::rasterize(const char* text, const char* font, float font_size, CCObject* target, SEL_CallFuncO selector) {
+    
+    Job job = Job();
+    job.text = text;
+    job.font = font;
+    job.font_size = font_size*CC_CONTENT_SCALE_FACTOR();
+    job.target = target;
+    job.selector = selector;
+    push(job, !PICTO_DECODER_TEXT_ON_WORKERS);
+}
+
+void PictoDecoder::setUploadsPerFrame(int uploads) {
+    
+    uploads_per_frame_ = MAX(1, uploads);
+}
+
+float PictoDecoder::rasterizeTime(int* texts) {
+    
+    float ms = rasterize_ms_;
+    if (texts)
+        *texts = rasterized_;
+    
+    rasterize_ms_ = 0;
+    rasterized_ = 0;
+    return ms;
+}
+
+unsigned char* PictoDecoder::readFile(const std::string& path, unsigned long* size) {
+    
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    pthread_mutex_lock(&g_read_mutex_);
+    CCFileUtilsAndroid* file_utils = static_cast<CCFileUtilsAndroid*>(CCFileUtils::sharedFileUtils());
+    unsigned char* data = file_utils->getFileDataForAsync(path.c_str(), "rb", size);
+    pthread_mutex_unlock(&g_read_mutex_);
+    return data;
+#else
+    return CCFileUtils::sharedFileUtils()->getFileData(path.c_str(), "rb", size);
+#endif
+}
+
+void* PictoDecoder::work(void* data) {
+    
+    PictoDecoder* decoder = static_cast<PictoDecoder*>(data);
+    
+    for (;;) {
+        pthread_mutex_lock(&decoder->mutex_);
+        while (decoder->jobs_.empty() && !decoder->quit_) {
+            pthread_cond_wait(&decoder->condition_, &decoder->mutex_);
+        }
+        if (decoder->quit_) {
+            pthread_mutex_unlock(&decoder->mutex_);
+            break;
+        }
+        Job job = decoder->jobs_.front();
+        decoder->jobs_.pop_front();
+        pthread_mutex_unlock(&decoder->mutex_);
+        
+        if (job.path.empty()) {
+            job.image = render(job);
+        } else {
+            // Images whose blob can't be read are decoded instead
+            if (job.raw && !PictoRawTexture::read(job.path, job.pixels))
+                job.raw = false;
+            if (!job.raw)
+                job.image = decode(job.path);
+        }
+        
+        pthread_mutex_lock(&decoder->mutex_);
+        decoder->decoded_.push_back(job);
+        pthread_mutex_unlock(&decoder->mutex_);
+    }
+    
+    return NULL;
+}
+
+CCImage* PictoDecoder::decode(const std::string& path) {
+    
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+    // The system decoder premultiplies already
+    CCImage* image = new CCImage();
+    if (!image->initWithImageFileThreadSafe(path.c_str())) {
+        delete image;
+        return NULL;
+    }
+    return image;
+#else
+    unsigned long size = 0;
+    unsigned char* data = readFile(path, &size);
+    if (!data)
+        return NULL;
+    
+    CCImage* image = decode_png(data, size);
+    delete[] data;
+    return image;
+#endif
+}
+
+CCImage* PictoDecoder::render(Job& job) {
+    
+    struct cc_timeval start, end;
+    CCTime::gettimeofdayCocos2d(&start, NULL);
+    
+    pthread_mutex_lock(&g_text_mutex_);
+    CCImage* image = new CCImage();
+    if (!image->initWithString(job.text.c_str(), 0, 0, CCImage::kAlignCenter, job.font.c_str(), (int)job.font_size)) {
+        delete image;
+        image = NULL;
+    }
+    pthread_mutex_unlock(&g_text_mutex_);
+    
+    CCTime::gettimeofdayCocos2d(&end, NULL);
+    job.ms = (float)CCTime::timersubCocos2d(&start, &end);
+    
+    return image;
+}
+
+void PictoDecoder::push(const Job& job, bool decoded) {
+    
+    if (!started_ && !decoded) {
+        for (int i=0; i < PICTO_DECODER_THREADS; i++) {
+            pthread_create(&threads_[i], NULL, &PictoDecoder::work, this);
+        }
+        started_ = true;
+    }
+    
+    CC_SAFE_RETAIN(job.target);
+    
+    pthread_mutex_lock(&mutex_);
+    if (decoded) {
+        decoded_.push_back(job);
+    } else {
+        jobs_.push_back(job);
+        pthread_cond_signal(&condition_);
+    }
+    pthread_mutex_unlock(&mutex_);
+    
+    if (pending_++ == 0) {
+        CCDirector::sharedDirector()->getScheduler()->scheduleSelector(schedule_selector(PictoDecoder::upload), this, 0, false);
+    }
+}
+
+void PictoDecoder::upload(float dt) {
+    
+    for (int i=0; i < uploads_per_frame_; i++) {
+        pthread_mutex_lock(&mutex_);
+        if (decoded_.empty()) {
+            pthread_mutex_unlock(&mutex_);
+            break;
+        }
+        Job job = decoded_.front();
+        decoded_.pop_front();
+        pthread_mutex_unlock(&mutex_);
+        
+        CCTexture2D* texture = NULL;
+        if (job.path.empty()) {
+            // Texts queued to be rasterized here
+            if (!job.image) {
+                job.image = render(job);
+            }
+            
+            rasterize_ms_ += job.ms;
+            rasterized_++;
+            
+            if (job.image) {
+                texture = new CCTexture2D();
+                if (texture->initWithImage(job.image)) {
+                    texture->autorelease();
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+                    VolatileTexture::addStringTexture(texture, job.text.c_str(), CCSizeZero, kCCTextAlignmentCenter,
+                                                      kCCVerticalTextAlignmentTop, job.font.c_str(), job.font_size);
+#endif
+                } else {
+                    CC_SAFE_DELETE(texture);
+                }
+                job.image->release();
+            } else {
+                CCLOGERROR("Can't rasterize %s", job.text.c_str());
+            }
+        } else if (job.raw) {
+            texture = PictoRawTexture::upload(job.pixels, job.path);
+            if (!texture)
+                CCLOGERROR("Can't upload %s", job.path.c_str());
+        } else if (job.image) {
+            texture = CCTextureCache::sharedTextureCache()->addUIImage(job.image, job.path.c_str());
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+            // Reload from the file when the GL context is lost, rather than
+            // keeping the pixels around
+            if (texture) {
+                VolatileTexture::addImageTexture(texture, job.path.c_str(), CCImage::kFmtPng);
+                static_cast<DecodedImage*>(job.image)->releasePixels();
+            }
+#endif
+            job.image->release();
+        } else {
+            CCLOGERROR("Can't decode %s", job.path.c_str());
+        }
+        
+        if (job.target && job.selector)
+            (job.target->*job.selector)(texture);
+        CC_SAFE_RELEASE(job.target);
+        
+        if (--pending_ == 0) {
+            CCDirector::sharedDirector()->getScheduler()->unscheduleSelector(schedule_selector(PictoDecoder::upload), this);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoDecoder.h
+ * @brief Image decoding off the main thread
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_DECODER_H__
+#define __PICTO_DECODER_H__
+
+#include "cocos2d.h"
+
+#include "PictoRawTexture.h"
+
+#include <pthread.h>
+
+#include <deque>
+#include <string>
+
+// Threads decoding images at the same time
+#define PICTO_DECODER_THREADS 2
+
+/**
+ * Decodes PNG images on a pool of worker threads into premultiplied RGBA
+ * buffers ready to upload, so the main thread only creates the textures.
+ * Images with a raw blob have it read and decompressed on the workers.
+ * Uploads are spread over frames, a few per frame, and land in the cocos2d
+ * texture cache under the same key CCTextureCache::addImage would use.
+ * Text is rasterized the same way for labels the glyph atlases can't draw,
+ * except on Android, where it's rasterized on the main thread as it's
+ * uploaded because the JNI text renderer is only reachable from there.
+ */
+class PictoDecoder : public cocos2d::CCObject {
+    
+public: // constructors and creators
+    
+    static PictoDecoder* sharedDecoder();
+    
+    PictoDecoder();
+    ~PictoDecoder();
+    
+public: // public methods
+    
+    // Calls selector on target with the texture of image, or NULL if it
+    // couldn't be decoded, once it has been uploaded
+    void load(const char* image, cocos2d::CCObject* target, cocos2d::SEL_CallFuncO selector);
+    
+    // Calls selector on target with a texture of text, not cached, or NULL
+    // if it couldn't be rasterized
+    void rasterize(const char* text, const char* font, float font_size, cocos2d::CCObject* target, cocos2d::SEL_CallFuncO selector);
+    
+    void setUploadsPerFrame(int uploads);
+    
+    // Time spent rasterizing text since the last call and how many texts
+    float rasterizeTime(int* texts);
+    
+    // Contents of a file, to delete[], or NULL. Safe from the workers
+    static unsigned char* readFile(const std::string& path, unsigned long* size);
+    
+private: // private types
+    
+    // Jobs without a path rasterize text, the others read the raw blob or
+    // decode the image
+    struct Job {
+        std::string path;
+        bool raw;
+        PictoRawTexture::Pixels pixels;
+        std::string text;
+        std::string font;
+        float font_size;
+        float ms;
+        cocos2d::CCObject* target;
+        cocos2d::SEL_CallFuncO selector;
+        cocos2d::CCImage* image;
+    };
+    
+private: // private methods
+    
+    void push(const Job& job, bool decoded);
+    
+    static void* work(void* decoder);
+    static cocos2d::CCImage* decode(const std::string& path);
+    static cocos2d::CCImage* render(Job& job);
+    
+    void upload(float dt);
+    
+private: // private variables
+    
+    pthread_t threads_[PICTO_DECODER_THREADS];
+    pthread_mutex_t mutex_;
+    pthread_cond_t condition_;
+    
+    std::deque<Job> jobs_;
+    std::deque<Job> decoded_;
+    int pending_;
+    int uploads_per_frame_;
+    float rasterize_ms_;
+    int rasterized_;
+    bool started_;
+    bool quit_;
+};
+
+#endif // __PICTO_DECODER_H__
@@ -30,6 +30,8 @@
 
 #include "PictoDefs.h"
 
+#include "PictoSettings.h"
+
 #include <clocale>
 #include <locale>
 #include <iostream>
@@ -38,8 +40,6 @@
 #include <sys/time.h>
 #include <vector>
 
-#include <utf8.h>
-
 #include "SimpleAudioEngine.h"
 
 USING_NS_CC;
@@ -48,12 +48,28 @@ namespace picto {
     
     namespace cocos2d_utils
     {
-        CCLabelTTF* createLabel(const char* text, const float font_size) {
+        PictoLabel* createLabel(const char* text, const float font_size) {
+            
+            if (PictoSettings::sharedSettings()->getBool("use_capitals", true))
+                return PictoLabel::create(picto::conversions::toupper(text).c_str(), font_size);
+            else
+                return PictoLabel::create(text, font_size);
+        }
+        
+        PictoLabel* createLabelAsync(const char* text, const float font_size) {
             
-            if (CCUserDefault::sharedUserDefault()->getBoolForKey("use_capitals", true))
-                return CCLabelTTF::create(picto::conversions::toupper(text).c_str(), "Arial", font_size);
+            if (PictoSettings::sharedSettings()->getBool("use_capitals", true))
+                return PictoLabel::createAsync(picto::conversions::toupper(text).c_str(), font_size);
             else
-                return CCLabelTTF::create(text, "Arial", font_size);
+                return PictoLabel::createAsync(text, font_size);
+        }
+        
+        bool labelCovered(const char* text) {
+            
+            if (PictoSettings::sharedSettings()->getBool("use_capitals", true))
+                return PictoLabel::covered(picto::conversions::toupper(text).c_str());
+            else
+                return PictoLabel::covered(text);
         }
         
         clock_t g_snd_played_time_ = clock();
@@ -85,80 +101,37 @@ namespace picto {
             return ccc4((0xFF0000 & rgb) >> 16, (0x00FF00 & rgb) >> 8, 0x0000FF & rgb, 255);
         }
         
-        std::wstring toupper(wchar_t in) {
-            wchar_t out = std::toupper(in);
-            std::wstring wsout;
-            
-            if (out != in || isupper(in) || isspace(in) || isdigit(in))
-                wsout = out;
-            else {
-                const std::wstring lowercase = L"áàâäãéèêëíìîïóòôöõúùûüçñ";
-                const std::wstring uppercase = L"ÁÀÂÄÃÉÈÊËÍÌÎÏÓÒÔÖÕÚÙÛÜÇÑ";
-                size_t pos = lowercase.find(in);
-                if (pos != std::string::npos) {
-                    wsout = uppercase[pos];
-                } else if(in == L'ß')
-                    wsout = L"SS";
-                else {
-                    wsout = out;
-                }
-            }
-            
-            return wsout;
-        }
-        
-        std::wstring toupper(std::wstring in) {
-            std::wstring out;
-            out.reserve(in.length());
-            for (int i=0; i < in.length(); i++)
-                out += toupper(in[i]);
-            
-            return out;
-        }
-        
-        std::string toupper(std::string in) {
-            
-            std::wstring win;
-            win.reserve(in.size());
-            utf8::utf8to16(in.begin(), in.end(), back_inserter(win));
-            std::wstring wout = toupper(win);
-            std::string out;
-            out.reserve(2*wout.size());
-            utf8::utf16to8(wout.begin(), wout.end(), back_inserter(out));
-            
-            return out;
-        }
     }
     
     namespace resources
     {
         ccColor3B backgroundColor() {
-            int color = CCUserDefault::sharedUserDefault()->getIntegerForKey("backgroundColor", 0x5cc4dc);
+            int color = PictoSettings::sharedSettings()->getInteger("backgroundColor", 0x5cc4dc);
             return conversions::int2color3B(color);
         }
         
         ccColor3B menuTextColor() {
-            int color = CCUserDefault::sharedUserDefault()->getIntegerForKey("menuTextColor", 0xffffff);
+            int color = PictoSettings::sharedSettings()->getInteger("menuTextColor", 0xffffff);
             return conversions::int2color3B(color);
         }
         
         ccColor3B navigationBarBackgroundColor() {
-            int color = CCUserDefault::sharedUserDefault()->getIntegerForKey("navigationBarBackgroundColor", 0x024e68);
+            int color = PictoSettings::sharedSettings()->getInteger("navigationBarBackgroundColor", 0x024e68);
             return conversions::int2color3B(color);
         }
         
         ccColor3B navigationBarTextColor() {
-            int color = CCUserDefault::sharedUserDefault()->getIntegerForKey("navigationBarTextColor", 0xffffff);
+            int color = PictoSettings::sharedSettings()->getInteger("navigationBarTextColor", 0xffffff);
             return conversions::int2color3B(color);
         }
         
         ccColor3B speakerButtonBackgroundColor() {
-            int color = CCUserDefault::sharedUserDefault()->getIntegerForKey("speakerButtonBackgroundColor", 0xffff00);
+            int color = PictoSettings::sharedSettings()->getInteger("speakerButtonBackgroundColor", 0xffff00);
             return conversions::int2color3B(color);
         }
         
         ccColor3B speakerButtonTextColor() {
-            int color = CCUserDefault::sharedUserDefault()->getIntegerForKey("speakerButtonTextColor", 0x000000);
+            int color = PictoSettings::sharedSettings()->getInteger("speakerButtonTextColor", 0x000000);
             return conversions::int2color3B(color);
         }
         
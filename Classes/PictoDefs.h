@@ -33,6 +33,9 @@
 
 #include "cocos2d.h"
 
+#include "PictoLabel.h"
+#include "PictoUpperCase.h"
+
 #include <stddef.h>
 
 #define DEFAULT_COLOR_THEME 0x3694B3
@@ -41,7 +44,11 @@ namespace picto
 {
     namespace cocos2d_utils
     {
-        cocos2d::CCLabelTTF* createLabel(const char* text, const float font_size);
+        PictoLabel* createLabel(const char* text, const float font_size);
+        PictoLabel* createLabelAsync(const char* text, const float font_size);
+        
+        // Whether the label createLabel makes of text rasterizes nothing
+        bool labelCovered(const char* text);
         bool playEffect(const char* effect);
     }
     
@@ -51,9 +58,6 @@ namespace picto
         cocos2d::ccColor3B int2color3B(unsigned int rgb);
         cocos2d::ccColor4B int2color4B(unsigned int rgb);
         
-        std::wstring toupper(wchar_t in);
-        std::string toupper(std::string in);
-        std::wstring toupper(std::wstring in);
         std::wstring utf8_to_utf16(const std::string& utf8);
     }
     
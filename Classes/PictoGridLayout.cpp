@@ -0,0 +1,224 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoGridLayout.cpp
+ * @brief Node layout shared by the grid, gallery and theme scenes
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoGridLayout.h"
+
+#include <algorithm>
+#include <map>
+
+// Memoized grids, dropped all at once when the cache fills up
+#define PICTO_GRID_LAYOUT_CACHE_SIZE 64
+
+namespace {
+    
+    struct Key {
+        int num_elements;
+        float width;
+        float height;
+        float node_ratio;
+        float margin;
+        
+        bool operator<(const Key& other) const {
+            if (num_elements != other.num_elements) return num_elements < other.num_elements;
+            if (width != other.width) return width < other.width;
+            if (height != other.height) return height < other.height;
+            if (node_ratio != other.node_ratio) return node_ratio < other.node_ratio;
+            return margin < other.margin;
+        }
+    };
+    
+    std::map<Key, PictoGridLayout::Grid> g_grids_;
+    
+    /**
+     * Running best of the search. Candidates are ranked by node area and then
+     * by compactness, and a candidate only replaces an equal one when it comes
+     * first, so the order of the search doesn't change the winner.
+     */
+    struct Search {
+        int num_elements;
+        float width;
+        float node_ratio;
+        float margin;
+        
+        float max_area;
+        float max_compactness;
+        PictoGridLayout::Grid best;
+        
+        void consider(int rows, int cols, float max_width, float max_height) {
+            
+            float node_width = (width - (cols+1)*margin) / cols;
+            if (node_width > max_width)
+                node_width = max_width;
+            
+            float node_height = node_width * node_ratio;
+            if (node_height > max_height)
+                node_height = max_height;
+            
+            // Grids without room for the nodes rank below every other one
+            float area = (node_width > 0 && node_height > 0)? node_width*node_height : 0;
+            float compactness = (float)num_elements/(float)(rows*cols);
+            if (area > max_area || (area == max_area && compactness > max_compactness)) {
+                max_area = area;
+                max_compactness = compactness;
+                best.rows = rows;
+                best.cols = cols;
+            }
+        }
+    };
+}
+
+PictoGridLayout::Grid PictoGridLayout::solve(int num_elements, float width, float height, float node_ratio, float margin) {
+    
+    Key key = { num_elements, width, height, node_ratio, margin };
+    std::map<Key, Grid>::const_iterator it = g_grids_.find(key);
+    if (it != g_grids_.end())
+        return it->second;
+    
+    if (g_grids_.size() >= PICTO_GRID_LAYOUT_CACHE_SIZE)
+        g_grids_.clear();
+    
+    Grid grid = compute(num_elements, width, height, node_ratio, margin);
+    g_grids_[key] = grid;
+    return grid;
+}
+
+PictoGridLayout::Grid PictoGridLayout::compute(int num_elements, float width, float height, float node_ratio, float margin) {
+    
+    Search search;
+    search.num_elements = num_elements;
+    search.width = width;
+    search.node_ratio = node_ratio;
+    search.margin = margin;
+    search.max_area = 0;
+    search.max_compactness = 0;
+    search.best.rows = 1;
+    search.best.cols = num_elements;
+    
+    for (int rows=1; rows <= num_elements; rows++) {
+        
+        float max_height = (height - (rows+1)*margin) / rows;
+        float max_width = max_height / node_ratio;
+        
+        // Not even unbounded columns would beat the best so far, and more
+        // rows only get shorter nodes. Like the original search, rows that
+        // could only tie are skipped, even if they were more compact.
+        if (max_height <= 0 || max_height*max_width <= search.max_area)
+            break;
+        
+        // Node width only grows as columns are removed, so the best
+        // arrangement for these rows uses the fewest columns
+        int cols = (num_elements + rows - 1) / rows;
+        search.consider(rows, cols, max_width, max_height);
+    }
+    
+    return search.best;
+}
+
+PictoGridLayout::Style PictoGridLayout::defaultStyle(const Rect& viewport) {
+    
+    Style style;
+    style.margin = 0.02*std::max(viewport.width, viewport.height);
+    style.node_ratio = 1;
+    return style;
+}
+
+void PictoGridLayout::arrange(size_t count, const Rect& viewport, const Style& style, std::vector<Rect>& rects) {
+    
+    if (count == 0) {
+        rects.clear();
+        return;
+    }
+    
+    Grid grid = solve((int)count, viewport.width, viewport.height, style.node_ratio, style.margin);
+    arrange(count, grid, viewport, style, rects);
+}
+
+void PictoGridLayout::arrange(size_t count, const Grid& grid, const Rect& viewport, const Style& style, std::vector<Rect>& rects) {
+    
+    rects.clear();
+    if (count == 0)
+        return;
+    
+    rects.reserve(count);
+    
+    Rect rect = node(grid, viewport, style);
+    float step_x = rect.width + style.margin;
+    float step_y = rect.height + style.margin;
+    
+    float center_x = viewport.x + 0.5*viewport.width;
+    float center_y = viewport.y + 0.5*viewport.height;
+    
+    size_t n = 0;
+    for (int i=0; i < grid.rows && n < count; i++) {
+        
+        // Start from top
+        rect.y = center_y + (0.5*(grid.rows - 1) - i)*step_y - 0.5*rect.height;
+        
+        int icols = (int)std::min((size_t)grid.cols, count - n);
+        float left_x = center_x - 0.5*(icols - 1)*step_x - 0.5*rect.width;
+        for (int j=0; j < icols; j++, n++) {
+            rect.x = left_x + j*step_x;
+            rects.push_back(rect);
+        }
+    }
+}
+
+void PictoGridLayout::pages(int first, int count, const Rect& viewport, const Style& style, std::vector<Rect>& rects) {
+    
+    rects.clear();
+    rects.reserve(count);
+    
+    Grid grid = { 1, 1 };
+    Rect rect = node(grid, viewport, style);
+    rect.y = viewport.y + 0.5*(viewport.height - rect.height);
+    
+    for (int i=first; i < first + count; i++) {
+        rect.x = viewport.x + i*viewport.width + 0.5*(viewport.width - rect.width);
+        rects.push_back(rect);
+    }
+}
+
+PictoGridLayout::Rect PictoGridLayout::node(const Grid& grid, const Rect& viewport, const Style& style) {
+    
+    Rect rect;
+    rect.x = viewport.x;
+    rect.y = viewport.y;
+    rect.width = (viewport.width - (grid.cols + 1)*style.margin) / grid.cols;
+    rect.height = (viewport.height - (grid.rows + 1)*style.margin) / grid.rows;
+    
+    rect.height = std::min(rect.height, rect.width * style.node_ratio);
+    rect.width = rect.height / style.node_ratio;
+    return rect;
+}
+
+void PictoGridLayout::purge() {
+    
+    g_grids_.clear();
+}
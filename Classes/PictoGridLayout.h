@@ -0,0 +1,94 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoGridLayout.h
+ * @brief Node layout shared by the grid, gallery and theme scenes
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_GRID_LAYOUT_H__
+#define __PICTO_GRID_LAYOUT_H__
+
+#include <stddef.h>
+#include <vector>
+
+/**
+ * Rows and columns that fit a number of nodes in a grid giving each one the
+ * biggest possible area, and the most compact arrangement among those that
+ * tie. Results are memoized, so scenes can solve the same grid every time
+ * they are built.
+ *
+ * The layout is plain arithmetic on rects, with no dependency on cocos2d, so
+ * scenes can relayout without rebuilding their nodes.
+ */
+class PictoGridLayout {
+    
+public: // public types
+    
+    struct Grid {
+        int rows;
+        int cols;
+    };
+    
+    // Bottom left corner and size, in the coordinates of the viewport
+    struct Rect {
+        float x;
+        float y;
+        float width;
+        float height;
+    };
+    
+    struct Style {
+        float margin;
+        float node_ratio; // height / width
+    };
+    
+public: // public methods
+    
+    // Margins of 2% of the longest side and square nodes
+    static Style defaultStyle(const Rect& viewport);
+    
+    // Rects of count nodes, in rows from the top left, and an incomplete last
+    // row centered like the others
+    static void arrange(size_t count, const Rect& viewport, const Style& style, std::vector<Rect>& rects);
+    static void arrange(size_t count, const Grid& grid, const Rect& viewport, const Style& style, std::vector<Rect>& rects);
+    
+    // Rects of single node pages, page 0 centered in the viewport and page i
+    // shifted i viewport widths to the right
+    static void pages(int first, int count, const Rect& viewport, const Style& style, std::vector<Rect>& rects);
+    
+    // Biggest node of the given ratio that fits a cell of the grid
+    static Rect node(const Grid& grid, const Rect& viewport, const Style& style);
+    
+    // Memoized by (num_elements, width, height, node_ratio, margin)
+    static Grid solve(int num_elements, float width, float height, float node_ratio, float margin);
+    
+    // Unmemoized solver, linear in num_elements
+    static Grid compute(int num_elements, float width, float height, float node_ratio, float margin);
+    
+    static void purge();
+};
+
+#endif // __PICTO_GRID_LAYOUT_H__
@@ -0,0 +1,80 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoImagePyramid.cpp
+ * @brief Size-aware selection of pictogram image levels
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoImagePyramid.h"
+
+#include <map>
+
+USING_NS_CC;
+
+// Longest side of each level, in pixels. Must match tools/build_pyramid.py
+static const int g_levels_[] = { 64, 128, 256, 512 };
+static const int g_num_levels_ = sizeof(g_levels_) / sizeof(g_levels_[0]);
+
+// Whether each level path exists, so the file system is asked once
+static std::map<std::string, bool> g_exists_;
+
+std::string PictoImagePyramid::image(PictogramObject* pictogram, const CCSize& size) {
+    
+    const char* image = pictogram->getImage()->getCString();
+    float pixels = MAX(size.width, size.height)*CC_CONTENT_SCALE_FACTOR();
+    
+    for (int i=0; i < g_num_levels_; i++) {
+        if (g_levels_[i] < pixels)
+            continue;
+        
+        std::string path = level(image, g_levels_[i]);
+        std::map<std::string, bool>::iterator it = g_exists_.find(path);
+        if (it == g_exists_.end()) {
+            it = g_exists_.insert(std::make_pair(path, CCFileUtils::sharedFileUtils()->isFileExist(path))).first;
+        }
+        if (it->second)
+            return path;
+    }
+    
+    return image;
+}
+
+std::string PictoImagePyramid::level(const char* image, int level) {
+    
+    std::string path(image);
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of('/');
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+        path.erase(dot);
+    
+    CCString* suffix = CCString::createWithFormat("@%d.png", level);
+    return path + suffix->getCString();
+}
+
+void PictoImagePyramid::purge() {
+    
+    g_exists_.clear();
+}
@@ -0,0 +1,61 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoImagePyramid.h
+ * @brief Size-aware selection of pictogram image levels
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_IMAGE_PYRAMID_H__
+#define __PICTO_IMAGE_PYRAMID_H__
+
+#include "cocos2d.h"
+
+#include "PictogramObject.h"
+
+#include <string>
+
+/**
+ * Picks the level of the image pyramid built by tools/build_pyramid.py that
+ * fits an on-screen size, so texture memory and decode time follow what is
+ * drawn rather than the size of the source image. Levels are 64, 128, 256
+ * and 512 pixels on their longest side; the full image is used above them
+ * or when a level is missing.
+ */
+class PictoImagePyramid {
+    
+public: // public methods
+    
+    // Smallest image of the pictogram at least as big as size points
+    static std::string image(PictogramObject* pictogram, const cocos2d::CCSize& size);
+    
+    // Path of a level of an image
+    static std::string level(const char* image, int level);
+    
+    // Forgets which levels exist
+    static void purge();
+};
+
+#endif // __PICTO_IMAGE_PYRAMID_H__
@@ -0,0 +1,270 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoLabel.cpp
+ * @brief Labels drawn from a shared glyph atlas
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoLabel.h"
+
+#include "PictoDecoder.h"
+#include "PictoSDFLabel.h"
+
+#include <utf8.h>
+
+USING_NS_CC;
+
+// Coverage atlas written by tools/build_font.py
+#define PICTO_LABEL_FONT "fonts/picto.fnt"
+
+// Size the atlas glyphs are rendered at, in pixels. Must match tools/build_font.py
+#define PICTO_LABEL_FONT_SIZE 64
+
+// Font of the labels the atlas can't draw
+#define PICTO_LABEL_FALLBACK_FONT "Arial"
+
+// Atlases in order of preference, the distance field one scales best
+static const char* g_fonts_[] = { PICTO_SDF_LABEL_FONT, PICTO_LABEL_FONT };
+static const int g_num_fonts_ = sizeof(g_fonts_) / sizeof(g_fonts_[0]);
+
+// Whether each atlas is bundled: -1 unknown, 0 no, 1 yes
+static int g_bundled_[] = { -1, -1 };
+
+// Labels rasterized on the main thread, for the scene build traces
+static float g_rasterize_ms_ = 0;
+static int g_rasterized_ = 0;
+
+PictoLabel::PictoLabel() :
+
+label_(NULL),
+font_(NULL),
+font_size_(0),
+max_width_(0),
+async_(false),
+waiting_(false)
+{}
+
+PictoLabel::~PictoLabel() {}
+
+PictoLabel* PictoLabel::create(const char* text, float font_size) {
+    
+    PictoLabel* label = new PictoLabel();
+    if (label && label->init(text, font_size, false)) {
+        label->autorelease();
+        return label;
+    }
+    CC_SAFE_DELETE(label);
+    return NULL;
+}
+
+PictoLabel* PictoLabel::createAsync(const char* text, float font_size) {
+    
+    PictoLabel* label = new PictoLabel();
+    if (label && label->init(text, font_size, true)) {
+        label->autorelease();
+        return label;
+    }
+    CC_SAFE_DELETE(label);
+    return NULL;
+}
+
+bool PictoLabel::init(const char* text, float font_size, bool async) {
+    
+    if (!CCNodeRGBA::init()) {
+        return false;
+    }
+    
+    font_size_ = font_size;
+    async_ = async;
+    
+    // Same anchor as the CCLabelTTF this replaces
+    setAnchorPoint(ccp(0.5, 0.5));
+    setLabel(text);
+    
+    return true;
+}
+
+void PictoLabel::setString(const char* text) {
+    
+    if (text_ == text)
+        return;
+    
+    if (font_ && !waiting_ && covers(font_, text)) {
+        text_ = text;
+        dynamic_cast<CCLabelProtocol*>(label_)->setString(text);
+        setContentSize(CCSizeMake(label_->getContentSize().width*label_->getScale(),
+                                  label_->getContentSize().height*label_->getScale()));
+        if (max_width_ > 0)
+            setMaxWidth(max_width_);
+    }
+    else {
+        setLabel(text);
+    }
+}
+
+const char* PictoLabel::getString() {
+    return text_.c_str();
+}
+
+void PictoLabel::setColor(const ccColor3B& color) {
+    CCNodeRGBA::setColor(color);
+    dynamic_cast<CCRGBAProtocol*>(label_)->setColor(color);
+}
+
+void PictoLabel::setOpacity(GLubyte opacity) {
+    CCNodeRGBA::setOpacity(opacity);
+    dynamic_cast<CCRGBAProtocol*>(label_)->setOpacity(opacity);
+}
+
+void PictoLabel::setMaxWidth(float width) {
+    
+    max_width_ = width;
+    if (getContentSize().width > 0)
+        setScale(MIN(1, max_width_ / getContentSize().width));
+}
+
+bool PictoLabel::covered(const char* text) {
+    
+    return font(text) != NULL;
+}
+
+float PictoLabel::rasterizeTime(int* labels) {
+    
+    float ms = g_rasterize_ms_;
+    if (labels)
+        *labels = g_rasterized_;
+    
+    g_rasterize_ms_ = 0;
+    g_rasterized_ = 0;
+    return ms;
+}
+
+const char* PictoLabel::font(const char* text) {
+    
+    for (int i=0; i < g_num_fonts_; i++) {
+        if (g_bundled_[i] < 0) {
+            g_bundled_[i] = CCFileUtils::sharedFileUtils()->isFileExist(CCFileUtils::sharedFileUtils()->fullPathForFilename(g_fonts_[i]));
+        }
+        if (g_bundled_[i] && covers(g_fonts_[i], text))
+            return g_fonts_[i];
+    }
+    
+    return NULL;
+}
+
+bool PictoLabel::covers(const char* font, const char* text) {
+    
+    CCBMFontConfiguration* config = FNTConfigLoadFile(font);
+    if (!config)
+        return false;
+    
+    std::set<unsigned int>* glyphs = config->getCharacterSet();
+    const char* end = text + strlen(text);
+    while (text < end) {
+        if (!glyphs->count(utf8::next(text, end)))
+            return false;
+    }
+    
+    return true;
+}
+
+void PictoLabel::setLabel(const char* text) {
+    
+    text_ = text;
+    waiting_ = false;
+    
+    font_ = font(text);
+    if (font_ && !strcmp(font_, PICTO_SDF_LABEL_FONT)) {
+        setChild(PictoSDFLabel::create(text, font_size_));
+    }
+    else if (font_) {
+        CCNode* label = CCLabelBMFont::create(text, font_);
+        label->setScale(font_size_*CC_CONTENT_SCALE_FACTOR() / PICTO_LABEL_FONT_SIZE);
+        setChild(label);
+    }
+    else if (async_ && !text_.empty()) {
+        // Rough size of the text until it arrives
+        CCNode* placeholder = CCSprite::create();
+        placeholder->setContentSize(CCSizeMake(0.6*font_size_*utf8::distance(text, text + strlen(text)), 1.2*font_size_));
+        setChild(placeholder);
+        
+        waiting_ = true;
+        PictoDecoder::sharedDecoder()->rasterize(text, PICTO_LABEL_FALLBACK_FONT, font_size_,
+                                                 this, callfuncO_selector(PictoLabel::rasterized));
+    }
+    else {
+        setChild(rasterize(text));
+    }
+}
+
+void PictoLabel::setChild(CCNode* label) {
+    
+    if (label_) {
+        removeChild(label_, true);
+    }
+    label_ = label;
+    
+    dynamic_cast<CCRGBAProtocol*>(label_)->setColor(getColor());
+    dynamic_cast<CCRGBAProtocol*>(label_)->setOpacity(getOpacity());
+    
+    label_->setAnchorPoint(ccp(0, 0));
+    label_->setPosition(ccp(0, 0));
+    addChild(label_);
+    
+    setContentSize(CCSizeMake(label_->getContentSize().width*label_->getScale(),
+                              label_->getContentSize().height*label_->getScale()));
+    
+    if (max_width_ > 0)
+        setMaxWidth(max_width_);
+}
+
+CCNode* PictoLabel::rasterize(const char* text) {
+    
+    struct cc_timeval start, end;
+    CCTime::gettimeofdayCocos2d(&start, NULL);
+    
+    CCNode* label = CCLabelTTF::create(text, PICTO_LABEL_FALLBACK_FONT, font_size_);
+    
+    CCTime::gettimeofdayCocos2d(&end, NULL);
+    g_rasterize_ms_ += CCTime::timersubCocos2d(&start, &end);
+    g_rasterized_++;
+    
+    return label;
+}
+
+void PictoLabel::rasterized(CCObject* texture) {
+    
+    // Replaced by a later setString
+    if (!waiting_)
+        return;
+    waiting_ = false;
+    
+    if (texture) {
+        setChild(CCSprite::createWithTexture(static_cast<CCTexture2D*>(texture)));
+    } else {
+        setChild(rasterize(text_.c_str()));
+    }
+}
@@ -0,0 +1,106 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoLabel.h
+ * @brief Labels drawn from a shared glyph atlas
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_LABEL_H__
+#define __PICTO_LABEL_H__
+
+#include "cocos2d.h"
+
+#include <string>
+
+/**
+ * Label drawn as quads over a glyph atlas built by tools/build_font.py, so
+ * all labels share one texture and creating or recoloring one costs no
+ * rasterization. The distance field atlas is preferred, being sharp at any
+ * size, then the coverage one. Text with glyphs no atlas has, or a build
+ * without atlases, falls back to a CCLabelTTF, or for labels created with
+ * createAsync to text rasterized by PictoDecoder off the main thread.
+ */
+class PictoLabel : public cocos2d::CCNodeRGBA, public cocos2d::CCLabelProtocol {
+    
+public: // constructors and creators
+    
+    PictoLabel();
+    virtual ~PictoLabel();
+    
+    static PictoLabel* create(const char* text, float font_size);
+    
+    // Reserves the space of the text until it's rasterized and uploaded,
+    // when no atlas can draw it
+    static PictoLabel* createAsync(const char* text, float font_size);
+    
+    bool init(const char* text, float font_size, bool async);
+    
+public: // public methods
+    
+    virtual void setString(const char* text);
+    virtual const char* getString();
+    
+    virtual void setColor(const cocos2d::ccColor3B& color);
+    virtual void setOpacity(GLubyte opacity);
+    
+    // Text wider than width is scaled down to it, also once an asynchronous
+    // text arrives
+    void setMaxWidth(float width);
+    
+    // Whether an atlas draws text, so its label rasterizes nothing
+    static bool covered(const char* text);
+    
+    // Time spent rasterizing labels on the main thread since the last call
+    // and how many labels
+    static float rasterizeTime(int* labels);
+    
+private: // private methods
+    
+    void setLabel(const char* text);
+    void setChild(cocos2d::CCNode* label);
+    cocos2d::CCNode* rasterize(const char* text);
+    void rasterized(cocos2d::CCObject* texture);
+    
+    // First bundled atlas with every glyph of text, NULL if none
+    static const char* font(const char* text);
+    static bool covers(const char* font, const char* text);
+    
+private: // private variables
+    
+    // PictoSDFLabel, CCLabelBMFont or CCLabelTTF
+    cocos2d::CCNode* label_;
+    
+    // Atlas of label_, NULL for a CCLabelTTF
+    const char* font_;
+    float font_size_;
+    float max_width_;
+    std::string text_;
+    
+    bool async_;
+    bool waiting_;
+};
+
+#endif // __PICTO_LABEL_H__
@@ -0,0 +1,274 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoNameIndex.cpp
+ * @brief Exact and typo tolerant search over pictogram names
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoNameIndex.h"
+
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
+
+#include "PictoUpperCase.h"
+
+namespace {
+    
+    struct MatchOrder {
+        const std::vector<size_t>* lengths;
+        
+        bool operator()(const PictoNameIndex::Match& a, const PictoNameIndex::Match& b) const {
+            if (a.distance != b.distance)
+                return a.distance < b.distance;
+            if (a.prefix != b.prefix)
+                return !a.prefix;
+            if ((*lengths)[a.entry] != (*lengths)[b.entry])
+                return (*lengths)[a.entry] < (*lengths)[b.entry];
+            return a.entry < b.entry;
+        }
+    };
+    
+    // Myers' algorithm for patterns of up to 32 bytes, as formulated by Hyyrö
+    // for the distance between whole strings
+    unsigned int myers(const std::string& pattern, const std::string& text) {
+        
+        uint32_t peq[256];
+        memset(peq, 0, sizeof(peq));
+        for (size_t i=0; i < pattern.size(); i++)
+            peq[(unsigned char)pattern[i]] |= (1u << i);
+        
+        uint32_t last = 1u << (pattern.size() - 1);
+        uint32_t vp = 0xFFFFFFFFu;
+        uint32_t vn = 0;
+        unsigned int score = pattern.size();
+        
+        for (size_t j=0; j < text.size(); j++) {
+            uint32_t eq = peq[(unsigned char)text[j]];
+            uint32_t x = eq | vn;
+            uint32_t d0 = (((x & vp) + vp) ^ vp) | x;
+            uint32_t hn = vp & d0;
+            uint32_t hp = vn | ~(vp | d0);
+            
+            if (hp & last)
+                score++;
+            else if (hn & last)
+                score--;
+            
+            x = (hp << 1) | 1u;
+            vn = x & d0;
+            vp = (hn << 1) | ~(x | d0);
+        }
+        
+        return score;
+    }
+    
+    // Plain dynamic programming for the rare patterns longer than a word
+    unsigned int wagnerFischer(const std::string& a, const std::string& b) {
+        
+        std::vector<unsigned int> row(b.size() + 1);
+        for (size_t j=0; j <= b.size(); j++)
+            row[j] = j;
+        
+        for (size_t i=1; i <= a.size(); i++) {
+            unsigned int diagonal = row[0];
+            row[0] = i;
+            for (size_t j=1; j <= b.size(); j++) {
+                unsigned int above = row[j];
+                unsigned int cost = (a[i - 1] == b[j - 1])? 0 : 1;
+                row[j] = std::min(std::min(row[j] + 1, row[j - 1] + 1), diagonal + cost);
+                diagonal = above;
+            }
+        }
+        
+        return row[b.size()];
+    }
+}
+
+PictoNameIndex::PictoNameIndex() {}
+
+std::string PictoNameIndex::fold(const std::string& utf8) {
+    
+    const unsigned short* table = picto::conversions::g_fold_;
+    
+    std::string out;
+    out.reserve(utf8.size());
+    
+    for (size_t i=0; i < utf8.size(); i++) {
+        unsigned char c = utf8[i];
+        
+        if (c < 0x80) {
+            out += (char)table[c];
+            continue;
+        }
+        
+        // Past ASCII, only the two byte sequences with lead bytes C2 to C5
+        // encode code points of the table, the rest is copied
+        if (c >= 0xC2 && c <= 0xC5 && i + 1 < utf8.size() && ((unsigned char)utf8[i + 1] & 0xC0) == 0x80) {
+            unsigned int folded = table[(c & 0x1F) << 6 | ((unsigned char)utf8[++i] & 0x3F)];
+            if (folded == 0xDF) { // ß
+                out += "SS";
+            } else if (folded < 0x80) {
+                out += (char)folded;
+            } else {
+                out += (char)(0xC0 | folded >> 6);
+                out += (char)(0x80 | (folded & 0x3F));
+            }
+            continue;
+        }
+        
+        out += (char)c;
+    }
+    
+    return out;
+}
+
+unsigned int PictoNameIndex::distance(const std::string& a, const std::string& b, unsigned int max) {
+    
+    size_t difference = (a.size() > b.size())? a.size() - b.size() : b.size() - a.size();
+    if (difference > max)
+        return max + 1;
+    
+    if (a.empty())
+        return b.size();
+    
+    unsigned int result = (a.size() <= 32)? myers(a, b) : wagnerFischer(a, b);
+    return std::min(result, max + 1);
+}
+
+void PictoNameIndex::addWord(size_t entry, const std::string& text) {
+    
+    if (text.empty())
+        return;
+    
+    if (buckets_.size() <= text.size())
+        buckets_.resize(text.size() + 1);
+    
+    Word word;
+    word.entry = entry;
+    word.text = text;
+    buckets_[text.size()].push_back(word);
+}
+
+void PictoNameIndex::add(const std::string& identifier, const std::string& name) {
+    
+    size_t entry = identifiers_.size();
+    identifiers_.push_back(identifier);
+    
+    std::string folded = fold(name);
+    lengths_.push_back(folded.size());
+    
+    // Every word, plus the whole name when it has more than one
+    size_t begin = 0;
+    size_t words = 0;
+    while (begin < folded.size()) {
+        size_t end = folded.find(' ', begin);
+        if (end == std::string::npos)
+            end = folded.size();
+        if (end > begin) {
+            addWord(entry, folded.substr(begin, end - begin));
+            words++;
+        }
+        begin = end + 1;
+    }
+    
+    if (words > 1) {
+        size_t first = folded.find_first_not_of(' ');
+        size_t last = folded.find_last_not_of(' ');
+        addWord(entry, folded.substr(first, last - first + 1));
+    }
+}
+
+std::vector<PictoNameIndex::Match> PictoNameIndex::search(const std::string& query,
+                                                          unsigned int max_edits,
+                                                          size_t max_results) const {
+    
+    std::vector<Match> matches;
+    
+    std::string folded = fold(query);
+    size_t first = folded.find_first_not_of(' ');
+    if (first == std::string::npos)
+        return matches;
+    folded = folded.substr(first, folded.find_last_not_of(' ') - first + 1);
+    
+    // Best match found so far for every entry
+    std::vector<unsigned int> best(identifiers_.size(), max_edits + 1);
+    std::vector<bool> prefix(identifiers_.size(), false);
+    
+    size_t length = folded.size();
+    
+    // Words as long as the query or longer may start with it
+    for (size_t l=length; l < buckets_.size(); l++) {
+        const std::vector<Word>& bucket = buckets_[l];
+        for (size_t i=0; i < bucket.size(); i++) {
+            const Word& word = bucket[i];
+            if (best[word.entry] == 0 || word.text.compare(0, length, folded) != 0)
+                continue;
+            
+            // Buckets are visited shortest first, so exact words win over prefixes
+            best[word.entry] = 0;
+            prefix[word.entry] = (l != length);
+        }
+    }
+    
+    // A word can only be within max_edits if its length is
+    size_t min_length = (length > max_edits)? length - max_edits : 1;
+    size_t max_length = std::min(length + max_edits, buckets_.size() - 1);
+    for (size_t l=min_length; max_edits > 0 && l <= max_length && l < buckets_.size(); l++) {
+        const std::vector<Word>& bucket = buckets_[l];
+        for (size_t i=0; i < bucket.size(); i++) {
+            const Word& word = bucket[i];
+            if (best[word.entry] == 0)
+                continue;
+            unsigned int d = distance(folded, word.text, best[word.entry] - 1);
+            if (d < best[word.entry]) {
+                best[word.entry] = d;
+                prefix[word.entry] = false;
+            }
+        }
+    }
+    
+    for (size_t entry=0; entry < best.size(); entry++) {
+        if (best[entry] <= max_edits) {
+            Match match;
+            match.entry = entry;
+            match.distance = best[entry];
+            match.prefix = prefix[entry];
+            matches.push_back(match);
+        }
+    }
+    
+    MatchOrder order;
+    order.lengths = &lengths_;
+    if (max_results < matches.size()) {
+        std::partial_sort(matches.begin(), matches.begin() + max_results, matches.end(), order);
+        matches.resize(max_results);
+    } else {
+        std::sort(matches.begin(), matches.end(), order);
+    }
+    
+    return matches;
+}
@@ -0,0 +1,93 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoNameIndex.h
+ * @brief Exact and typo tolerant search over pictogram names
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_NAME_INDEX_H__
+#define __PICTO_NAME_INDEX_H__
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/**
+ * Words of every pictogram name, folded to unaccented uppercase and bucketed
+ * by length. A query matches a name when it's a prefix of one of its words or
+ * when it's within the allowed number of edits of a word or of the whole
+ * name. Edit distances use Myers' bit-parallel algorithm.
+ */
+class PictoNameIndex {
+    
+public: // public types
+    
+    struct Match {
+        size_t entry;
+        unsigned int distance;
+        bool prefix;
+    };
+    
+public: // constructors
+    
+    PictoNameIndex();
+    
+public: // public methods
+    
+    void add(const std::string& identifier, const std::string& name);
+    
+    size_t size() const { return identifiers_.size(); }
+    const std::string& identifier(size_t entry) const { return identifiers_[entry]; }
+    
+    // Best matches first: exact words, then prefixes, then by edit distance
+    std::vector<Match> search(const std::string& query, unsigned int max_edits, size_t max_results) const;
+    
+    // Uppercases and strips diacritics through conversions::g_fold_, with
+    // anything but letters and digits turned into spaces
+    static std::string fold(const std::string& utf8);
+    
+    // Levenshtein distance, or max + 1 when it's greater than max
+    static unsigned int distance(const std::string& a, const std::string& b, unsigned int max);
+    
+private: // private types
+    
+    struct Word {
+        size_t entry;
+        std::string text;
+    };
+    
+private: // private methods
+    
+    void addWord(size_t entry, const std::string& text);
+    
+private: // private variables
+    
+    std::vector<std::string> identifiers_;
+    std::vector<size_t> lengths_;
+    std::vector< std::vector<Word> > buckets_;
+};
+
+#endif // __PICTO_NAME_INDEX_H__
@@ -0,0 +1,169 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoPrefetcher.cpp
+ * @brief Background loading of the textures likely needed next
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoPrefetcher.h"
+
+#include "PictoDecoder.h"
+#include "PictoTextureCache.h"
+
+#include <algorithm>
+
+USING_NS_CC;
+
+// Bytes of textures that may be pending or being loaded at once
+#define PICTO_PREFETCH_BUDGET (8*1024*1024)
+
+// Images handed to the decoder at the same time, enough to keep its threads
+// busy while leaving room for more urgent loads
+#define PICTO_PREFETCH_IN_FLIGHT (2*PICTO_DECODER_THREADS)
+
+static PictoPrefetcher* g_shared_prefetcher_ = NULL;
+
+/**
+ * Target of the decoder callback for a single image, which tells the
+ * prefetcher the path that finished loading and the bytes it took.
+ */
+class PictoPrefetchLoad : public CCObject {
+    
+public: // constructors and creators
+    
+    static PictoPrefetchLoad* create(PictoPrefetcher* prefetcher, const std::string& path, size_t bytes) {
+        
+        PictoPrefetchLoad* load = new PictoPrefetchLoad();
+        load->prefetcher_ = prefetcher;
+        load->path_ = path;
+        load->bytes_ = bytes;
+        load->autorelease();
+        return load;
+    }
+    
+public: // public methods
+    
+    void loaded(CCObject* texture) {
+        prefetcher_->loaded(path_, bytes_);
+    }
+    
+private: // private variables
+    
+    PictoPrefetcher* prefetcher_;
+    std::string path_;
+    size_t bytes_;
+};
+
+PictoPrefetcher* PictoPrefetcher::sharedPrefetcher() {
+    
+    if (!g_shared_prefetcher_) {
+        g_shared_prefetcher_ = new PictoPrefetcher();
+    }
+    return g_shared_prefetcher_;
+}
+
+PictoPrefetcher::PictoPrefetcher() :
+
+queued_bytes_(0),
+in_flight_(0) {
+    
+}
+
+PictoPrefetcher::~PictoPrefetcher() {
+    
+}
+
+bool PictoPrefetcher::prefetch(const std::string& image, float priority, size_t bytes) {
+    
+    std::string path = CCFileUtils::sharedFileUtils()->fullPathForFilename(image.c_str());
+    if (queued_.count(path) || CCTextureCache::sharedTextureCache()->textureForKey(path.c_str()))
+        return true;
+    
+    // Prefetched textures must not push the ones in use out of the cache
+    size_t budget = MIN(PICTO_PREFETCH_BUDGET, PictoTextureCache::budget());
+    if (queued_bytes_ + bytes > budget)
+        return false;
+    
+    Request request = { path, priority, bytes };
+    pending_.insert(std::upper_bound(pending_.begin(), pending_.end(), request), request);
+    queued_.insert(path);
+    queued_bytes_ += bytes;
+    
+    next();
+    return true;
+}
+
+void PictoPrefetcher::cancel() {
+    
+    CCLOG("PictoPrefetcher: %u requests cancelled", (unsigned int)pending_.size());
+    
+    // Images being loaded stay queued until they arrive
+    for (size_t i=0; i < pending_.size(); i++) {
+        queued_.erase(pending_[i].path);
+        queued_bytes_ -= pending_[i].bytes;
+    }
+    
+    pending_.clear();
+}
+
+void PictoPrefetcher::visit(const char* category) {
+    
+    visits_[category]++;
+}
+
+unsigned int PictoPrefetcher::visits(const char* category) {
+    
+    std::map<std::string, unsigned int>::iterator it = visits_.find(category);
+    return it == visits_.end()? 0 : it->second;
+}
+
+void PictoPrefetcher::next() {
+    
+    while (in_flight_ < PICTO_PREFETCH_IN_FLIGHT && !pending_.empty()) {
+        Request request = pending_.front();
+        pending_.erase(pending_.begin());
+        
+        // Loaded meanwhile by a scene that couldn't wait
+        if (CCTextureCache::sharedTextureCache()->textureForKey(request.path.c_str())) {
+            queued_.erase(request.path);
+            queued_bytes_ -= request.bytes;
+            continue;
+        }
+        
+        in_flight_++;
+        PictoPrefetchLoad* load = PictoPrefetchLoad::create(this, request.path, request.bytes);
+        PictoDecoder::sharedDecoder()->load(request.path.c_str(), load, callfuncO_selector(PictoPrefetchLoad::loaded));
+    }
+}
+
+void PictoPrefetcher::loaded(const std::string& path, size_t bytes) {
+    
+    // The texture cache answers for it from now on, and may evict it later
+    queued_.erase(path);
+    queued_bytes_ -= bytes;
+    in_flight_--;
+    next();
+}
@@ -0,0 +1,103 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoPrefetcher.h
+ * @brief Background loading of the textures likely needed next
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_PREFETCHER_H__
+#define __PICTO_PREFETCHER_H__
+
+#include "cocos2d.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * Loads images into the texture cache in the background with PictoDecoder,
+ * so the next scene finds them decoded and uploaded. Requests are served
+ * highest priority first, a few at a time, and only while the bytes of the
+ * requests pending or being loaded fit the prefetch budget; loaded textures
+ * are left to PictoTextureCache. Cancelling drops the pending requests; the
+ * ones already being decoded end up in the cache like any other unused
+ * texture.
+ */
+class PictoPrefetcher : public cocos2d::CCObject {
+    
+    friend class PictoPrefetchLoad;
+    
+public: // constructors and creators
+    
+    static PictoPrefetcher* sharedPrefetcher();
+    
+    PictoPrefetcher();
+    ~PictoPrefetcher();
+    
+public: // public methods
+    
+    // Queues an image, bytes being the size of its texture. False while the
+    // budget is used up
+    bool prefetch(const std::string& image, float priority, size_t bytes);
+    
+    // Drops every pending request
+    void cancel();
+    
+    // Usage signal for priorities, the times a category has been shown
+    void visit(const char* category);
+    unsigned int visits(const char* category);
+    
+private: // private methods
+    
+    void next();
+    void loaded(const std::string& path, size_t bytes);
+    
+private: // private variables
+    
+    struct Request {
+        std::string path;
+        float priority;
+        size_t bytes;
+        
+        bool operator<(const Request& other) const {
+            return priority > other.priority;
+        }
+    };
+    
+    std::vector<Request> pending_;
+    
+    // Paths pending or being loaded, so they aren't queued twice
+    std::set<std::string> queued_;
+    
+    // Bytes of the requests in queued_
+    size_t queued_bytes_;
+    int in_flight_;
+    
+    std::map<std::string, unsigned int> visits_;
+};
+
+#endif // __PICTO_PREFETCHER_H__
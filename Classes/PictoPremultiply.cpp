@@ -0,0 +1,96 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoPremultiply.cpp
+ * @brief Alpha premultiplication of decoded pixels
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoPremultiply.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace picto
+{
+    namespace conversions
+    {
+#if defined(__SSE2__)
+        
+        // Two pixels as 16 bit lanes, alpha kept by scaling it by 256
+        static inline __m128i premultiply_sse2(__m128i pixels, __m128i alpha_lanes, __m128i alpha_scale, __m128i one) {
+            
+            __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            alpha = _mm_add_epi16(alpha, one);
+            alpha = _mm_or_si128(_mm_andnot_si128(alpha_lanes, alpha), alpha_scale);
+            return _mm_srli_epi16(_mm_mullo_epi16(pixels, alpha), 8);
+        }
+        
+#endif
+        
+        void premultiply(unsigned char* pixels, size_t count) {
+            
+            size_t i = 0;
+            
+#if defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i one = _mm_set1_epi16(1);
+            const __m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+            const __m128i alpha_scale = _mm_set_epi16(256, 0, 0, 0, 256, 0, 0, 0);
+            
+            for (; i + 4 <= count; i += 4) {
+                __m128i rgba = _mm_loadu_si128((const __m128i*)(pixels + 4*i));
+                __m128i low = premultiply_sse2(_mm_unpacklo_epi8(rgba, zero), alpha_lanes, alpha_scale, one);
+                __m128i high = premultiply_sse2(_mm_unpackhi_epi8(rgba, zero), alpha_lanes, alpha_scale, one);
+                _mm_storeu_si128((__m128i*)(pixels + 4*i), _mm_packus_epi16(low, high));
+            }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+            for (; i + 8 <= count; i += 8) {
+                uint8x8x4_t rgba = vld4_u8(pixels + 4*i);
+                for (int c=0; c < 3; c++) {
+                    rgba.val[c] = vshrn_n_u16(vaddw_u8(vmull_u8(rgba.val[c], rgba.val[3]), rgba.val[c]), 8);
+                }
+                vst4_u8(pixels + 4*i, rgba);
+            }
+#endif
+            
+            premultiplyScalar(pixels + 4*i, count - i);
+        }
+        
+        void premultiplyScalar(unsigned char* pixels, size_t count) {
+            
+            for (size_t i=0; i < count; i++) {
+                unsigned char* pixel = pixels + 4*i;
+                unsigned int alpha = pixel[3] + 1;
+                pixel[0] = (pixel[0]*alpha) >> 8;
+                pixel[1] = (pixel[1]*alpha) >> 8;
+                pixel[2] = (pixel[2]*alpha) >> 8;
+            }
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoPremultiply.h
+ * @brief Alpha premultiplication of decoded pixels
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_PREMULTIPLY_H__
+#define __PICTO_PREMULTIPLY_H__
+
+#include <stddef.h>
+
+namespace picto
+{
+    namespace conversions
+    {
+        // Multiplies the color of count RGBA8888 pixels by their alpha, in
+        // place, with the rounding of CC_RGB_PREMULTIPLY_ALPHA. Uses SSE2 or
+        // NEON when available.
+        void premultiply(unsigned char* pixels, size_t count);
+        
+        // Same result without vector instructions
+        void premultiplyScalar(unsigned char* pixels, size_t count);
+    }
+}
+
+#endif // __PICTO_PREMULTIPLY_H__
@@ -0,0 +1,325 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoRawTexture.cpp
+ * @brief Loading of the raw texture blobs made by tools/convert_textures.py
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoRawTexture.h"
+
+#include "PictoDecoder.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <map>
+
+USING_NS_CC;
+
+// Header and formats, must match tools/convert_textures.py
+#define PICTO_RAW_TEXTURE_MAGIC "PTEX"
+#define PICTO_RAW_TEXTURE_VERSION 1
+#define PICTO_RAW_TEXTURE_HEADER_SIZE 16
+
+#define PICTO_RAW_TEXTURE_RGBA8888 0
+#define PICTO_RAW_TEXTURE_RGBA4444 1
+#define PICTO_RAW_TEXTURE_RGB565 2
+
+#define PICTO_RAW_TEXTURE_LZ4 1
+
+// Whether each image has a blob, so the file system is asked once
+static std::map<std::string, bool> g_exists_;
+
+// CCTexture2D::initWithData takes any pixels as not premultiplied
+class PremultipliedTexture : public CCTexture2D {
+    
+public:
+    
+    bool initWithPremultipliedData(const void* data, CCTexture2DPixelFormat format, unsigned int width, unsigned int height) {
+        if (!initWithData(data, format, width, height, CCSizeMake(width, height)))
+            return false;
+        m_bHasPremultipliedAlpha = (format != kCCTexture2DPixelFormat_RGB565);
+        return true;
+    }
+};
+
+// CCTextureCache can't take a texture created elsewhere. addUIImage is the
+// only public way in under a given key, and it takes a CCImage, whose pixels
+// are 8 bits per channel and not premultiplied: RGB565 and RGBA4444 blobs
+// would be expanded, premultiplied again and converted back on upload
+class TextureCacheAccess : public CCTextureCache {
+    
+public:
+    
+    static CCDictionary* textures(CCTextureCache* cache) {
+        return cache->*(&TextureCacheAccess::m_pTextures);
+    }
+};
+
+static unsigned int read_u16(const unsigned char* data) {
+    
+    return data[0] | (data[1] << 8);
+}
+
+static unsigned int read_u32(const unsigned char* data) {
+    
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+}
+
+static bool lz4_length(const unsigned char*& in, const unsigned char* end, size_t& length) {
+    
+    unsigned char byte;
+    do {
+        if (in >= end)
+            return false;
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// Decompresses an LZ4 block, which must fill out exactly
+static bool lz4_decompress(const unsigned char* in, size_t in_size, unsigned char* out, size_t out_size) {
+    
+    const unsigned char* in_end = in + in_size;
+    unsigned char* op = out;
+    unsigned char* out_end = out + out_size;
+    
+    while (in < in_end) {
+        unsigned int token = *in++;
+        
+        size_t literals = token >> 4;
+        if (literals == 15 && !lz4_length(in, in_end, literals))
+            return false;
+        if (literals > (size_t)(in_end - in) || literals > (size_t)(out_end - op))
+            return false;
+        memcpy(op, in, literals);
+        op += literals;
+        in += literals;
+        
+        // The last sequence has no match
+        if (in == in_end)
+            break;
+        
+        if (in_end - in < 2)
+            return false;
+        size_t offset = read_u16(in);
+        in += 2;
+        if (offset == 0 || offset > (size_t)(op - out))
+            return false;
+        
+        size_t match = token & 15;
+        if (match == 15 && !lz4_length(in, in_end, match))
+            return false;
+        match += 4;
+        if (match > (size_t)(out_end - op))
+            return false;
+        
+        // Matches may overlap what they copy
+        const unsigned char* from = op - offset;
+        for (size_t i=0; i < match; i++) {
+            op[i] = from[i];
+        }
+        op += match;
+    }
+    
+    return op == out_end;
+}
+
+CCTexture2D* PictoRawTexture::load(const char* image) {
+    
+    std::string key = CCFileUtils::sharedFileUtils()->fullPathForFilename(image);
+    
+    CCTexture2D* texture = CCTextureCache::sharedTextureCache()->textureForKey(key.c_str());
+    if (texture)
+        return texture;
+    
+    if (exists(key.c_str())) {
+        Pixels pixels;
+        if (read(key, pixels))
+            texture = upload(pixels, key);
+        
+        if (texture)
+            return texture;
+        CCLOGERROR("Can't load %s", blobPath(key).c_str());
+    }
+    
+    return CCTextureCache::sharedTextureCache()->addImage(key.c_str());
+}
+
+bool PictoRawTexture::read(const std::string& key, Pixels& pixels) {
+    
+    std::string path = blobPath(key);
+    bool unpacked = false;
+    
+    pixels.data = NULL;
+    pixels.mapping = NULL;
+    pixels.mapping_size = 0;
+    pixels.buffer = NULL;
+    
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0) {
+        void* blob = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (blob != MAP_FAILED) {
+            pixels.mapping = blob;
+            pixels.mapping_size = info.st_size;
+            
+            // Page the blob in here rather than on the GL thread
+            madvise(blob, info.st_size, MADV_WILLNEED);
+            unpacked = unpack((const unsigned char*)blob, info.st_size, pixels);
+        }
+    } else {
+        // Not a plain file, e.g. inside the APK
+        unsigned long size = 0;
+        unsigned char* blob = PictoDecoder::readFile(path, &size);
+        if (blob) {
+            pixels.buffer = blob;
+            unpacked = unpack(blob, size, pixels);
+        }
+    }
+    if (fd >= 0)
+        close(fd);
+    
+    if (!unpacked)
+        release(pixels);
+    return unpacked;
+}
+
+CCTexture2D* PictoRawTexture::upload(Pixels& pixels, const std::string& key) {
+    
+    PremultipliedTexture* texture = new PremultipliedTexture();
+    bool uploaded = texture->initWithPremultipliedData(pixels.data, pixels.format, pixels.width, pixels.height);
+    release(pixels);
+    
+    if (!uploaded) {
+        texture->release();
+        return NULL;
+    }
+    
+    TextureCacheAccess::textures(CCTextureCache::sharedTextureCache())->setObject(texture, key);
+    texture->release();
+    
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // After losing the GL context the texture comes back from the image
+    VolatileTexture::addImageTexture(texture, key.c_str(), CCImage::kFmtPng);
+#endif
+    
+    return texture;
+}
+
+void PictoRawTexture::release(Pixels& pixels) {
+    
+    if (pixels.mapping)
+        munmap(pixels.mapping, pixels.mapping_size);
+    CC_SAFE_DELETE_ARRAY(pixels.buffer);
+    
+    pixels.data = NULL;
+    pixels.mapping = NULL;
+    pixels.mapping_size = 0;
+}
+
+bool PictoRawTexture::exists(const char* image) {
+    
+    std::string key = CCFileUtils::sharedFileUtils()->fullPathForFilename(image);
+    std::map<std::string, bool>::iterator it = g_exists_.find(key);
+    if (it == g_exists_.end()) {
+        it = g_exists_.insert(std::make_pair(key, CCFileUtils::sharedFileUtils()->isFileExist(blobPath(key)))).first;
+    }
+    return it->second;
+}
+
+void PictoRawTexture::purge() {
+    
+    g_exists_.clear();
+}
+
+std::string PictoRawTexture::blobPath(const std::string& image) {
+    
+    std::string path(image);
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of('/');
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+        path.erase(dot);
+    return path + ".ptex";
+}
+
+bool PictoRawTexture::unpack(const unsigned char* blob, size_t size, Pixels& pixels) {
+    
+    if (size < PICTO_RAW_TEXTURE_HEADER_SIZE || memcmp(blob, PICTO_RAW_TEXTURE_MAGIC, 4) != 0 || blob[4] != PICTO_RAW_TEXTURE_VERSION)
+        return false;
+    
+    unsigned int bytes_per_pixel;
+    switch (blob[5]) {
+        case PICTO_RAW_TEXTURE_RGBA8888:
+            pixels.format = kCCTexture2DPixelFormat_RGBA8888;
+            bytes_per_pixel = 4;
+            break;
+        case PICTO_RAW_TEXTURE_RGBA4444:
+            pixels.format = kCCTexture2DPixelFormat_RGBA4444;
+            bytes_per_pixel = 2;
+            break;
+        case PICTO_RAW_TEXTURE_RGB565:
+            pixels.format = kCCTexture2DPixelFormat_RGB565;
+            bytes_per_pixel = 2;
+            break;
+        default:
+            return false;
+    }
+    
+    pixels.width = read_u16(blob + 8);
+    pixels.height = read_u16(blob + 10);
+    size_t pixels_size = read_u32(blob + 12);
+    if (pixels_size != (size_t)pixels.width*pixels.height*bytes_per_pixel)
+        return false;
+    
+    const unsigned char* stored = blob + PICTO_RAW_TEXTURE_HEADER_SIZE;
+    size_t stored_size = size - PICTO_RAW_TEXTURE_HEADER_SIZE;
+    
+    if (blob[6] & PICTO_RAW_TEXTURE_LZ4) {
+        unsigned char* decompressed = new unsigned char[pixels_size];
+        if (!lz4_decompress(stored, stored_size, decompressed, pixels_size)) {
+            delete[] decompressed;
+            return false;
+        }
+        
+        // The blob isn't needed anymore
+        release(pixels);
+        pixels.buffer = decompressed;
+        pixels.data = decompressed;
+    } else if (stored_size >= pixels_size) {
+        
+        // Uploaded from the blob, which is kept until then
+        pixels.data = stored;
+    } else {
+        return false;
+    }
+    
+    return true;
+}
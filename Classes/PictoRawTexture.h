@@ -0,0 +1,90 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoRawTexture.h
+ * @brief Loading of the raw texture blobs made by tools/convert_textures.py
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_RAW_TEXTURE_H__
+#define __PICTO_RAW_TEXTURE_H__
+
+#include "cocos2d.h"
+
+#include <string>
+
+/**
+ * Uploads the premultiplied pixels stored by tools/convert_textures.py in a
+ * .ptex file next to an image, so the image is never decoded. Blobs are
+ * mapped into memory when they are plain files and read otherwise, like
+ * assets inside an APK, and pixels stored as they are get uploaded straight
+ * from there. The texture is cached under the key of the image,
+ * so any later CCSprite::create of the image finds it. Reading and
+ * uploading are split, so PictoDecoder reads blobs on its workers.
+ */
+class PictoRawTexture {
+    
+public: // public types
+    
+    struct Pixels {
+        cocos2d::CCTexture2DPixelFormat format;
+        unsigned int width;
+        unsigned int height;
+        const unsigned char* data;
+        
+        // Memory data points into, a mapped blob or one to delete[]
+        void* mapping;
+        size_t mapping_size;
+        unsigned char* buffer;
+    };
+    
+public: // public methods
+    
+    // Texture of the image, from the cache, its raw blob or the image itself
+    static cocos2d::CCTexture2D* load(const char* image);
+    
+    // Reads and decompresses the blob of the image at the full path key.
+    // Safe from any thread
+    static bool read(const std::string& key, Pixels& pixels);
+    
+    // Texture of pixels from read, cached under key. Frees the pixels
+    static cocos2d::CCTexture2D* upload(Pixels& pixels, const std::string& key);
+    
+    // Frees pixels from read that won't be uploaded
+    static void release(Pixels& pixels);
+    
+    // Whether the image has a raw blob
+    static bool exists(const char* image);
+    
+    // Forgets which blobs exist
+    static void purge();
+    
+private: // private methods
+    
+    static std::string blobPath(const std::string& image);
+    static bool unpack(const unsigned char* blob, size_t size, Pixels& pixels);
+};
+
+#endif // __PICTO_RAW_TEXTURE_H__
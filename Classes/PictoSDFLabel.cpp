@@ -0,0 +1,156 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoSDFLabel.cpp
+ * @brief Labels drawn from a signed distance field atlas
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoSDFLabel.h"
+
+#include <math.h>
+
+USING_NS_CC;
+
+// Size the glyphs are rendered at and distance covered by the field, in
+// atlas pixels. Must match tools/build_font.py
+#define PICTO_SDF_LABEL_FONT_SIZE 32
+#define PICTO_SDF_LABEL_SPREAD 4
+
+#define PICTO_SDF_LABEL_SHADER "PictoSDFLabel"
+
+static const char* g_fragment_shader_ =
+"#ifdef GL_ES                                                                   \n"
+"precision mediump float;                                                       \n"
+"#endif                                                                         \n"
+"                                                                               \n"
+"varying vec4 v_fragmentColor;                                                  \n"
+"varying vec2 v_texCoord;                                                       \n"
+"uniform sampler2D CC_Texture0;                                                 \n"
+"uniform float u_smoothing;                                                     \n"
+"                                                                               \n"
+"void main()                                                                    \n"
+"{                                                                              \n"
+"    float distance = texture2D(CC_Texture0, v_texCoord).a;                     \n"
+"    float alpha = smoothstep(0.5 - u_smoothing, 0.5 + u_smoothing, distance);  \n"
+"    gl_FragColor = v_fragmentColor*alpha;                                      \n"
+"}                                                                              \n";
+
+static GLint g_smoothing_location_ = -1;
+
+// Reloads the shader when Android recreates the GL context
+class PictoSDFLabelReloader : public CCObject {
+public:
+    void reload(CCObject* sender) {
+        PictoSDFLabel::reloadProgram();
+    }
+};
+
+// The notification center doesn't retain its observers, so this one lives
+// as long as the program
+static PictoSDFLabelReloader g_reloader_;
+
+PictoSDFLabel* PictoSDFLabel::create(const char* text, float font_size) {
+    
+    PictoSDFLabel* label = new PictoSDFLabel();
+    if (label && label->init(text, font_size)) {
+        label->autorelease();
+        return label;
+    }
+    CC_SAFE_DELETE(label);
+    return NULL;
+}
+
+bool PictoSDFLabel::init(const char* text, float font_size) {
+    
+    // The shader only reads the distance, kept in an alpha only texture
+    CCTexture2DPixelFormat format = CCTexture2D::defaultAlphaPixelFormat();
+    CCTexture2D::setDefaultAlphaPixelFormat(kCCTexture2DPixelFormat_A8);
+    bool loaded = initWithString(text, PICTO_SDF_LABEL_FONT, kCCLabelAutomaticWidth, kCCTextAlignmentLeft, CCPointZero);
+    CCTexture2D::setDefaultAlphaPixelFormat(format);
+    
+    if (!loaded) {
+        return false;
+    }
+    
+    setShaderProgram(program());
+    setScale(font_size*CC_CONTENT_SCALE_FACTOR() / PICTO_SDF_LABEL_FONT_SIZE);
+    
+    return true;
+}
+
+void PictoSDFLabel::draw() {
+    
+    // Screen pixels per atlas pixel, including the scale of the parents
+    CCAffineTransform transform = nodeToWorldTransform();
+    float pixels = sqrtf(transform.a*transform.a + transform.b*transform.b);
+    
+    // Antialias over one screen pixel, half of it each side of the outline
+    float smoothing = 0.5f / (2*PICTO_SDF_LABEL_SPREAD*MAX(pixels, 0.01f));
+    
+    getShaderProgram()->use();
+    getShaderProgram()->setUniformLocationWith1f(g_smoothing_location_, MIN(smoothing, 0.5f));
+    
+    CCLabelBMFont::draw();
+}
+
+CCGLProgram* PictoSDFLabel::program() {
+    
+    CCGLProgram* program = CCShaderCache::sharedShaderCache()->programForKey(PICTO_SDF_LABEL_SHADER);
+    if (!program) {
+        program = new CCGLProgram();
+        loadProgram(program);
+        CCShaderCache::sharedShaderCache()->addProgram(program, PICTO_SDF_LABEL_SHADER);
+        program->release();
+        
+        CCNotificationCenter::sharedNotificationCenter()->addObserver(&g_reloader_,
+                                                                      callfuncO_selector(PictoSDFLabelReloader::reload),
+                                                                      EVENT_COME_TO_FOREGROUND,
+                                                                      NULL);
+    }
+    
+    return program;
+}
+
+void PictoSDFLabel::reloadProgram() {
+    
+    CCGLProgram* program = CCShaderCache::sharedShaderCache()->programForKey(PICTO_SDF_LABEL_SHADER);
+    if (program) {
+        program->reset();
+        loadProgram(program);
+    }
+}
+
+void PictoSDFLabel::loadProgram(CCGLProgram* program) {
+    
+    program->initWithVertexShaderByteArray(ccPositionTextureColor_vert, g_fragment_shader_);
+    program->addAttribute(kCCAttributeNamePosition, kCCVertexAttrib_Position);
+    program->addAttribute(kCCAttributeNameColor, kCCVertexAttrib_Color);
+    program->addAttribute(kCCAttributeNameTexCoord, kCCVertexAttrib_TexCoords);
+    program->link();
+    program->updateUniforms();
+    
+    g_smoothing_location_ = program->getUniformLocationForName("u_smoothing");
+}
@@ -0,0 +1,66 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoSDFLabel.h
+ * @brief Labels drawn from a signed distance field atlas
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_SDF_LABEL_H__
+#define __PICTO_SDF_LABEL_H__
+
+#include "cocos2d.h"
+
+// Distance field atlas written by tools/build_font.py --sdf
+#define PICTO_SDF_LABEL_FONT "fonts/picto_sdf.fnt"
+
+/**
+ * Bitmap font label over a signed distance field atlas, drawn with a shader
+ * that thresholds the distance and antialiases over one screen pixel. One
+ * atlas serves every font size and scale with sharp edges, so labels never
+ * need rasterizing at the size they are shown.
+ */
+class PictoSDFLabel : public cocos2d::CCLabelBMFont {
+    
+public: // constructors and creators
+    
+    static PictoSDFLabel* create(const char* text, float font_size);
+    
+    bool init(const char* text, float font_size);
+    
+public: // public methods
+    
+    virtual void draw();
+    
+    // Rebuilds the shader after Android recreates the GL context
+    static void reloadProgram();
+    
+private: // private methods
+    
+    static cocos2d::CCGLProgram* program();
+    static void loadProgram(cocos2d::CCGLProgram* program);
+};
+
+#endif // __PICTO_SDF_LABEL_H__
@@ -0,0 +1,84 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoSQLiteProfile.cpp
+ * @brief Static memory handed to SQLite for its page cache and heap
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoSQLiteProfile.h"
+
+#include <stdio.h>
+
+namespace picto
+{
+    namespace sqlite_profile
+    {
+        // sqlite3_int64 arrays keep both buffers 8-byte aligned as SQLite requires
+        static sqlite3_int64 g_pagecache_[PICTO_SQLITE_PAGECACHE_SLOTS*PICTO_SQLITE_PAGECACHE_SLOT_SIZE/sizeof(sqlite3_int64)];
+#ifdef SQLITE_ENABLE_MEMSYS5
+        static sqlite3_int64 g_heap_[PICTO_SQLITE_HEAP_SIZE/sizeof(sqlite3_int64)];
+#endif
+        
+        int configure() {
+            
+            int rc = sqlite3_config(SQLITE_CONFIG_PAGECACHE, g_pagecache_,
+                                    PICTO_SQLITE_PAGECACHE_SLOT_SIZE, PICTO_SQLITE_PAGECACHE_SLOTS);
+            if (rc != SQLITE_OK)
+                return rc;
+            
+#ifdef SQLITE_ENABLE_MEMSYS5
+            rc = sqlite3_config(SQLITE_CONFIG_HEAP, g_heap_, (int)sizeof(g_heap_), 64);
+#endif
+            return rc;
+        }
+        
+        int limit(sqlite3* db) {
+            
+            // The temporary database lives in memory too with SQLITE_TEMP_STORE=3
+            char sql[96];
+            sprintf(sql, "PRAGMA main.cache_size=%d; PRAGMA temp.cache_size=%d",
+                    PICTO_SQLITE_PAGECACHE_SLOTS, PICTO_SQLITE_PAGECACHE_SLOTS);
+            return sqlite3_exec(db, sql, NULL, NULL, NULL);
+        }
+        
+        int pageSize(const char* path) {
+            
+            FILE* file = fopen(path, "rb");
+            if (!file)
+                return 0;
+            
+            unsigned char header[18];
+            size_t read = fread(header, 1, sizeof(header), file);
+            fclose(file);
+            if (read != sizeof(header))
+                return 0;
+            
+            // Big endian at offset 16, 1 stands for 65536
+            int size = header[16] << 8 | header[17];
+            return size == 1? 65536 : size;
+        }
+    }
+}
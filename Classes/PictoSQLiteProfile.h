@@ -0,0 +1,73 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoSQLiteProfile.h
+ * @brief Static memory handed to SQLite for its page cache and heap
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_SQLITE_PROFILE_H__
+#define __PICTO_SQLITE_PROFILE_H__
+
+#include "sqlite3.h"
+
+// Page size of the bundled catalog. Slots of the page cache are sized for it
+// at compile time, pages of any other size are taken from the heap arena.
+#ifndef PICTO_SQLITE_PAGE_SIZE
+#define PICTO_SQLITE_PAGE_SIZE 32768
+#endif
+
+// Pages kept in the static page cache, which is also the cache size of every
+// connection so pages never spill into the heap arena
+#ifndef PICTO_SQLITE_PAGECACHE_SLOTS
+#define PICTO_SQLITE_PAGECACHE_SLOTS 20
+#endif
+
+// Extra bytes per slot used by SQLite for the page header
+#define PICTO_SQLITE_PAGECACHE_SLOT_SIZE (PICTO_SQLITE_PAGE_SIZE + 256)
+
+// Arena for everything else SQLite allocates: schema, statements and rows.
+// Only used by builds with SQLITE_ENABLE_MEMSYS5.
+#ifndef PICTO_SQLITE_HEAP_SIZE
+#define PICTO_SQLITE_HEAP_SIZE (2*1024*1024)
+#endif
+
+namespace picto
+{
+    namespace sqlite_profile
+    {
+        // Hands the static page cache and heap arena to SQLite. Must run
+        // before sqlite3_initialize, returns the first error of sqlite3_config
+        int configure();
+        
+        // Bounds the page cache of a connection to the static slots
+        int limit(sqlite3* db);
+        
+        // Page size stored in the header of a database file, 0 if unreadable
+        int pageSize(const char* path);
+    }
+}
+
+#endif // __PICTO_SQLITE_PROFILE_H__
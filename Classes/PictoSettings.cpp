@@ -0,0 +1,425 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoSettings.cpp
+ * @brief In-memory snapshot of the user settings
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoSettings.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+USING_NS_CC;
+
+// Settings file in the writable path
+#define PICTO_SETTINGS_FILE "settings.bin"
+
+// File layout, little endian:
+//   char[4] "PSET", u8 version, u8[3] reserved, u32 number of entries,
+//   entries of u8 type, u8 key length, key, i32 value,
+//   u32 FNV-1a hash of everything before it
+#define PICTO_SETTINGS_VERSION 1
+#define PICTO_SETTINGS_HEADER_SIZE 12
+
+enum {
+    kPictoSettingsInteger = 0,
+    kPictoSettingsBool = 1
+};
+
+static PictoSettings* g_shared_settings_ = NULL;
+
+// Keys earlier versions kept in CCUserDefault. They are moved into the
+// snapshot when the settings are created, so reads from other threads,
+// which can't reach CCUserDefault, find them
+static const struct {
+    const char* key;
+    bool boolean;
+} g_known_keys_[] = {
+    { "backgroundColor", false },
+    { "color_theme", false },
+    { "menuTextColor", false },
+    { "navigationBarBackgroundColor", false },
+    { "navigationBarTextColor", false },
+    { "selected_theme", false },
+    { "speakerButtonBackgroundColor", false },
+    { "speakerButtonTextColor", false },
+    { "use_capitals", true }
+};
+
+static void put32(std::string& out, unsigned int value) {
+    for (int i=0; i < 4; i++) {
+        out += (char)((value >> (8*i)) & 0xff);
+    }
+}
+
+static unsigned int get32(const unsigned char* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((unsigned int)in[3] << 24);
+}
+
+static unsigned int hash(const unsigned char* data, size_t size) {
+    unsigned int hash = 2166136261u;
+    for (size_t i=0; i < size; i++) {
+        hash = (hash ^ data[i])*16777619u;
+    }
+    return hash;
+}
+
+PictoSettings* PictoSettings::sharedSettings() {
+    
+    if (!g_shared_settings_) {
+        g_shared_settings_ = new PictoSettings();
+    }
+    return g_shared_settings_;
+}
+
+PictoSettings::PictoSettings() :
+
+batch_(0),
+notify_(false),
+dirty_(false),
+scheduled_(false),
+main_thread_(pthread_self()),
+pending_generation_(0),
+has_pending_(false),
+writing_(false),
+started_(false),
+quit_(false),
+generation_(0),
+saved_generation_(0) {
+    
+    pthread_mutex_init(&mutex_, NULL);
+    pthread_mutex_init(&io_mutex_, NULL);
+    pthread_mutex_init(&file_mutex_, NULL);
+    pthread_cond_init(&condition_, NULL);
+    pthread_cond_init(&written_, NULL);
+    
+    path_ = CCFileUtils::sharedFileUtils()->getWritablePath() + PICTO_SETTINGS_FILE;
+    load();
+    migrate();
+}
+
+PictoSettings::~PictoSettings() {
+    
+    if (started_) {
+        pthread_mutex_lock(&io_mutex_);
+        quit_ = true;
+        pthread_cond_signal(&condition_);
+        pthread_mutex_unlock(&io_mutex_);
+        pthread_join(thread_, NULL);
+    }
+    
+    flush();
+    
+    pthread_cond_destroy(&written_);
+    pthread_cond_destroy(&condition_);
+    pthread_mutex_destroy(&file_mutex_);
+    pthread_mutex_destroy(&io_mutex_);
+    pthread_mutex_destroy(&mutex_);
+}
+
+int PictoSettings::getInteger(const char* key, int default_value) {
+    return get(key, false, default_value).value;
+}
+
+bool PictoSettings::getBool(const char* key, bool default_value) {
+    return get(key, true, default_value).value != 0;
+}
+
+void PictoSettings::setInteger(const char* key, int value) {
+    set(key, false, value);
+}
+
+void PictoSettings::setBool(const char* key, bool value) {
+    set(key, true, value);
+}
+
+void PictoSettings::beginChanges() {
+    batch_++;
+}
+
+void PictoSettings::endChanges() {
+    
+    if (--batch_ == 0 && notify_) {
+        notify_ = false;
+        CCNotificationCenter::sharedNotificationCenter()->postNotification(PICTO_SETTINGS_CHANGED, this);
+    }
+}
+
+void PictoSettings::flush() {
+    
+    // A snapshot not taken by the writer yet is superseded by this one, and
+    // one being written must reach the file before this returns
+    pthread_mutex_lock(&io_mutex_);
+    bool pending = has_pending_;
+    has_pending_ = false;
+    while (writing_) {
+        pthread_cond_wait(&written_, &io_mutex_);
+    }
+    pthread_mutex_unlock(&io_mutex_);
+    
+    if (!dirty_ && !pending)
+        return;
+    dirty_ = false;
+    
+    save(serialize(), ++generation_);
+}
+
+PictoSettings::Value PictoSettings::get(const char* key, bool boolean, int default_value) {
+    
+    pthread_mutex_lock(&mutex_);
+    std::map<std::string, Value>::iterator it = values_.find(key);
+    if (it != values_.end()) {
+        Value value = it->second;
+        pthread_mutex_unlock(&mutex_);
+        return value;
+    }
+    pthread_mutex_unlock(&mutex_);
+    
+    Value value;
+    value.value = default_value;
+    value.boolean = boolean;
+    
+    // CCUserDefault can only be used from the main thread. What it holds
+    // moves to the settings file with the next commit
+    if (pthread_equal(pthread_self(), main_thread_)) {
+        if (boolean)
+            value.value = CCUserDefault::sharedUserDefault()->getBoolForKey(key, default_value != 0);
+        else
+            value.value = CCUserDefault::sharedUserDefault()->getIntegerForKey(key, default_value);
+        
+        pthread_mutex_lock(&mutex_);
+        values_.insert(std::make_pair(std::string(key), value));
+        pthread_mutex_unlock(&mutex_);
+    }
+    
+    return value;
+}
+
+void PictoSettings::set(const char* key, bool boolean, int value) {
+    
+    pthread_mutex_lock(&mutex_);
+    std::map<std::string, Value>::iterator it = values_.find(key);
+    if (it != values_.end() && it->second.value == value) {
+        pthread_mutex_unlock(&mutex_);
+        return;
+    }
+    Value& entry = values_[key];
+    entry.value = value;
+    entry.boolean = boolean;
+    pthread_mutex_unlock(&mutex_);
+    
+    dirty_ = true;
+    
+    // Committed on the next frame, along with whatever else changes until then
+    if (!scheduled_) {
+        scheduled_ = true;
+        CCDirector::sharedDirector()->getScheduler()->scheduleSelector(schedule_selector(PictoSettings::commit), this, 0, 0, 0, false);
+    }
+    
+    if (batch_ > 0)
+        notify_ = true;
+    else
+        CCNotificationCenter::sharedNotificationCenter()->postNotification(PICTO_SETTINGS_CHANGED, this);
+}
+
+void PictoSettings::load() {
+    
+    FILE* file = fopen(path_.c_str(), "rb");
+    if (!file)
+        return;
+    
+    std::string data;
+    char buffer[1024];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.append(buffer, read);
+    }
+    fclose(file);
+    
+    const unsigned char* bytes = (const unsigned char*)data.data();
+    size_t size = data.size();
+    if (size < PICTO_SETTINGS_HEADER_SIZE + 4 || memcmp(bytes, "PSET", 4) != 0 ||
+        bytes[4] != PICTO_SETTINGS_VERSION || get32(bytes + size - 4) != hash(bytes, size - 4)) {
+        CCLOGERROR("Ignoring damaged settings file %s", path_.c_str());
+        return;
+    }
+    
+    unsigned int count = get32(bytes + 8);
+    size_t offset = PICTO_SETTINGS_HEADER_SIZE;
+    std::map<std::string, Value> values;
+    
+    for (unsigned int i=0; i < count; i++) {
+        if (offset + 2 > size - 4 || offset + 2 + bytes[offset + 1] + 4 > size - 4) {
+            CCLOGERROR("Ignoring damaged settings file %s", path_.c_str());
+            return;
+        }
+        
+        Value value;
+        value.boolean = bytes[offset] == kPictoSettingsBool;
+        size_t length = bytes[offset + 1];
+        std::string key((const char*)bytes + offset + 2, length);
+        value.value = (int)get32(bytes + offset + 2 + length);
+        values[key] = value;
+        
+        offset += 2 + length + 4;
+    }
+    
+    values_.swap(values);
+}
+
+void PictoSettings::migrate() {
+    
+    CCUserDefault* user_default = CCUserDefault::sharedUserDefault();
+    
+    for (size_t i=0; i < sizeof(g_known_keys_)/sizeof(g_known_keys_[0]); i++) {
+        const char* key = g_known_keys_[i].key;
+        if (values_.count(key))
+            continue;
+        
+        // CCUserDefault can't tell whether it has a key, but a stored value
+        // doesn't change with the default asked for
+        Value value;
+        value.boolean = g_known_keys_[i].boolean;
+        if (value.boolean) {
+            value.value = user_default->getBoolForKey(key, false);
+            if (value.value != user_default->getBoolForKey(key, true))
+                continue;
+        } else {
+            value.value = user_default->getIntegerForKey(key, 0);
+            if (value.value != user_default->getIntegerForKey(key, 1))
+                continue;
+        }
+        
+        values_[key] = value;
+        dirty_ = true;
+    }
+}
+
+std::string PictoSettings::serialize() {
+    
+    std::string data("PSET", 4);
+    data += (char)PICTO_SETTINGS_VERSION;
+    data.append(3, '\0');
+    
+    pthread_mutex_lock(&mutex_);
+    put32(data, values_.size());
+    for (std::map<std::string, Value>::iterator it = values_.begin(); it != values_.end(); ++it) {
+        data += (char)(it->second.boolean? kPictoSettingsBool : kPictoSettingsInteger);
+        data += (char)MIN(it->first.size(), 255);
+        data.append(it->first, 0, 255);
+        put32(data, (unsigned int)it->second.value);
+    }
+    pthread_mutex_unlock(&mutex_);
+    
+    put32(data, hash((const unsigned char*)data.data(), data.size()));
+    return data;
+}
+
+void PictoSettings::save(const std::string& data, unsigned int generation) {
+    
+    pthread_mutex_lock(&file_mutex_);
+    if (generation <= saved_generation_) {
+        pthread_mutex_unlock(&file_mutex_);
+        return;
+    }
+    
+    // Written aside and renamed over the old file, which stays intact if
+    // anything fails on the way
+    std::string temp = path_ + ".tmp";
+    FILE* file = fopen(temp.c_str(), "wb");
+    bool written = file != NULL;
+    if (file) {
+        written = fwrite(data.data(), 1, data.size(), file) == data.size();
+        written = fflush(file) == 0 && written;
+        written = fsync(fileno(file)) == 0 && written;
+        written = fclose(file) == 0 && written;
+    }
+    
+    if (written && rename(temp.c_str(), path_.c_str()) == 0) {
+        saved_generation_ = generation;
+    } else {
+        CCLOGERROR("Can't write settings to %s", path_.c_str());
+        remove(temp.c_str());
+    }
+    pthread_mutex_unlock(&file_mutex_);
+}
+
+void PictoSettings::commit(float dt) {
+    
+    scheduled_ = false;
+    if (!dirty_)
+        return;
+    dirty_ = false;
+    
+    std::string data = serialize();
+    unsigned int generation = ++generation_;
+    
+    if (!started_) {
+        pthread_create(&thread_, NULL, &PictoSettings::work, this);
+        started_ = true;
+    }
+    
+    // Only the latest snapshot is worth writing
+    pthread_mutex_lock(&io_mutex_);
+    pending_.swap(data);
+    pending_generation_ = generation;
+    has_pending_ = true;
+    pthread_cond_signal(&condition_);
+    pthread_mutex_unlock(&io_mutex_);
+}
+
+void* PictoSettings::work(void* data) {
+    
+    PictoSettings* settings = static_cast<PictoSettings*>(data);
+    
+    for (;;) {
+        pthread_mutex_lock(&settings->io_mutex_);
+        while (!settings->has_pending_ && !settings->quit_) {
+            pthread_cond_wait(&settings->condition_, &settings->io_mutex_);
+        }
+        if (!settings->has_pending_) {
+            pthread_mutex_unlock(&settings->io_mutex_);
+            break;
+        }
+        std::string data;
+        data.swap(settings->pending_);
+        unsigned int generation = settings->pending_generation_;
+        settings->has_pending_ = false;
+        settings->writing_ = true;
+        pthread_mutex_unlock(&settings->io_mutex_);
+        
+        settings->save(data, generation);
+        
+        pthread_mutex_lock(&settings->io_mutex_);
+        settings->writing_ = false;
+        pthread_cond_broadcast(&settings->written_);
+        pthread_mutex_unlock(&settings->io_mutex_);
+    }
+    
+    return NULL;
+}
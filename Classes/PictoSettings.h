@@ -0,0 +1,134 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoSettings.h
+ * @brief In-memory snapshot of the user settings
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_SETTINGS_H__
+#define __PICTO_SETTINGS_H__
+
+#include "cocos2d.h"
+
+#include <pthread.h>
+
+#include <map>
+#include <string>
+
+// Posted through CCNotificationCenter after settings change
+#define PICTO_SETTINGS_CHANGED "picto_settings_changed"
+
+/**
+ * Settings kept in memory and stored in a small binary file in the
+ * writable path, so the theme colors and flags asked for by every node
+ * cost a map lookup. Changes update the snapshot right away, are announced
+ * with PICTO_SETTINGS_CHANGED and are committed together on the next frame
+ * by a background thread, which writes a temporary file and renames it
+ * over the old one so a crash never leaves a partial file. Changes made
+ * between beginChanges and endChanges are announced once, when all of them
+ * are in place. Known keys missing from the file are read once from
+ * CCUserDefault, where earlier versions kept them, when the settings are
+ * created on the main thread.
+ *
+ * Reads are safe from any thread; changes are made on the main thread.
+ */
+class PictoSettings : public cocos2d::CCObject {
+    
+public: // constructors and creators
+    
+    static PictoSettings* sharedSettings();
+    
+    PictoSettings();
+    ~PictoSettings();
+    
+public: // public methods
+    
+    int getInteger(const char* key, int default_value);
+    bool getBool(const char* key, bool default_value);
+    
+    void setInteger(const char* key, int value);
+    void setBool(const char* key, bool value);
+    
+    void beginChanges();
+    void endChanges();
+    
+    // Writes the pending changes now, on the calling thread
+    void flush();
+    
+private: // private types
+    
+    struct Value {
+        int value;
+        bool boolean;
+    };
+    
+private: // private methods
+    
+    Value get(const char* key, bool boolean, int default_value);
+    void set(const char* key, bool boolean, int value);
+    
+    void load();
+    void migrate();
+    std::string serialize();
+    void save(const std::string& data, unsigned int generation);
+    
+    void commit(float dt);
+    static void* work(void* settings);
+    
+private: // private variables
+    
+    std::map<std::string, Value> values_;
+    std::string path_;
+    int batch_;
+    bool notify_;
+    bool dirty_;
+    bool scheduled_;
+    
+    // Guards values_
+    pthread_mutex_t mutex_;
+    pthread_t main_thread_;
+    
+    // Snapshot waiting for the writer thread and whether it's writing one,
+    // guarded by io_mutex_
+    pthread_t thread_;
+    pthread_mutex_t io_mutex_;
+    pthread_cond_t condition_;
+    pthread_cond_t written_;
+    std::string pending_;
+    unsigned int pending_generation_;
+    bool has_pending_;
+    bool writing_;
+    bool started_;
+    bool quit_;
+    
+    // Snapshots are numbered so an older one never replaces a newer one
+    // in the file, guarded by file_mutex_
+    pthread_mutex_t file_mutex_;
+    unsigned int generation_;
+    unsigned int saved_generation_;
+};
+
+#endif // __PICTO_SETTINGS_H__
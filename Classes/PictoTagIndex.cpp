@@ -0,0 +1,159 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoTagIndex.cpp
+ * @brief In-memory bitset index of pictogram tags and levels
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoTagIndex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define LEVEL_PREFIX "level<="
+
+static std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos)
+        return "";
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+
+PictoTagIndex::PictoTagIndex() {}
+
+size_t PictoTagIndex::add(const std::string& identifier) {
+    
+    std::map<std::string, size_t>::iterator it = ordinals_.find(identifier);
+    if (it != ordinals_.end())
+        return it->second;
+    
+    size_t ordinal = identifiers_.size();
+    identifiers_.push_back(identifier);
+    ordinals_[identifier] = ordinal;
+    
+    return ordinal;
+}
+
+void PictoTagIndex::tag(const std::string& identifier, const std::string& tag) {
+    
+    size_t ordinal = add(identifier);
+    
+    PictoBitset& bits = tags_[tag];
+    if (bits.size() <= ordinal) {
+        PictoBitset grown(identifiers_.size());
+        grown |= bits;
+        bits = grown;
+    }
+    bits.set(ordinal);
+}
+
+void PictoTagIndex::level(const std::string& identifier, int level) {
+    
+    if (level < 0)
+        return;
+    
+    size_t ordinal = add(identifier);
+    
+    if (levels_.size() <= (size_t)level)
+        levels_.resize(level + 1);
+    
+    PictoBitset& bits = levels_[level];
+    if (bits.size() <= ordinal) {
+        PictoBitset grown(identifiers_.size());
+        grown |= bits;
+        bits = grown;
+    }
+    bits.set(ordinal);
+}
+
+PictoBitset PictoTagIndex::levelAtMost(int level) const {
+    
+    PictoBitset result(identifiers_.size());
+    for (int i=0; i <= level && i < (int)levels_.size(); i++)
+        result |= levels_[i];
+    
+    return result;
+}
+
+PictoBitset PictoTagIndex::item(const std::string& text) const {
+    
+    std::string name = trim(text);
+    bool negated = false;
+    
+    if (!name.empty() && name[0] == '!') {
+        negated = true;
+        name = trim(name.substr(1));
+    }
+    
+    PictoBitset result(identifiers_.size());
+    
+    if (name.compare(0, strlen(LEVEL_PREFIX), LEVEL_PREFIX) == 0) {
+        result = levelAtMost(atoi(name.c_str() + strlen(LEVEL_PREFIX)));
+    } else {
+        std::map<std::string, PictoBitset>::const_iterator it = tags_.find(name);
+        if (it != tags_.end())
+            result |= it->second;
+    }
+    
+    if (negated)
+        result.flip();
+    
+    return result;
+}
+
+PictoBitset PictoTagIndex::evaluate(const std::string& filter) const {
+    
+    PictoBitset result(identifiers_.size(), true);
+    
+    size_t group_begin = 0;
+    while (group_begin <= filter.size()) {
+        size_t group_end = filter.find('&', group_begin);
+        if (group_end == std::string::npos)
+            group_end = filter.size();
+        
+        std::string group = filter.substr(group_begin, group_end - group_begin);
+        if (!trim(group).empty()) {
+            PictoBitset alternatives(identifiers_.size());
+            
+            size_t item_begin = 0;
+            while (item_begin <= group.size()) {
+                size_t item_end = group.find('|', item_begin);
+                if (item_end == std::string::npos)
+                    item_end = group.size();
+                
+                alternatives |= item(group.substr(item_begin, item_end - item_begin));
+                item_begin = item_end + 1;
+            }
+            
+            result &= alternatives;
+        }
+        
+        group_begin = group_end + 1;
+    }
+    
+    return result;
+}
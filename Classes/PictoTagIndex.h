@@ -0,0 +1,80 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoTagIndex.h
+ * @brief In-memory bitset index of pictogram tags and levels
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_TAG_INDEX_H__
+#define __PICTO_TAG_INDEX_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "PictoBitset.h"
+
+/**
+ * One bitset per tag and per difficulty level over every pictogram of the
+ * catalog. Filters are evaluated with bitwise operations only.
+ *
+ * Filter syntax: groups separated by '&' must all match, items separated by
+ * '|' inside a group are alternatives and '!' negates an item. An item is a
+ * tag name or a level bound written "level<=N". For example
+ * "food|drink&level<=2&!hidden".
+ */
+class PictoTagIndex {
+    
+public: // constructors
+    
+    PictoTagIndex();
+    
+public: // public methods
+    
+    // Returns the ordinal of the pictogram, adding it when it's new
+    size_t add(const std::string& identifier);
+    void tag(const std::string& identifier, const std::string& tag);
+    void level(const std::string& identifier, int level);
+    
+    size_t size() const { return identifiers_.size(); }
+    const std::string& identifier(size_t ordinal) const { return identifiers_[ordinal]; }
+    
+    PictoBitset evaluate(const std::string& filter) const;
+    
+private: // private methods
+    
+    PictoBitset item(const std::string& item) const;
+    PictoBitset levelAtMost(int level) const;
+    
+private: // private variables
+    
+    std::vector<std::string> identifiers_;
+    std::map<std::string, size_t> ordinals_;
+    std::map<std::string, PictoBitset> tags_;
+    std::vector<PictoBitset> levels_;
+};
+
+#endif // __PICTO_TAG_INDEX_H__
@@ -0,0 +1,179 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoTextureCache.cpp
+ * @brief Byte budgeted, least recently used texture eviction
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoTextureCache.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+USING_NS_CC;
+
+// Default budget, enough for the chrome and a few grids of cards
+#define PICTO_TEXTURE_BUDGET (32*1024*1024)
+
+// Seconds between two stamps of the textures in use
+#define PICTO_TEXTURE_STAMP_INTERVAL 0.5f
+
+static size_t g_budget_ = PICTO_TEXTURE_BUDGET;
+
+// Keys of the pinned textures
+static std::set<std::string> g_pinned_;
+
+// Last frame each texture was seen in use, by texture cache key
+static std::map<std::string, unsigned int> g_last_used_;
+
+// Stamps the textures in use on the director's schedule, while they're on
+// screen, so the order of eviction doesn't depend on when trim is called
+class TextureStamper : public CCObject {
+    
+public:
+    
+    void stamp(float dt) {
+        PictoTextureCache::stamp();
+    }
+};
+
+static TextureStamper* g_stamper_ = NULL;
+
+static void schedule_stamps() {
+    
+    if (g_stamper_)
+        return;
+    
+    g_stamper_ = new TextureStamper();
+    CCDirector::sharedDirector()->getScheduler()->scheduleSelector(schedule_selector(TextureStamper::stamp), g_stamper_, PICTO_TEXTURE_STAMP_INTERVAL, false);
+}
+
+struct EvictionCandidate {
+    unsigned int last_used;
+    size_t bytes;
+    std::string key;
+    
+    bool operator<(const EvictionCandidate& other) const {
+        return last_used < other.last_used;
+    }
+};
+
+void PictoTextureCache::setBudget(size_t bytes) {
+    
+    g_budget_ = bytes;
+    trim();
+}
+
+size_t PictoTextureCache::budget() {
+    
+    return g_budget_;
+}
+
+void PictoTextureCache::pin(const char* image) {
+    
+    schedule_stamps();
+    
+    if (CCTextureCache::sharedTextureCache()->addImage(image)) {
+        g_pinned_.insert(CCFileUtils::sharedFileUtils()->fullPathForFilename(image));
+    }
+}
+
+void PictoTextureCache::trim() {
+    
+    schedule_stamps();
+    evict(g_budget_);
+}
+
+void PictoTextureCache::stamp() {
+    
+    unsigned int frame = CCDirector::sharedDirector()->getTotalFrames();
+    CCDictionary* textures = CCTextureCache::sharedTextureCache()->snapshotTextures();
+    
+    CCDictElement* element = NULL;
+    CCDICT_FOREACH(textures, element) {
+        if (element->getObject()->retainCount() > 2) {
+            g_last_used_[element->getStrKey()] = frame;
+        }
+    }
+}
+
+void PictoTextureCache::evict() {
+    
+    evict(0);
+}
+
+void PictoTextureCache::evict(size_t budget) {
+    
+    CCTextureCache* cache = CCTextureCache::sharedTextureCache();
+    unsigned int frame = CCDirector::sharedDirector()->getTotalFrames();
+    
+    // The snapshot holds a reference of its own, so textures retained only by
+    // the cache and the snapshot are unused
+    CCDictionary* textures = cache->snapshotTextures();
+    
+    std::map<std::string, unsigned int> last_used;
+    std::vector<EvictionCandidate> candidates;
+    size_t total = 0;
+    
+    CCDictElement* element = NULL;
+    CCDICT_FOREACH(textures, element) {
+        CCTexture2D* texture = dynamic_cast<CCTexture2D*>(element->getObject());
+        std::string key = element->getStrKey();
+        size_t size = bytes(texture);
+        total += size;
+        
+        // Textures seen for the first time count as just used
+        std::map<std::string, unsigned int>::iterator it = g_last_used_.find(key);
+        unsigned int used = (texture->retainCount() > 2 || it == g_last_used_.end())? frame : it->second;
+        last_used[key] = used;
+        
+        if (texture->retainCount() <= 2 && g_pinned_.find(key) == g_pinned_.end()) {
+            EvictionCandidate candidate = { used, size, key };
+            candidates.push_back(candidate);
+        }
+    }
+    
+    std::sort(candidates.begin(), candidates.end());
+    
+    size_t evicted = 0;
+    for (size_t i=0; i < candidates.size() && total > budget; i++) {
+        cache->removeTextureForKey(candidates[i].key.c_str());
+        last_used.erase(candidates[i].key);
+        total -= candidates[i].bytes;
+        evicted += candidates[i].bytes;
+    }
+    
+    g_last_used_.swap(last_used);
+    
+    CCLOG("PictoTextureCache: %lu KB evicted, %lu KB cached", (unsigned long)evicted/1024, (unsigned long)total/1024);
+}
+
+size_t PictoTextureCache::bytes(CCTexture2D* texture) {
+    
+    return (size_t)texture->getPixelsWide()*texture->getPixelsHigh()*texture->bitsPerPixelForFormat()/8;
+}
@@ -0,0 +1,73 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoTextureCache.h
+ * @brief Byte budgeted, least recently used texture eviction
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_TEXTURE_CACHE_H__
+#define __PICTO_TEXTURE_CACHE_H__
+
+#include "cocos2d.h"
+
+#include <string>
+
+/**
+ * Eviction policy on top of the cocos2d texture cache. Instead of dropping
+ * every unused texture on each navigation, unused textures are kept until
+ * the cache grows over a byte budget, and then the ones used the longest ago
+ * go first. A texture counts as used on the frame it was last seen retained
+ * by something other than the cache, checked twice a second once the cache
+ * is in use and on every trim. Pinned textures, like the chrome shared by
+ * all the scenes, are never evicted.
+ */
+class PictoTextureCache {
+    
+public: // public methods
+    
+    static void setBudget(size_t bytes);
+    static size_t budget();
+    
+    // Loads the image and keeps its texture in the cache for good
+    static void pin(const char* image);
+    
+    // Evicts unused textures, least recently used first, until the cache
+    // fits the budget
+    static void trim();
+    
+    // Evicts every unused texture that isn't pinned, on low memory
+    static void evict();
+    
+    // Marks the textures in use as used on this frame
+    static void stamp();
+    
+private: // private methods
+    
+    static void evict(size_t budget);
+    static size_t bytes(cocos2d::CCTexture2D* texture);
+};
+
+#endif // __PICTO_TEXTURE_CACHE_H__
@@ -30,43 +30,68 @@
 
 #include "PictoTheme.h"
 
+#include "PictoCardCache.h"
 #include "PictoDefs.h"
+#include "PictoSettings.h"
 
 USING_NS_CC;
 
 using namespace picto::conversions;
 
+// Loaded on first use and kept for the lifetime of the app
+static CCArray* g_themes_ = NULL;
+
+static unsigned int g_generation_ = 0;
+
+static unsigned int theme_color(CCDictionary* dictionary, const char* key) {
+    return strtoul(dictionary->valueForKey(key)->getCString(), NULL, 16);
+}
+
 CCArray* PictoTheme::themes() {
-    CCArray* themes = CCArray::create();
-    for (int i=0; i < 4; i++) {
-        themes->addObject(PictoTheme::create(i));
+    
+    if (g_themes_)
+        return g_themes_;
+    
+    g_themes_ = CCArray::create();
+    g_themes_->retain();
+    
+    CCArray* entries = CCArray::createWithContentsOfFile(PICTO_THEMES_FILE);
+    CCObject* it;
+    CCARRAY_FOREACH(entries, it) {
+        CCDictionary* entry = dynamic_cast<CCDictionary*>(it);
+        if (!entry)
+            continue;
+        PictoTheme* theme = new PictoTheme(entry->valueForKey("identifier")->intValue(),
+                                           theme_color(entry, "backgroundColor"),
+                                           theme_color(entry, "menuTextColor"),
+                                           theme_color(entry, "navigationBarBackgroundColor"),
+                                           theme_color(entry, "navigationBarTextColor"),
+                                           theme_color(entry, "speakerButtonBackgroundColor"),
+                                           theme_color(entry, "speakerButtonTextColor"));
+        g_themes_->addObject(theme);
+        theme->release();
     }
-    return themes;
+    
+    // The original blue theme, so the app keeps its colors without the file
+    if (g_themes_->count() == 0) {
+        CCLOGERROR("No themes in %s", PICTO_THEMES_FILE);
+        PictoTheme* theme = new PictoTheme(0, 0x5cc4dc, 0xffffff, 0x024e68, 0xffffff, 0xffff00, 0x000000);
+        g_themes_->addObject(theme);
+        theme->release();
+    }
+    
+    return g_themes_;
 }
 
 PictoTheme* PictoTheme::create(const unsigned int identifier) {
-    PictoTheme* theme = NULL;
     
-    switch (identifier) {
-            
-        case 0: // Original blue theme
-            theme = new PictoTheme(identifier, 0x5cc4dc, 0xffffff, 0x024e68, 0xffffff, 0xffff00, 0x000000);
-            break;
-        case 1: // Pink theme
-            theme = new PictoTheme(identifier, 0xfa8ead, 0xffffff, 0xff0094, 0xffffff, 0xffff00, 0x000000);
-            break;
-        case 2: // Red/yellow theme
-            theme = new PictoTheme(identifier, 0xe2eb8d, 0x000000, 0xc50000, 0xffffff, 0x00a5cb, 0x000000);
-            break;
-        case 3: // Purple theme
-            theme = new PictoTheme(identifier, 0x990fd1, 0xffffff, 0x550fd2, 0xffffff, 0xe5e5e5, 0x000000);
-            break;
-        default:
-            break;
+    CCObject* it;
+    CCARRAY_FOREACH(themes(), it) {
+        PictoTheme* theme = static_cast<PictoTheme*>(it);
+        if (theme->identifier == identifier)
+            return theme;
     }
-    
-    theme->autorelease();
-    return theme;
+    return NULL;
 }
 
 PictoTheme::PictoTheme(const unsigned int identifier_,
@@ -86,18 +111,34 @@ speakerButtonTextColor(int2color3B(speakerButtonTextColor_)) {}
 
 void PictoTheme::select() {
     
-    CCUserDefault::sharedUserDefault()->setIntegerForKey("selected_theme", identifier);
+    PictoSettings* settings = PictoSettings::sharedSettings();
+    
+    // Cards baked with other colors would never be used again
+    PictoCardCache::purge();
+    
+    // Listeners see the whole theme change at once
+    settings->beginChanges();
+    settings->setInteger("selected_theme", identifier);
+    settings->setInteger("backgroundColor", picto::conversions::color2int(backgroundColor));
+    settings->setInteger("menuTextColor", picto::conversions::color2int(menuTextColor));
+    settings->setInteger("navigationBarBackgroundColor", picto::conversions::color2int(navigationBarBackgroundColor));
+    settings->setInteger("navigationBarTextColor", picto::conversions::color2int(navigationBarTextColor));
+    settings->setInteger("speakerButtonBackgroundColor", picto::conversions::color2int(speakerButtonBackgroundColor));
+    settings->setInteger("speakerButtonTextColor", picto::conversions::color2int(speakerButtonTextColor));
+    settings->endChanges();
     
-    CCUserDefault::sharedUserDefault()->setIntegerForKey("backgroundColor",
-                                                         picto::conversions::color2int(backgroundColor));
-    CCUserDefault::sharedUserDefault()->setIntegerForKey("menuTextColor",
-                                                         picto::conversions::color2int(menuTextColor));
-    CCUserDefault::sharedUserDefault()->setIntegerForKey("navigationBarBackgroundColor",
-                                                         picto::conversions::color2int(navigationBarBackgroundColor));
-    CCUserDefault::sharedUserDefault()->setIntegerForKey("navigationBarTextColor",
-                                                         picto::conversions::color2int(navigationBarTextColor));
-    CCUserDefault::sharedUserDefault()->setIntegerForKey("speakerButtonBackgroundColor",
-                                                         picto::conversions::color2int(speakerButtonBackgroundColor));
-    CCUserDefault::sharedUserDefault()->setIntegerForKey("speakerButtonTextColor",
-                                                         picto::conversions::color2int(speakerButtonTextColor));
+    g_generation_++;
+    CCNotificationCenter::sharedNotificationCenter()->postNotification(PICTO_THEME_CHANGED, this);
+}
+
+void PictoTheme::subscribe(CCObject* target, SEL_CallFuncO selector) {
+    CCNotificationCenter::sharedNotificationCenter()->addObserver(target, selector, PICTO_THEME_CHANGED, NULL);
+}
+
+void PictoTheme::unsubscribe(CCObject* target) {
+    CCNotificationCenter::sharedNotificationCenter()->removeObserver(target, PICTO_THEME_CHANGED);
+}
+
+unsigned int PictoTheme::generation() {
+    return g_generation_;
 }
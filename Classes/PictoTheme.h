@@ -41,12 +41,29 @@
 
 #include "cocos2d.h"
 
+// Themes shipped with the app, relative to the resources
+#define PICTO_THEMES_FILE "themes.plist"
+
+// Posted through CCNotificationCenter with the theme after one is selected
+#define PICTO_THEME_CHANGED "picto_theme_changed"
+
+/**
+ * Color configuration of the app. Themes are read once from
+ * PICTO_THEMES_FILE, an array of dictionaries holding an identifier and
+ * the colors as hex strings. Selecting a theme stores its colors in the
+ * settings and pushes it to the subscribed nodes, which repaint in place.
+ * Nodes subscribe in onEnter, after reading the current colors, and
+ * unsubscribe in onExit. Baked cards miss the changes made while their node
+ * was off the stage, so they keep the generation they were baked in and
+ * compare it on enter.
+ */
 class PictoTheme : public cocos2d::CCObject {
     
 public: // public constructors and creators
     
     static cocos2d::CCArray* themes();
     
+    // Theme with the given identifier, or NULL when there is none
     static PictoTheme* create(const unsigned int identifier);
     
     PictoTheme(const unsigned int identifier,
@@ -61,6 +78,12 @@ public: // public methods
     
     void select();
     
+    static void subscribe(cocos2d::CCObject* target, cocos2d::SEL_CallFuncO selector);
+    static void unsubscribe(cocos2d::CCObject* target);
+    
+    // Bumped by every select()
+    static unsigned int generation();
+    
 public: // public variables
     
     const unsigned int identifier;
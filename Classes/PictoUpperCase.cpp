@@ -0,0 +1,287 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoUpperCase.cpp
+ * @brief Uppercase conversion of the text shown in labels
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include "PictoUpperCase.h"
+
+#include <map>
+#include <pthread.h>
+#include <stddef.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Uppercased strings remembered by toupper, forgotten all at once when full
+#define PICTO_UPPER_CACHE_SIZE 256
+
+namespace picto
+{
+    namespace conversions
+    {
+        // Generated by tools/gen_case_table.py
+        const unsigned short g_upper_[PICTO_UPPER_TABLE_SIZE] = {
+            0x0000, 0x0001, 0x0002, 0x0003, 0x0004, 0x0005, 0x0006, 0x0007,
+            0x0008, 0x0009, 0x000a, 0x000b, 0x000c, 0x000d, 0x000e, 0x000f,
+            0x0010, 0x0011, 0x0012, 0x0013, 0x0014, 0x0015, 0x0016, 0x0017,
+            0x0018, 0x0019, 0x001a, 0x001b, 0x001c, 0x001d, 0x001e, 0x001f,
+            0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027,
+            0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+            0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037,
+            0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+            0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047,
+            0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+            0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057,
+            0x0058, 0x0059, 0x005a, 0x005b, 0x005c, 0x005d, 0x005e, 0x005f,
+            0x0060, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047,
+            0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+            0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057,
+            0x0058, 0x0059, 0x005a, 0x007b, 0x007c, 0x007d, 0x007e, 0x007f,
+            0x0080, 0x0081, 0x0082, 0x0083, 0x0084, 0x0085, 0x0086, 0x0087,
+            0x0088, 0x0089, 0x008a, 0x008b, 0x008c, 0x008d, 0x008e, 0x008f,
+            0x0090, 0x0091, 0x0092, 0x0093, 0x0094, 0x0095, 0x0096, 0x0097,
+            0x0098, 0x0099, 0x009a, 0x009b, 0x009c, 0x009d, 0x009e, 0x009f,
+            0x00a0, 0x00a1, 0x00a2, 0x00a3, 0x00a4, 0x00a5, 0x00a6, 0x00a7,
+            0x00a8, 0x00a9, 0x00aa, 0x00ab, 0x00ac, 0x00ad, 0x00ae, 0x00af,
+            0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x00b4, 0x00b5, 0x00b6, 0x00b7,
+            0x00b8, 0x00b9, 0x00ba, 0x00bb, 0x00bc, 0x00bd, 0x00be, 0x00bf,
+            0x00c0, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x00c7,
+            0x00c8, 0x00c9, 0x00ca, 0x00cb, 0x00cc, 0x00cd, 0x00ce, 0x00cf,
+            0x00d0, 0x00d1, 0x00d2, 0x00d3, 0x00d4, 0x00d5, 0x00d6, 0x00d7,
+            0x00d8, 0x00d9, 0x00da, 0x00db, 0x00dc, 0x00dd, 0x00de, 0x00df,
+            0x00c0, 0x00c1, 0x00c2, 0x00c3, 0x00c4, 0x00c5, 0x00c6, 0x00c7,
+            0x00c8, 0x00c9, 0x00ca, 0x00cb, 0x00cc, 0x00cd, 0x00ce, 0x00cf,
+            0x00d0, 0x00d1, 0x00d2, 0x00d3, 0x00d4, 0x00d5, 0x00d6, 0x00f7,
+            0x00d8, 0x00d9, 0x00da, 0x00db, 0x00dc, 0x00dd, 0x00de, 0x0178,
+            0x0100, 0x0100, 0x0102, 0x0102, 0x0104, 0x0104, 0x0106, 0x0106,
+            0x0108, 0x0108, 0x010a, 0x010a, 0x010c, 0x010c, 0x010e, 0x010e,
+            0x0110, 0x0110, 0x0112, 0x0112, 0x0114, 0x0114, 0x0116, 0x0116,
+            0x0118, 0x0118, 0x011a, 0x011a, 0x011c, 0x011c, 0x011e, 0x011e,
+            0x0120, 0x0120, 0x0122, 0x0122, 0x0124, 0x0124, 0x0126, 0x0126,
+            0x0128, 0x0128, 0x012a, 0x012a, 0x012c, 0x012c, 0x012e, 0x012e,
+            0x0130, 0x0049, 0x0132, 0x0132, 0x0134, 0x0134, 0x0136, 0x0136,
+            0x0138, 0x0139, 0x0139, 0x013b, 0x013b, 0x013d, 0x013d, 0x013f,
+            0x013f, 0x0141, 0x0141, 0x0143, 0x0143, 0x0145, 0x0145, 0x0147,
+            0x0147, 0x0149, 0x014a, 0x014a, 0x014c, 0x014c, 0x014e, 0x014e,
+            0x0150, 0x0150, 0x0152, 0x0152, 0x0154, 0x0154, 0x0156, 0x0156,
+            0x0158, 0x0158, 0x015a, 0x015a, 0x015c, 0x015c, 0x015e, 0x015e,
+            0x0160, 0x0160, 0x0162, 0x0162, 0x0164, 0x0164, 0x0166, 0x0166,
+            0x0168, 0x0168, 0x016a, 0x016a, 0x016c, 0x016c, 0x016e, 0x016e,
+            0x0170, 0x0170, 0x0172, 0x0172, 0x0174, 0x0174, 0x0176, 0x0176,
+            0x0178, 0x0179, 0x0179, 0x017b, 0x017b, 0x017d, 0x017d, 0x0053
+        };
+        
+        // Generated by tools/gen_case_table.py
+        const unsigned short g_fold_[PICTO_UPPER_TABLE_SIZE] = {
+            0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037,
+            0x0038, 0x0039, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047,
+            0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+            0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057,
+            0x0058, 0x0059, 0x005a, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047,
+            0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+            0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057,
+            0x0058, 0x0059, 0x005a, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0020, 0x00aa, 0x0020, 0x0020, 0x0020, 0x0020, 0x0020,
+            0x0020, 0x0020, 0x00b2, 0x00b3, 0x0020, 0x00b5, 0x0020, 0x0020,
+            0x0020, 0x00b9, 0x00ba, 0x0020, 0x00bc, 0x00bd, 0x00be, 0x0020,
+            0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x0043,
+            0x0045, 0x0045, 0x0045, 0x0045, 0x0049, 0x0049, 0x0049, 0x0049,
+            0x0044, 0x004e, 0x004f, 0x004f, 0x004f, 0x004f, 0x004f, 0x0020,
+            0x004f, 0x0055, 0x0055, 0x0055, 0x0055, 0x0059, 0x0054, 0x00df,
+            0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x0043,
+            0x0045, 0x0045, 0x0045, 0x0045, 0x0049, 0x0049, 0x0049, 0x0049,
+            0x0044, 0x004e, 0x004f, 0x004f, 0x004f, 0x004f, 0x004f, 0x0020,
+            0x004f, 0x0055, 0x0055, 0x0055, 0x0055, 0x0059, 0x0054, 0x0059,
+            0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x0041, 0x0043, 0x0043,
+            0x0043, 0x0043, 0x0043, 0x0043, 0x0043, 0x0043, 0x0044, 0x0044,
+            0x0044, 0x0044, 0x0045, 0x0045, 0x0045, 0x0045, 0x0045, 0x0045,
+            0x0045, 0x0045, 0x0045, 0x0045, 0x0047, 0x0047, 0x0047, 0x0047,
+            0x0047, 0x0047, 0x0047, 0x0047, 0x0048, 0x0048, 0x0048, 0x0048,
+            0x0049, 0x0049, 0x0049, 0x0049, 0x0049, 0x0049, 0x0049, 0x0049,
+            0x0049, 0x0049, 0x0132, 0x0132, 0x004a, 0x004a, 0x004b, 0x004b,
+            0x004b, 0x004c, 0x004c, 0x004c, 0x004c, 0x004c, 0x004c, 0x004c,
+            0x004c, 0x004c, 0x004c, 0x004e, 0x004e, 0x004e, 0x004e, 0x004e,
+            0x004e, 0x0149, 0x004e, 0x004e, 0x004f, 0x004f, 0x004f, 0x004f,
+            0x004f, 0x004f, 0x004f, 0x004f, 0x0052, 0x0052, 0x0052, 0x0052,
+            0x0052, 0x0052, 0x0053, 0x0053, 0x0053, 0x0053, 0x0053, 0x0053,
+            0x0053, 0x0053, 0x0054, 0x0054, 0x0054, 0x0054, 0x0054, 0x0054,
+            0x0055, 0x0055, 0x0055, 0x0055, 0x0055, 0x0055, 0x0055, 0x0055,
+            0x0055, 0x0055, 0x0055, 0x0055, 0x0057, 0x0057, 0x0059, 0x0059,
+            0x0059, 0x005a, 0x005a, 0x005a, 0x005a, 0x005a, 0x005a, 0x0053
+        };
+        
+        // toupper is safe from any thread, the cache is shared
+        static std::map<std::string, std::string> g_upper_cache_;
+        static pthread_mutex_t g_upper_cache_mutex_ = PTHREAD_MUTEX_INITIALIZER;
+        
+        static inline unsigned int upper(unsigned int c) {
+            return c < PICTO_UPPER_TABLE_SIZE? g_upper_[c] : c;
+        }
+        
+        // Code points of the table take one or two bytes
+        static inline void append_utf8(unsigned int code, std::string& out) {
+            if (code < 0x80) {
+                out += (char)code;
+            } else {
+                out += (char)(0xc0 | code >> 6);
+                out += (char)(0x80 | (code & 0x3f));
+            }
+        }
+        
+        // Uppercases the ASCII letters of text in place, up to the first non
+        // ASCII byte. Returns how many bytes were ASCII
+        static size_t upper_ascii(char* text, size_t length) {
+            
+            size_t i = 0;
+            
+#if defined(__SSE2__)
+            const __m128i before_a = _mm_set1_epi8('a' - 1);
+            const __m128i after_z = _mm_set1_epi8('z' + 1);
+            const __m128i offset = _mm_set1_epi8('a' - 'A');
+            
+            for (; i + 16 <= length; i += 16) {
+                __m128i bytes = _mm_loadu_si128((const __m128i*)(text + i));
+                if (_mm_movemask_epi8(bytes))
+                    break;
+                __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(bytes, before_a), _mm_cmplt_epi8(bytes, after_z));
+                _mm_storeu_si128((__m128i*)(text + i), _mm_sub_epi8(bytes, _mm_and_si128(lower, offset)));
+            }
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+            const uint8x16_t a = vdupq_n_u8('a');
+            const uint8x16_t z = vdupq_n_u8('z');
+            const uint8x16_t offset = vdupq_n_u8('a' - 'A');
+            
+            for (; i + 16 <= length; i += 16) {
+                uint8x16_t bytes = vld1q_u8((const uint8_t*)(text + i));
+                uint64x2_t high = vreinterpretq_u64_u8(vshrq_n_u8(bytes, 7));
+                if (vgetq_lane_u64(high, 0) | vgetq_lane_u64(high, 1))
+                    break;
+                uint8x16_t lower = vandq_u8(vcgeq_u8(bytes, a), vcleq_u8(bytes, z));
+                vst1q_u8((uint8_t*)(text + i), vsubq_u8(bytes, vandq_u8(lower, offset)));
+            }
+#endif
+            
+            for (; i < length; i++) {
+                unsigned char c = text[i];
+                if (c & 0x80)
+                    break;
+                text[i] = g_upper_[c];
+            }
+            
+            return i;
+        }
+        
+        std::wstring toupper(wchar_t in) {
+            
+            // No single uppercase letter
+            if (in == L'ß')
+                return L"SS";
+            
+            return std::wstring(1, (wchar_t)upper(in));
+        }
+        
+        std::wstring toupper(std::wstring in) {
+            std::wstring out;
+            out.reserve(in.length());
+            for (size_t i=0; i < in.length(); i++)
+                out += toupper(in[i]);
+            
+            return out;
+        }
+        
+        std::string toupper(std::string in) {
+            
+            if (in.empty())
+                return in;
+            
+            // Plain ASCII stays in UTF-8 and needs no table
+            size_t ascii = upper_ascii(&in[0], in.size());
+            if (ascii == in.size())
+                return in;
+            
+            // Keyed by the text with its ASCII prefix uppercased already,
+            // which gives the same result
+            pthread_mutex_lock(&g_upper_cache_mutex_);
+            std::map<std::string, std::string>::iterator it = g_upper_cache_.find(in);
+            if (it != g_upper_cache_.end()) {
+                std::string out = it->second;
+                pthread_mutex_unlock(&g_upper_cache_mutex_);
+                return out;
+            }
+            pthread_mutex_unlock(&g_upper_cache_mutex_);
+            
+            std::string out(in, 0, ascii);
+            out.reserve(in.size() + 8);
+            
+            std::string::const_iterator pos = in.begin() + ascii;
+            while (pos != in.end()) {
+                unsigned char c = *pos;
+                
+                // Past ASCII, only the two byte sequences with lead bytes C2
+                // to C5 encode code points of the table, the rest is copied
+                if (c >= 0xc2 && c <= 0xc5 && pos + 1 != in.end() && (pos[1] & 0xc0) == 0x80) {
+                    unsigned int code = (c & 0x1f) << 6 | (pos[1] & 0x3f);
+                    pos += 2;
+                    if (code == 0xdf) // ß
+                        out += "SS";
+                    else
+                        append_utf8(g_upper_[code], out);
+                    continue;
+                }
+                
+                out += (c < 0x80)? (char)g_upper_[c] : (char)c;
+                ++pos;
+            }
+            
+            pthread_mutex_lock(&g_upper_cache_mutex_);
+            if (g_upper_cache_.size() >= PICTO_UPPER_CACHE_SIZE) {
+                g_upper_cache_.clear();
+            }
+            g_upper_cache_[in] = out;
+            pthread_mutex_unlock(&g_upper_cache_mutex_);
+            
+            return out;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoUpperCase.h
+ * @brief Uppercase conversion of the text shown in labels
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_UPPER_CASE_H__
+#define __PICTO_UPPER_CASE_H__
+
+#include <string>
+
+// Code points covered by the uppercase and folding tables. Must match
+// tools/gen_case_table.py
+#define PICTO_UPPER_TABLE_SIZE 0x180
+
+namespace picto
+{
+    namespace conversions
+    {
+        // Uppercase of every code point from U+0000 to U+017F, Basic Latin,
+        // Latin-1 and Latin Extended-A. Code points with no single uppercase
+        // in the table, like the German sharp s, map to themselves.
+        extern const unsigned short g_upper_[PICTO_UPPER_TABLE_SIZE];
+        
+        // Unaccented uppercase of the same code points, for matching names.
+        // Digits stay and anything that isn't a letter becomes a space.
+        extern const unsigned short g_fold_[PICTO_UPPER_TABLE_SIZE];
+        
+        // Code points past the table are left as they are, and ß becomes "SS".
+        // Text is UTF-8, and bytes that aren't valid UTF-8 are kept.
+        std::wstring toupper(wchar_t in);
+        std::string toupper(std::string in);
+        std::wstring toupper(std::wstring in);
+    }
+}
+
+#endif // __PICTO_UPPER_CASE_H__
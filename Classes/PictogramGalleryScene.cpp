@@ -31,12 +31,16 @@
 #include "PictogramGalleryScene.h"
 
 #include "AppDelegate.h"
-#include "NavigationBar.h"
+#include "PictoChrome.h"
 #include "PictoDatabase.h"
 #include "PictogramGridScene.h"
 #include "PictogramNode.h"
 #include "PictogramScene.h"
 #include "PictoDefs.h"
+#include "PictoGridLayout.h"
+#include "PictoSettings.h"
+#include "PictoTextureCache.h"
+#include "PictoTheme.h"
 
 USING_NS_CC;
 
@@ -65,7 +69,6 @@ CCScene* PictogramGallery::scene(CCArray* pictograms)
 
 PictogramGallery::PictogramGallery() :
 
-back_button_(NULL),
 pictograms_(NULL),
 scene_mutex_(false),
 scroll_view_(NULL) {
@@ -78,12 +81,11 @@ PictogramGallery::~PictogramGallery() {
     CC_SAFE_RELEASE_NULL(pictograms_);
     removeAllChildrenWithCleanup(true);
     removeFromParentAndCleanup(true);
-    CCTextureCache::purgeSharedTextureCache();
 }
 
 bool PictogramGallery::init(CCArray* pictograms) {
     
-    ccColor4B color = picto::conversions::int2color4B(CCUserDefault::sharedUserDefault()->getIntegerForKey("color_theme", DEFAULT_COLOR_THEME));
+    ccColor4B color = picto::conversions::int2color4B(PictoSettings::sharedSettings()->getInteger("color_theme", DEFAULT_COLOR_THEME));
     
     //////////////////////////////
     // 1. super init first
@@ -91,8 +93,7 @@ bool PictogramGallery::init(CCArray* pictograms) {
         return false;
     }
     
-    CCTextureCache::sharedTextureCache()->removeUnusedTextures();
-    CCTextureCache::sharedTextureCache()->purgeSharedTextureCache();
+    PictoTextureCache::trim();
     
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
     setKeypadEnabled(true);
@@ -101,26 +102,10 @@ bool PictogramGallery::init(CCArray* pictograms) {
     pictograms_ = pictograms;
     CC_SAFE_RETAIN(pictograms_);
     
-    // Compute some UI parameters
-    CCSize visible_size = CCDirector::sharedDirector()->getVisibleSize();
-    CCPoint visible_origin = CCDirector::sharedDirector()->getVisibleOrigin();
-    
-    // Add bottom bar
-    CCSize bottom_bar_size(visible_size.width, 0.2*MIN(visible_size.width, visible_size.height));
-    if (pictograms_->count() > 1) {
-        initBottomBar(bottom_bar_size, visible_origin);
-    } else {
-        bottom_bar_size.height = 0;
-    }
-    
-    // Add top bar
-    CCSize top_bar_size(visible_size.width, 0.1*MIN(visible_size.width, visible_size.height));
-    CCPoint top_bar_origin = ccp(visible_origin.x, visible_origin.y + visible_size.height - top_bar_size.height);
-    initTopBar(top_bar_size, top_bar_origin);
-    
-    // Add gallery content
-    CCSize content_size(visible_size.width, visible_size.height - bottom_bar_size.height - top_bar_size.height);
-    CCPoint content_origin = ccp(visible_origin.x, bottom_bar_size.height);
+    // Add gallery content, the bars are drawn by the chrome
+    CCSize content_size;
+    CCPoint content_origin;
+    PictoChrome::contentArea(pictograms_->count() > 1, content_size, content_origin);
     initContent(content_size, content_origin);
     
     setTouchEnabled(true);
@@ -128,101 +113,38 @@ bool PictogramGallery::init(CCArray* pictograms) {
     return true;
 }
 
-void PictogramGallery::initBottomBar(const cocos2d::CCSize& size,
-                                     const cocos2d::CCPoint& origin) {
-    
-    CCSprite* normal = CCSprite::create("back_button_background_normal.png");
-    CCSprite* normal_overlay = CCSprite::create("back_button_normal.png");
-    normal_overlay->setAnchorPoint(ccp(0.5, 0.5));
-    normal_overlay->setPosition(ccp(0.5*normal->getContentSize().width,
-                                    0.5*normal->getContentSize().height));
-    normal->addChild(normal_overlay);
-    
-    CCSprite* selected = CCSprite::create("back_button_background_pressed.png");
-    selected->setPosition(ccp(0.5*(normal->getContentSize().width - selected->getContentSize().width),
-                              0.5*(normal->getContentSize().height - selected->getContentSize().height)));
-    selected->setOpacity(160);
-    CCSprite* selected_overlay = CCSprite::create("back_button_pressed.png");
-    selected_overlay->setAnchorPoint(ccp(0.5, 0.5));
-    selected_overlay->setPosition(ccp(0.5*selected->getContentSize().width,
-                                      0.5*selected->getContentSize().height));
-    selected->addChild(selected_overlay);
-    
-    back_button_ = CCMenuItemSprite::create(normal,
-                                            selected,
-                                            this,
-                                            menu_selector(PictogramGallery::backPressed));
-    back_button_->setAnchorPoint(ccp(0.5, 0.5));
-    back_button_->setContentSize(normal->getContentSize());
-    back_button_->setPosition(ccp(0.5*size.width, 0.5*size.height));
-    
-    CCMenu* menu = CCMenu::create(back_button_, NULL);
-    menu->setPosition(origin);
-    addChild(menu);
-}
-
-void PictogramGallery::initTopBar(const cocos2d::CCSize& size,
-                                  const cocos2d::CCPoint& origin) {
-    
-    NavigationBar* navigation_bar = NavigationBar::create(size, pictograms_);
-    navigation_bar->setPosition(origin);
-    addChild(navigation_bar);
-}
-
 void PictogramGallery::initContent(const cocos2d::CCSize& size,
                                    const cocos2d::CCPoint& origin) {
     scroll_view_ = CCLayer::create();
+    scroll_view_->setContentSize(size);
     scroll_view_->setPosition(origin);
     addChild(scroll_view_);
+}
+
+void PictogramGallery::buildCells() {
     
-    CCString* parent_pictogram = dynamic_cast<CCString*>(pictograms_->objectAtIndex(pictograms_->count() - 2));
+    const char* parent_pictogram = dynamic_cast<CCString*>(pictograms_->objectAtIndex(pictograms_->count() - 2))->getCString();
+    const char* current_pictogram = dynamic_cast<CCString*>(pictograms_->lastObject())->getCString();
     
     // Get siblings
-    CCArray* siblings = picto::database::childs(parent_pictogram->getCString());
-    
-    PictogramObject* left_sibling = NULL;
-    PictogramObject* right_sibling = NULL;
-    PictogramObject* pictogram = NULL;
-    
-    for (int i=0; i < siblings->count(); i++) {
-        PictogramObject* sibling = dynamic_cast<PictogramObject*>(siblings->objectAtIndex(i));
-        if (strcmp(sibling->getIdentifier()->getCString(),
-                   ((CCString*)pictograms_->lastObject())->getCString()) == 0) {
-            pictogram = sibling;
-            right_sibling = dynamic_cast<PictogramObject*>(siblings->objectAtIndex((i + 1) % siblings->count()));
-            left_sibling = dynamic_cast<PictogramObject*>(siblings->objectAtIndex((i - 1 + siblings->count()) % siblings->count()));
-            break;
-        }
+    PictogramObject* pictogram = picto::database::sibling(parent_pictogram, current_pictogram, 0);
+    PictogramObject* left_sibling = picto::database::sibling(parent_pictogram, current_pictogram, -1);
+    PictogramObject* right_sibling = picto::database::sibling(parent_pictogram, current_pictogram, 1);
+    
+    // Compute pages for the pictogram and its siblings
+    CCSize size = scroll_view_->getContentSize();
+    PictoGridLayout::Rect viewport = { 0, 0, size.width, size.height };
+    std::vector<PictoGridLayout::Rect> rects;
+    PictoGridLayout::pages(-1, 3, viewport, PictoGridLayout::defaultStyle(viewport), rects);
+    
+    PictogramObject* pages[] = { left_sibling, pictogram, right_sibling };
+    for (int i=0; i < 3; i++) {
+        const PictoGridLayout::Rect& rect = rects[i];
+        PictogramNode* pictogram_node = PictogramNode::dequeue(pages[i], CCSizeMake(rect.width, rect.height));
+        pictogram_node->ignoreTouches(true);
+        pictogram_node->setPosition(rect.x + 0.5*rect.width, rect.y + 0.5*rect.height);
+        scroll_view_->addChild(pictogram_node);
     }
-    
-    // Compute node visible size
-    float margin = 0.02*MAX(size.width, size.height);
-    float ratio = 1;
-    
-    CCPoint center = ccp(0.5*size.width, 0.5*size.height);
-    
-    CCSize node_size(size.width - 2*margin, size.height - 2*margin);
-    
-    node_size.height = MIN(node_size.height, node_size.width * ratio);
-    node_size.width = node_size.height / ratio;
-    
-    // Central node
-    PictogramNode* pictogram_node = PictogramNode::create(pictogram, node_size);
-    pictogram_node->ignoreTouches(true);
-    pictogram_node->setPosition(center.x, center.y);
-    scroll_view_->addChild(pictogram_node);
-    
-    // Left sibling
-    pictogram_node = PictogramNode::create(left_sibling, node_size);
-    pictogram_node->ignoreTouches(true);
-    pictogram_node->setPosition(center.x - size.width, center.y);
-    scroll_view_->addChild(pictogram_node);
-    
-    // Right sibling
-    pictogram_node = PictogramNode::create(right_sibling, node_size);
-    pictogram_node->ignoreTouches(true);
-    pictogram_node->setPosition(center.x + size.width, center.y);
-    scroll_view_->addChild(pictogram_node);
 }
 
 void PictogramGallery::keyBackClicked() {
@@ -232,27 +154,37 @@ void PictogramGallery::keyBackClicked() {
 }
 
 void PictogramGallery::onEnter() {
+    
+    // From the pool the leaving scene just filled
+    buildCells();
+    
     CCLayerColor::onEnter();
     
     setTouchEnabled(true);
     setTouchPriority(2);
     CCDirector::sharedDirector()->getTouchDispatcher()->addTargetedDelegate(this, 1, true);
     
-    setColor(picto::resources::backgroundColor());
+    themeChanged(NULL);
+    PictoTheme::subscribe(this, callfuncO_selector(PictogramGallery::themeChanged));
     
-    if (back_button_) {
-        back_button_->setColor(picto::resources::navigationBarBackgroundColor());
-    }
+    CCObject* back_target = pictograms_->count() > 1? this : NULL;
+    PictoChrome::sharedChrome()->show(pictograms_, back_target, menu_selector(PictogramGallery::backPressed));
 }
 
 void PictogramGallery::onExit() {
+    PictoTheme::unsubscribe(this);
     CCLayerColor::onExit();
+    PictogramNode::recycleChildren(scroll_view_);
     
     setTouchEnabled(false);
     CCDirector::sharedDirector()->getTouchDispatcher()->removeDelegate(this);
     scene_mutex_ = false;
 }
 
+void PictogramGallery::themeChanged(CCObject* theme) {
+    setColor(picto::resources::backgroundColor());
+}
+
 void PictogramGallery::backPressed(CCObject* sender) {
     CCArray* pictograms = CCArray::createWithArray(pictograms_);
     pictograms->removeLastObject();
@@ -290,25 +222,18 @@ void PictogramGallery::ccTouchEnded(CCTouch *touch, CCEvent *event) {
     if (fabsf(dx) < 0.5*visible_size.width) {
         scroll_view_->setPosition(ccp(0, scroll_view_->getPositionY()));
     } else {
-        CCString* left_sibling = NULL;
-        CCString* right_sibling = NULL;
-        
-        CCString* parent_pictogram = dynamic_cast<CCString*>(pictograms_->objectAtIndex(pictograms_->count() - 2));
+        const char* parent_pictogram = dynamic_cast<CCString*>(pictograms_->objectAtIndex(pictograms_->count() - 2))->getCString();
+        const char* current_pictogram = dynamic_cast<CCString*>(pictograms_->lastObject())->getCString();
         
-        // Get siblings
-        CCArray* siblings = picto::database::childs(parent_pictogram->getCString());
-        for (int i=0; i < siblings->count(); i++) {
-            PictogramObject* sibling = dynamic_cast<PictogramObject*>(siblings->objectAtIndex(i));
-            if (strcmp(sibling->getIdentifier()->getCString(),
-                       ((CCString*)pictograms_->lastObject())->getCString()) == 0) {
-                right_sibling = dynamic_cast<PictogramObject*>(siblings->objectAtIndex((i + 1) % siblings->count()))->getIdentifier();
-                left_sibling = dynamic_cast<PictogramObject*>(siblings->objectAtIndex((i - 1 + siblings->count()) % siblings->count()))->getIdentifier();
-                break;
-            }
+        // Get sibling
+        PictogramObject* sibling = picto::database::sibling(parent_pictogram, current_pictogram, (dx < 0)? 1 : -1);
+        if (sibling == NULL) {
+            scroll_view_->setPosition(ccp(0, scroll_view_->getPositionY()));
+            return;
         }
         
         pictograms_->removeLastObject();
-        pictograms_->addObject((dx < 0)? right_sibling : left_sibling);
+        pictograms_->addObject(sibling->getIdentifier());
         scroll_view_->setPosition(ccp((dx < 0)? visible_size.width : -visible_size.width, getPositionY()));
         CCDirector::sharedDirector()->replaceScene(PictogramGallery::scene(pictograms_));
     }
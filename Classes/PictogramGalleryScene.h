@@ -48,12 +48,13 @@ public: // constructors and creators
 private: // init methods
     
     bool init(cocos2d::CCArray* pictograms);
-    void initBottomBar(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
     void initContent(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
-    void initTopBar(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
     
 private: // private methods
     
+    // Cells are taken from the pool on enter and given back on exit
+    void buildCells();
+    
     void backPressed(cocos2d::CCObject* sender);
     bool ccTouchBegan(cocos2d::CCTouch *touch, cocos2d::CCEvent *event);
     void ccTouchMoved(cocos2d::CCTouch *touch, cocos2d::CCEvent *event);
@@ -61,12 +62,12 @@ private: // private methods
     void keyBackClicked();
     void onEnter();
     void onExit();
+    void themeChanged(cocos2d::CCObject* theme);
     
 private: // private variables
     
     bool scene_mutex_;
     
-    cocos2d::CCMenuItem* back_button_;
     cocos2d::CCArray* pictograms_;
     cocos2d::CCLayer* scroll_view_;
     
@@ -31,15 +31,49 @@
 #include "PictogramGridScene.h"
 
 #include "AppDelegate.h"
-#include "NavigationBar.h"
+#include "PictoCardCache.h"
+#include "PictoChrome.h"
 #include "PictoDatabase.h"
+#include "PictoDecoder.h"
 #include "PictogramGalleryScene.h"
 #include "PictogramNode.h"
 #include "PictogramScene.h"
 #include "PictoDefs.h"
+#include "PictoGridLayout.h"
+#include "PictoPrefetcher.h"
+#include "PictoSettings.h"
+#include "PictoTextureCache.h"
+#include "PictoTheme.h"
+
+#include <algorithm>
+#include <set>
 
 USING_NS_CC;
 
+// Categories whose cells would be smaller than this fraction of the shorter
+// side of the grid are split in pages
+#define PICTO_GRID_MIN_CELL_SIZE 0.25
+
+// Fraction of the grid height left below the pages for the page number
+#define PICTO_GRID_PAGE_LABEL_SIZE 0.08
+
+// Drags shorter than this fraction of the grid width are taps
+#define PICTO_GRID_TAP_DISTANCE 0.02
+
+// Time of the last tap leading to another grid, to log how long it takes
+// until the grid is drawn
+static struct cc_timeval g_tap_time_;
+static bool g_tap_pending_ = false;
+
+static void tapped() {
+    CCTime::gettimeofdayCocos2d(&g_tap_time_, NULL);
+    g_tap_pending_ = true;
+    
+    // Count the labels rasterized for the new grid only
+    PictoLabel::rasterizeTime(NULL);
+    PictoDecoder::sharedDecoder()->rasterizeTime(NULL);
+}
+
 CCScene* PictogramGrid::scene(CCArray* pictograms)
 {
     // 'scene' is an autorelease object
@@ -65,9 +99,15 @@ CCScene* PictogramGrid::scene(CCArray* pictograms)
 
 PictogramGrid::PictogramGrid() :
 
-back_button_(NULL),
+scene_mutex_(false),
 pictograms_(NULL),
-scene_mutex_(false) {
+childs_(NULL),
+pages_layer_(NULL),
+page_label_(NULL),
+page_nodes_(NULL),
+page_batches_(NULL),
+page_(0),
+num_pages_(0) {
     
 }
 
@@ -75,14 +115,16 @@ PictogramGrid::~PictogramGrid() {
     CCLOG("PictogramGrid::~PictogramGrid()");
     
     CC_SAFE_RELEASE_NULL(pictograms_);
+    CC_SAFE_RELEASE_NULL(childs_);
+    CC_SAFE_RELEASE_NULL(page_nodes_);
+    CC_SAFE_RELEASE_NULL(page_batches_);
     removeAllChildrenWithCleanup(true);
     removeFromParentAndCleanup(true);
-    CCTextureCache::purgeSharedTextureCache();
 }
 
 bool PictogramGrid::init(CCArray* pictograms) {
     
-    ccColor4B color = picto::conversions::int2color4B(CCUserDefault::sharedUserDefault()->getIntegerForKey("color_theme", DEFAULT_COLOR_THEME));
+    ccColor4B color = picto::conversions::int2color4B(PictoSettings::sharedSettings()->getInteger("color_theme", DEFAULT_COLOR_THEME));
     
     //////////////////////////////
     // 1. super init first
@@ -90,8 +132,7 @@ bool PictogramGrid::init(CCArray* pictograms) {
         return false;
     }
     
-    CCTextureCache::sharedTextureCache()->removeUnusedTextures();
-    CCTextureCache::sharedTextureCache()->purgeSharedTextureCache();
+    PictoTextureCache::trim();
     
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
     setKeypadEnabled(true);
@@ -101,199 +142,446 @@ bool PictogramGrid::init(CCArray* pictograms) {
     CC_SAFE_RETAIN(pictograms_);
     
     // Get pictograms childs from database
-    CCArray* childs = picto::database::childs(((CCString*)pictograms->lastObject())->getCString());
+    const char* category = ((CCString*)pictograms->lastObject())->getCString();
+    CCArray* childs = picto::database::childs(category);
+    PictoCardCache::loadAtlases(category);
+    PictoPrefetcher::sharedPrefetcher()->visit(category);
+    
+    childs_ = childs;
+    CC_SAFE_RETAIN(childs_);
+    
+    // Add grid, the bars are drawn by the chrome
+    CCSize grid_size;
+    CCPoint grid_origin;
+    PictoChrome::contentArea(pictograms_->count() > 1, grid_size, grid_origin);
+    initGridOfPictograms(grid_size, grid_origin, childs);
     
-    // Compute some UI parameters
-    CCSize visible_size = CCDirector::sharedDirector()->getVisibleSize();
-    CCPoint visible_origin = CCDirector::sharedDirector()->getVisibleOrigin();
+    return true;
+}
+
+void PictogramGrid::initGridOfPictograms(const cocos2d::CCSize& size,
+                                         const cocos2d::CCPoint& origin,
+                                         cocos2d::CCArray* childs) {
     
-    // Add bottom bar
-    CCSize bottom_bar_size(visible_size.width, 0.2*MIN(visible_size.width, visible_size.height));
-    if (pictograms_->count() > 1) {
-        initBottomBar(bottom_bar_size, visible_origin);
-    } else {
-        bottom_bar_size.height = 0;
+    // Compute arrangement for pictograms
+    PictoGridLayout::Rect viewport = { origin.x, origin.y, size.width, size.height };
+    PictoGridLayout::arrange(childs->count(), viewport, PictoGridLayout::defaultStyle(viewport), rects_);
+    
+    // Split big categories in pages instead of shrinking their cells
+    if (!rects_.empty() && isPaged(rects_[0], size)) {
+        rects_.clear();
+        initPagesOfPictograms(size, origin, childs);
     }
+}
+
+void PictogramGrid::initPagesOfPictograms(const cocos2d::CCSize& size,
+                                          const cocos2d::CCPoint& origin,
+                                          cocos2d::CCArray* childs) {
     
-    // Add top bar
-    CCSize top_bar_size(visible_size.width, 0.1*MIN(visible_size.width, visible_size.height));
-    CCPoint top_bar_origin = ccp(visible_origin.x, visible_origin.y + visible_size.height - top_bar_size.height);
-    initTopBar(top_bar_size, top_bar_origin);
+    page_nodes_ = CCDictionary::create();
+    CC_SAFE_RETAIN(page_nodes_);
+    page_batches_ = CCDictionary::create();
+    CC_SAFE_RETAIN(page_batches_);
     
-    // Add grid
-    CCSize grid_size(visible_size.width, visible_size.height - bottom_bar_size.height - top_bar_size.height);
-    CCPoint grid_origin = ccp(visible_origin.x, bottom_bar_size.height);
-    initGridOfPictograms(grid_size, grid_origin, childs);
+    // Compute the arrangement shared by all pages
+    pageLayout(size, origin, page_grid_, page_viewport_, page_style_);
+    float label_height = PICTO_GRID_PAGE_LABEL_SIZE*size.height;
     
-    return true;
+    int page_size = page_grid_.rows*page_grid_.cols;
+    num_pages_ = (childs_->count() + page_size - 1) / page_size;
+    
+    pages_layer_ = CCLayer::create();
+    addChild(pages_layer_, 1);
+    
+    page_label_ = picto::cocos2d_utils::createLabelAsync("", 0.6*label_height);
+    page_label_->setAnchorPoint(ccp(0.5, 0.5));
+    page_label_->setPosition(ccp(origin.x + 0.5*size.width, origin.y + 0.5*label_height));
+    addChild(page_label_);
+}
+
+bool PictogramGrid::isPaged(const PictoGridLayout::Rect& cell, const CCSize& size) {
+    
+    return MIN(cell.width, cell.height) < PICTO_GRID_MIN_CELL_SIZE*MIN(size.width, size.height);
 }
 
-void PictogramGrid::initBottomBar(const cocos2d::CCSize& size,
-                                  const cocos2d::CCPoint& origin) {
-    
-    CCSprite* normal = CCSprite::create("back_button_background_normal.png");
-    CCSprite* normal_overlay = CCSprite::create("back_button_normal.png");
-    normal_overlay->setAnchorPoint(ccp(0.5, 0.5));
-    normal_overlay->setPosition(ccp(0.5*normal->getContentSize().width,
-                                    0.5*normal->getContentSize().height));
-    normal->addChild(normal_overlay);
-    
-    CCSprite* selected = CCSprite::create("back_button_background_pressed.png");
-    selected->setPosition(ccp(0.5*(normal->getContentSize().width - selected->getContentSize().width),
-                              0.5*(normal->getContentSize().height - selected->getContentSize().height)));
-    selected->setOpacity(160);
-    CCSprite* selected_overlay = CCSprite::create("back_button_pressed.png");
-    selected_overlay->setAnchorPoint(ccp(0.5, 0.5));
-    selected_overlay->setPosition(ccp(0.5*selected->getContentSize().width,
-                                      0.5*selected->getContentSize().height));
-    selected->addChild(selected_overlay);
-    
-    back_button_ = CCMenuItemSprite::create(normal,
-                                            selected,
-                                            this,
-                                            menu_selector(PictogramGrid::backPressed));
-    back_button_->setAnchorPoint(ccp(0.5, 0.5));
-    back_button_->setContentSize(normal->getContentSize());
-    back_button_->setPosition(ccp(0.5*size.width, 0.5*size.height));
-    
-    CCMenu* menu = CCMenu::create(back_button_, NULL);
-    menu->setPosition(origin);
-    addChild(menu);
+void PictogramGrid::pageLayout(const CCSize& size,
+                               const CCPoint& origin,
+                               PictoGridLayout::Grid& grid,
+                               PictoGridLayout::Rect& viewport,
+                               PictoGridLayout::Style& style) {
+    
+    // Pages leave room below them for the page number
+    float label_height = PICTO_GRID_PAGE_LABEL_SIZE*size.height;
+    PictoGridLayout::Rect page_viewport = { origin.x, origin.y + label_height, size.width, size.height - label_height };
+    viewport = page_viewport;
+    style = PictoGridLayout::defaultStyle(viewport);
+    
+    float min_cell_size = PICTO_GRID_MIN_CELL_SIZE*MIN(size.width, size.height);
+    float margin = style.margin;
+    grid.cols = MAX(1, (int)((viewport.width - margin) / (min_cell_size + margin)));
+    grid.rows = MAX(1, (int)((viewport.height - margin) / (min_cell_size*style.node_ratio + margin)));
+}
+
+CCSize PictogramGrid::cardSize(size_t count, bool bottom_bar, size_t* cards_in_view) {
+    
+    CCSize size;
+    CCPoint origin;
+    PictoChrome::contentArea(bottom_bar, size, origin);
+    
+    PictoGridLayout::Rect viewport = { origin.x, origin.y, size.width, size.height };
+    std::vector<PictoGridLayout::Rect> rects;
+    PictoGridLayout::arrange(count, viewport, PictoGridLayout::defaultStyle(viewport), rects);
+    
+    *cards_in_view = count;
+    if (rects.empty())
+        return CCSizeZero;
+    if (!isPaged(rects[0], size))
+        return CCSizeMake(rects[0].width, rects[0].height);
+    
+    PictoGridLayout::Grid grid;
+    PictoGridLayout::Style style;
+    pageLayout(size, origin, grid, viewport, style);
+    *cards_in_view = MIN(count, (size_t)(grid.rows*grid.cols));
+    
+    rects.clear();
+    PictoGridLayout::arrange(*cards_in_view, grid, viewport, style, rects);
+    return CCSizeMake(rects[0].width, rects[0].height);
+}
+
+void PictogramGrid::keyBackClicked() {
+    /* TODO if (root_scene_flag_)
+     CCDirector::sharedDirector()->end();
+     else
+     CCDirector::sharedDirector()->popScene();*/
 }
 
-void PictogramGrid::initTopBar(const cocos2d::CCSize& size,
-                               const cocos2d::CCPoint& origin) {
+void PictogramGrid::onEnter() {
+    
+    // Before the cells enter, so they come with the sheets of the current
+    // theme and from the pool the leaving scene just filled
+    buildCells();
+    
+    CCLayerColor::onEnter();
+    themeChanged(NULL);
+    PictoTheme::subscribe(this, callfuncO_selector(PictogramGrid::themeChanged));
     
-    NavigationBar* navigation_bar = NavigationBar::create(size, pictograms_);
-    navigation_bar->setPosition(origin);
-    addChild(navigation_bar);
+    CCObject* back_target = pictograms_->count() > 1? this : NULL;
+    PictoChrome::sharedChrome()->show(pictograms_, back_target, menu_selector(PictogramGrid::backPressed));
+    
+    // Paged grids take the touches their cells ignore
+    if (pages_layer_) {
+        CCDirector::sharedDirector()->getTouchDispatcher()->addTargetedDelegate(this, 1, true);
+    }
+    
+    // Once the grid has been drawn
+    scheduleOnce(schedule_selector(PictogramGrid::entered), 0);
 }
 
-CCSize computeOptimumGrid(const int num_elements, const cocos2d::CCSize gridSize, const float nodeRatio, const float margin) {
+void PictogramGrid::onExit() {
+    PictoTheme::unsubscribe(this);
+    CCLayerColor::onExit();
+    recycleCells();
     
-    CCSize bestGrid(1, num_elements);
-    float maxArea = 0;
-    float maxCompactness = 0;
+    if (pages_layer_) {
+        CCDirector::sharedDirector()->getTouchDispatcher()->removeDelegate(this);
+    }
+    scene_mutex_ = false;
     
-    for (int i=1; i <= num_elements; i++) {
-        
-        float maxHeight = (gridSize.height - (i+1)*margin) / i;
-        float maxWidth = maxHeight / nodeRatio;
-        
-        if (maxHeight*maxWidth > maxArea) {
-            for (int j=num_elements; j >=1; j--) {
-                if (i*j < num_elements)
-                    break;
-                
-                float width = MIN((gridSize.width - (j+1)*margin) / j, maxWidth);
-                float height = MIN(width * nodeRatio, maxHeight);
-                float area = width*height;
-                if (area > maxArea) {
-                    
-                    maxCompactness = (float)num_elements/(float)(i*j);
-                    maxArea = area;
-                    bestGrid.height = i;
-                    bestGrid.width = j;
-                    
-                } else if (area == maxArea) {
-                    
-                    float compactness = (float)num_elements/(float)(i*j);
-                    
-                    if (compactness > maxCompactness) {
-                        maxCompactness = compactness;
-                        maxArea = area;
-                        bestGrid.height = i;
-                        bestGrid.width = j;
-                    }
-                }
-            }
-        }
+    // Whatever was prefetched for this grid is of no use anymore
+    PictoPrefetcher::sharedPrefetcher()->cancel();
+}
+
+void PictogramGrid::themeChanged(CCObject* theme) {
+    setColor(picto::resources::backgroundColor());
+    
+    if (pages_layer_) {
+        page_label_->setColor(picto::resources::menuTextColor());
     }
     
-    return bestGrid;
+    // The sheets in view were baked with the previous colors
+    if (theme) {
+        recycleCells();
+        buildCells();
+    }
 }
 
-void PictogramGrid::initGridOfPictograms(const cocos2d::CCSize& size,
-                                         const cocos2d::CCPoint& origin,
-                                         cocos2d::CCArray* childs) {
+void PictogramGrid::buildCells() {
     
-    // Compute node visible size
-    float margin = 0.02*MAX(size.width, size.height);
-    float ratio = 1;
+    if (pages_layer_) {
+        showPage(page_);
+        return;
+    }
     
-    CCSize optimumGrid = computeOptimumGrid(childs->count(), size, ratio, margin);
+    // All the cards in one texture, drawn by a single batch
+    CCArray* cards = NULL;
+    CCSpriteBatchNode* batch = NULL;
+    if (!rects_.empty()) {
+        cards = PictoCardCache::sheet(childs_, CCSizeMake(rects_[0].width, rects_[0].height));
+    }
+    if (cards) {
+        batch = CCSpriteBatchNode::createWithTexture(dynamic_cast<CCSpriteFrame*>(cards->objectAtIndex(0))->getTexture(), cards->count());
+        addChild(batch, 1);
+    }
     
-    // Compute arrangement for pictograms
-    int cols = optimumGrid.width;
-    int rows = optimumGrid.height;
+    for (size_t n=0; n < rects_.size(); n++) {
+        const PictoGridLayout::Rect& rect = rects_[n];
+        PictogramObject *object = dynamic_cast<PictogramObject*>(childs_->objectAtIndex(n));
+        CCSpriteFrame* card = cards? dynamic_cast<CCSpriteFrame*>(cards->objectAtIndex(n)) : NULL;
+        PictogramNode *node = PictogramNode::dequeue(object, CCSizeMake(rect.width, rect.height), card);
+        node->setTarget(this, menu_selector(PictogramGrid::pictogramPressed));
+        node->setPosition(rect.x + 0.5*rect.width, rect.y + 0.5*rect.height);
+        addChild(node, 2);
+        if (batch)
+            node->attachCard(batch);
+    }
+}
+
+void PictogramGrid::recycleCells() {
     
-    CCPoint center = ccp(origin.x + 0.5*size.width, origin.y + 0.5*size.height);
+    if (pages_layer_) {
+        CCArray* pages = page_nodes_->allKeys();
+        CCObject* it;
+        CCARRAY_FOREACH(pages, it) {
+            recyclePage(dynamic_cast<CCInteger*>(it)->getValue());
+        }
+    } else {
+        PictogramNode::recycleChildren(this);
+        removeAllChildrenWithCleanup(true);
+    }
+}
+
+void PictogramGrid::entered(float dt) {
     
-    CCSize nodeSize;
-    nodeSize.width = (size.width - (cols + 1)*margin) / cols;
-    nodeSize.height = (size.height - (rows + 1)*margin) / rows;
+    if (g_tap_pending_) {
+        struct cc_timeval now;
+        CCTime::gettimeofdayCocos2d(&now, NULL);
+        CCLOG("PictogramGrid: tap to grid %.1f ms", CCTime::timersubCocos2d(&g_tap_time_, &now));
+        
+        int labels, async_labels;
+        float label_ms = PictoLabel::rasterizeTime(&labels);
+        float async_ms = PictoDecoder::sharedDecoder()->rasterizeTime(&async_labels);
+        CCLOG("PictogramGrid: %d labels rasterized in %.1f ms, %d asynchronously in %.1f ms",
+              labels, label_ms, async_labels, async_ms);
+        g_tap_pending_ = false;
+    }
     
-    nodeSize.height = MIN(nodeSize.height, nodeSize.width * ratio);
-    nodeSize.width = nodeSize.height / ratio;
+    prefetchChildren();
+}
+
+void PictogramGrid::prefetchChildren() {
     
-    CCSize step = CCSizeMake(nodeSize.width + margin, nodeSize.height + margin);
+    PictoPrefetcher* prefetcher = PictoPrefetcher::sharedPrefetcher();
     
-    CCPoint topLeftNodePos = center;
-    topLeftNodePos.y +=  + (rows - 1)*step.height; // Start from top
-    if (rows % 2 == 0)
-        topLeftNodePos.y += (0.5 - (rows / 2))*step.height;
-    else
-        topLeftNodePos.y -= ((rows - 1) / 2)*step.height;
-    if (cols % 2 == 0)
-        topLeftNodePos.x += (0.5 - (cols / 2))*step.width;
-    else
-        topLeftNodePos.x -= ((cols - 1) / 2)*step.width;
+    // The cells in view, the whole grid or the current page
+    int first = 0;
+    int count = childs_->count();
+    if (pages_layer_) {
+        int page_size = page_grid_.rows*page_grid_.cols;
+        first = page_*page_size;
+        count = MIN(page_size, count - first);
+    }
+    
+    // Most visited categories first, then in reading order
+    std::vector<std::pair<float, int> > ranked;
+    for (int i=first; i < first + count; i++) {
+        PictogramObject* object = dynamic_cast<PictogramObject*>(childs_->objectAtIndex(i));
+        ranked.push_back(std::make_pair(1000.0f*prefetcher->visits(object->getIdentifier()->getCString()) - (i - first), i));
+    }
+    std::sort(ranked.rbegin(), ranked.rend());
+    
+    // The root grid lives in the root shard, and every category it shows is
+    // the root of a shard of its own. Loading the shards of the likeliest
+    // ones evicts no shard in use, as long as they all fit in memory
+    std::set<int> loadable;
+    if (strcmp(((CCString*)pictograms_->lastObject())->getCString(), ROOT_PICTOGRAM) == 0) {
+        for (size_t n=0; n < ranked.size() && n < PICTO_CATALOG_MAX_SHARDS; n++)
+            loadable.insert(ranked[n].second);
+    }
     
-    for (int i=0, n=0; i < rows; i++) {
+    for (size_t r=0; r < ranked.size(); r++) {
+        float priority = ranked[r].first;
+        int i = ranked[r].second;
+        PictogramObject* object = dynamic_cast<PictogramObject*>(childs_->objectAtIndex(i));
+        const char* identifier = object->getIdentifier()->getCString();
         
-        CCPoint leftNodePos = topLeftNodePos;
-        leftNodePos.y -= i*step.height; // Start from top
-        int icols = MIN(cols, childs->count() - n);
-        if (icols != cols) {
-            if (icols % 2 == 0)
-                leftNodePos.x = center.x + (0.5 - (icols / 2))*step.width;
-            else
-                leftNodePos.x = center.x - ((icols - 1) / 2)*step.width;
+        // Elsewhere only categories whose shard is in memory, loading one
+        // here would evict the shard of this grid
+        CCArray* childs = loadable.count(i)? picto::database::childs(identifier) : picto::database::loadedChilds(identifier);
+        if (childs == NULL || childs->count() == 0)
+            continue;
+        
+        // Cards of the first view of the grid the category would open
+        size_t cards_in_view;
+        CCSize card_size = cardSize(childs->count(), true, &cards_in_view);
+        CCArray* cards = CCArray::createWithCapacity(cards_in_view);
+        for (size_t n=0; n < cards_in_view; n++) {
+            cards->addObject(childs->objectAtIndex(n));
         }
-        for (int j=0; j < icols; j++, n++) {
-            PictogramObject *object = dynamic_cast<PictogramObject*>(childs->objectAtIndex(n));
-            PictogramNode *node = PictogramNode::create(object, nodeSize);
-            node->setTarget(this, menu_selector(PictogramGrid::pictogramPressed));
-            node->setPosition(leftNodePos.x + j*step.width, leftNodePos.y);
-            addChild(node, 1);
+        
+        std::vector<PictoCardCache::Source> sources;
+        PictoCardCache::sources(identifier, cards, card_size, sources);
+        
+        for (size_t n=0; n < sources.size(); n++) {
+            if (!prefetcher->prefetch(sources[n].path, priority, sources[n].bytes))
+                return;
         }
     }
 }
 
-void PictogramGrid::keyBackClicked() {
-    /* TODO if (root_scene_flag_)
-     CCDirector::sharedDirector()->end();
-     else
-     CCDirector::sharedDirector()->popScene();*/
+void PictogramGrid::showPage(int page) {
+    
+    page_ = page;
+    
+    // Recycle the cells of the pages out of the lookahead first, so the new
+    // pages can reuse them
+    CCArray* pages = page_nodes_->allKeys();
+    CCObject* it;
+    CCARRAY_FOREACH(pages, it) {
+        int built_page = dynamic_cast<CCInteger*>(it)->getValue();
+        if (built_page < page - 1 || built_page > page + 1)
+            recyclePage(built_page);
+    }
+    
+    for (int i=MAX(0, page - 1); i <= MIN(num_pages_ - 1, page + 1); i++) {
+        if (!page_nodes_->objectForKey(i))
+            buildPage(i);
+    }
+    
+    // Rebound cells leave the images of their old pictograms unused, keep the
+    // cache within budget
+    PictoTextureCache::trim();
+    
+    page_label_->setString(CCString::createWithFormat("%d / %d", page + 1, num_pages_)->getCString());
+    
+    if (isRunning()) {
+        prefetchChildren();
+    }
 }
 
-void PictogramGrid::onEnter() {
-    CCLayerColor::onEnter();
-    setColor(picto::resources::backgroundColor());
+void PictogramGrid::buildPage(int page) {
     
-    if (back_button_) {
-        back_button_->setColor(picto::resources::navigationBarBackgroundColor());
+    int page_size = page_grid_.rows*page_grid_.cols;
+    int first = page*page_size;
+    int count = MIN(page_size, (int)childs_->count() - first);
+    
+    PictoGridLayout::Rect viewport = page_viewport_;
+    viewport.x += page*page_viewport_.width;
+    std::vector<PictoGridLayout::Rect> rects;
+    PictoGridLayout::arrange(count, page_grid_, viewport, page_style_, rects);
+    
+    // The cards of the page in one texture, drawn by a single batch
+    CCArray* objects = CCArray::createWithCapacity(count);
+    for (int n=0; n < count; n++) {
+        objects->addObject(childs_->objectAtIndex(first + n));
+    }
+    CCArray* cards = count > 0? PictoCardCache::sheet(objects, CCSizeMake(rects[0].width, rects[0].height)) : NULL;
+    CCSpriteBatchNode* batch = NULL;
+    if (cards) {
+        batch = CCSpriteBatchNode::createWithTexture(dynamic_cast<CCSpriteFrame*>(cards->objectAtIndex(0))->getTexture(), count);
+        pages_layer_->addChild(batch, 0);
+        page_batches_->setObject(batch, page);
+    }
+    
+    CCArray* nodes = CCArray::createWithCapacity(count);
+    for (int n=0; n < count; n++) {
+        const PictoGridLayout::Rect& rect = rects[n];
+        PictogramObject *object = dynamic_cast<PictogramObject*>(objects->objectAtIndex(n));
+        CCSpriteFrame* card = cards? dynamic_cast<CCSpriteFrame*>(cards->objectAtIndex(n)) : NULL;
+        
+        PictogramNode *node = PictogramNode::dequeue(object, CCSizeMake(rect.width, rect.height), card);
+        node->ignoreTouches(true);
+        nodes->addObject(node);
+        node->setPosition(rect.x + 0.5*rect.width, rect.y + 0.5*rect.height);
+        pages_layer_->addChild(node, 1);
+        if (batch)
+            node->attachCard(batch);
     }
+    
+    page_nodes_->setObject(nodes, page);
 }
 
-void PictogramGrid::onExit() {
-    CCLayerColor::onExit();
-    scene_mutex_ = false;
+void PictogramGrid::recyclePage(int page) {
+    
+    CCArray* nodes = dynamic_cast<CCArray*>(page_nodes_->objectForKey(page));
+    CCObject* it;
+    CCARRAY_FOREACH(nodes, it) {
+        PictogramNode::recycle(dynamic_cast<PictogramNode*>(it));
+    }
+    page_nodes_->removeObjectForKey(page);
+    
+    CCNode* batch = dynamic_cast<CCNode*>(page_batches_->objectForKey(page));
+    if (batch) {
+        batch->removeFromParentAndCleanup(true);
+        page_batches_->removeObjectForKey(page);
+    }
+}
+
+PictogramNode* PictogramGrid::pictogramAt(const cocos2d::CCPoint& location) {
+    
+    CCPoint point = pages_layer_->convertToNodeSpace(location);
+    CCArray* nodes = dynamic_cast<CCArray*>(page_nodes_->objectForKey(page_));
+    CCObject* it;
+    CCARRAY_FOREACH(nodes, it) {
+        PictogramNode* node = dynamic_cast<PictogramNode*>(it);
+        if (node->boundingBox().containsPoint(point))
+            return node;
+    }
+    
+    return NULL;
+}
+
+bool PictogramGrid::ccTouchBegan(CCTouch *touch, CCEvent *event) {
+    
+    CCPoint touch_location = touch->getLocation();
+    
+    CCRect grid_rect(page_viewport_.x, page_viewport_.y, page_viewport_.width, page_viewport_.height);
+    if (!grid_rect.containsPoint(touch_location))
+        return false;
+    
+    touch_location_ = touch_location;
+    pages_layer_->stopAllActions();
+    
+    return true;
+}
+
+void PictogramGrid::ccTouchMoved(CCTouch *touch, CCEvent *event) {
+    
+    float dx = touch->getLocation().x - touch_location_.x;
+    pages_layer_->setPositionX(-page_*page_viewport_.width + dx);
+}
+
+void PictogramGrid::ccTouchEnded(CCTouch *touch, CCEvent *event) {
+    
+    float dx = touch->getLocation().x - touch_location_.x;
+    
+    int page = page_;
+    if (fabsf(dx) < PICTO_GRID_TAP_DISTANCE*page_viewport_.width) {
+        
+        PictogramNode* node = pictogramAt(touch->getLocation());
+        if (node) {
+            pictogramPressed(node);
+        }
+    } else if (dx < -0.25*page_viewport_.width && page_ < num_pages_ - 1) {
+        page++;
+    } else if (dx > 0.25*page_viewport_.width && page_ > 0) {
+        page--;
+    }
+    
+    if (page != page_) {
+        showPage(page);
+    }
+    pages_layer_->runAction(CCMoveTo::create(0.2, ccp(-page_*page_viewport_.width, 0)));
+}
+
+void PictogramGrid::ccTouchCancelled(CCTouch *touch, CCEvent *event) {
+    
+    pages_layer_->runAction(CCMoveTo::create(0.2, ccp(-page_*page_viewport_.width, 0)));
 }
 
 void PictogramGrid::backPressed(CCObject* sender) {
     CCArray* pictograms = CCArray::createWithArray(pictograms_);
     pictograms->removeLastObject();
+    tapped();
     CCDirector::sharedDirector()->replaceScene(PictogramGrid::scene(pictograms));
 }
 
@@ -313,6 +601,7 @@ void PictogramGrid::pictogramPressed(CCObject *sender) {
     if (picto::database::countChilds(node->getData()->getIdentifier()->getCString()) > 0) {
         CCArray* pictograms = CCArray::createWithArray(pictograms_);
         pictograms->addObject(CCString::create(node->getData()->getIdentifier()->getCString()));
+        tapped();
         CCDirector::sharedDirector()->replaceScene(PictogramGrid::scene(pictograms));
     } else {
         CCArray* pictograms = CCArray::createWithArray(pictograms_);
@@ -33,6 +33,11 @@
 
 #include "cocos2d.h"
 
+#include "PictoGridLayout.h"
+#include "PictoLabel.h"
+
+class PictogramNode;
+
 class PictogramGrid : public cocos2d::CCLayerColor
 {
     
@@ -46,14 +51,40 @@ public: // constructors and creators
 private: // init methods
     
     bool init(cocos2d::CCArray* pictograms);
-    void initBottomBar(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
-    void initTopBar(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
     void initGridOfPictograms(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin, cocos2d::CCArray* childs);
+    void initPagesOfPictograms(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin, cocos2d::CCArray* childs);
+    
+private: // layout methods
+    
+    static bool isPaged(const PictoGridLayout::Rect& cell, const cocos2d::CCSize& size);
+    static void pageLayout(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin, PictoGridLayout::Grid& grid, PictoGridLayout::Rect& viewport, PictoGridLayout::Style& style);
+    
+    // Card size of a grid of count pictograms, and how many are in view
+    static cocos2d::CCSize cardSize(size_t count, bool bottom_bar, size_t* cards_in_view);
     
 private: // private methods
     
     void onEnter();
     void onExit();
+    void themeChanged(cocos2d::CCObject* theme);
+    void entered(float dt);
+    
+    // Cells are taken from the pool on enter and given back on exit
+    void buildCells();
+    void recycleCells();
+    
+    // Starts loading the cards of the categories in view
+    void prefetchChildren();
+    
+    void showPage(int page);
+    void buildPage(int page);
+    void recyclePage(int page);
+    PictogramNode* pictogramAt(const cocos2d::CCPoint& location);
+    
+    bool ccTouchBegan(cocos2d::CCTouch *touch, cocos2d::CCEvent *event);
+    void ccTouchMoved(cocos2d::CCTouch *touch, cocos2d::CCEvent *event);
+    void ccTouchEnded(cocos2d::CCTouch *touch, cocos2d::CCEvent *event);
+    void ccTouchCancelled(cocos2d::CCTouch *touch, cocos2d::CCEvent *event);
     
     void backPressed(cocos2d::CCObject* sender);
     void keyBackClicked();
@@ -63,8 +94,24 @@ private: // private variables
     
     bool scene_mutex_;
     
-    cocos2d::CCMenuItem* back_button_;
     cocos2d::CCArray* pictograms_;
+    cocos2d::CCArray* childs_;
+    
+    // Cells of a grid that fits in one page
+    std::vector<PictoGridLayout::Rect> rects_;
+    
+    // Paged mode, for categories too big to fit cells of the minimum size
+    cocos2d::CCLayer* pages_layer_;
+    PictoLabel* page_label_;
+    cocos2d::CCDictionary* page_nodes_;
+    cocos2d::CCDictionary* page_batches_;
+    cocos2d::CCPoint touch_location_;
+    
+    int page_;
+    int num_pages_;
+    PictoGridLayout::Grid page_grid_;
+    PictoGridLayout::Rect page_viewport_;
+    PictoGridLayout::Style page_style_;
 };
 
 #endif // __PICTOGRAM_GRID_SCENE_H__
\ No newline at end of file
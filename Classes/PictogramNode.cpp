@@ -31,15 +31,30 @@
 #include "PictogramNode.h"
 
 #include "AppDelegate.h"
+#include "PictoCardCache.h"
 #include "PictoDefs.h"
+#include "PictoTheme.h"
 
 USING_NS_CC;
 
-PictogramNode* PictogramNode::create(PictogramObject* pictogram, const CCSize& size)
+// Nodes kept for reuse, by cell size
+#define PICTO_NODE_POOL_SIZE 64
+
+static CCDictionary* g_pool_ = NULL;
+static unsigned int g_pool_count_ = 0;
+
+static std::string pool_key(const CCSize& size) {
+    
+    char key[32];
+    snprintf(key, sizeof(key), "%.1fx%.1f", size.width, size.height);
+    return key;
+}
+
+PictogramNode* PictogramNode::create(PictogramObject* pictogram, const CCSize& size, CCSpriteFrame* card)
 {
     PictogramNode *node = new PictogramNode();
     
-    if (node && node->init(pictogram, size)) {
+    if (node && node->init(pictogram, size, card)) {
         node->autorelease();
         return node;
     }
@@ -49,33 +64,115 @@ PictogramNode* PictogramNode::create(PictogramObject* pictogram, const CCSize& s
     return NULL;
 }
 
+PictogramNode* PictogramNode::dequeue(PictogramObject* pictogram, const CCSize& size, CCSpriteFrame* card) {
+    
+    CCArray* nodes = g_pool_? dynamic_cast<CCArray*>(g_pool_->objectForKey(pool_key(size))) : NULL;
+    if (!nodes || nodes->count() == 0)
+        return create(pictogram, size, card);
+    
+    PictogramNode* node = dynamic_cast<PictogramNode*>(nodes->lastObject());
+    node->retain();
+    node->autorelease();
+    nodes->removeLastObject();
+    g_pool_count_--;
+    
+    node->setData(pictogram, card);
+    return node;
+}
+
+void PictogramNode::recycle(PictogramNode* node) {
+    
+    node->retain();
+    node->removeFromParentAndCleanup(true);
+    node->detachCard();
+    
+    if (g_pool_count_ < PICTO_NODE_POOL_SIZE) {
+        
+        // Back to the state of a new node. Pooled nodes don't keep their
+        // pictogram or card texture alive
+        CC_SAFE_RELEASE_NULL(node->data_);
+        node->card_->setTexture(NULL);
+        node->removeParts();
+        node->ignore_touches_ = false;
+        node->receiver_ = NULL;
+        node->selector_ = NULL;
+        node->setScale(1);
+        node->speaker_button_->setScale(1);
+        node->speaker_highlight_->setOpacity(0);
+        node->speaker_highlight_->setVisible(false);
+        
+        if (!g_pool_) {
+            g_pool_ = CCDictionary::create();
+            g_pool_->retain();
+        }
+        
+        std::string key = pool_key(node->getContentSize());
+        CCArray* nodes = dynamic_cast<CCArray*>(g_pool_->objectForKey(key));
+        if (!nodes) {
+            nodes = CCArray::create();
+            g_pool_->setObject(nodes, key);
+        }
+        nodes->addObject(node);
+        g_pool_count_++;
+    }
+    
+    node->release();
+}
+
+void PictogramNode::recycleChildren(CCNode* parent) {
+    
+    if (!parent->getChildren())
+        return;
+    
+    CCArray* children = CCArray::createWithArray(parent->getChildren());
+    CCObject* it;
+    CCARRAY_FOREACH(children, it) {
+        PictogramNode* node = dynamic_cast<PictogramNode*>(it);
+        if (node) {
+            recycle(node);
+        } else {
+            recycleChildren(dynamic_cast<CCNode*>(it));
+        }
+    }
+}
+
+void PictogramNode::purgePool() {
+    
+    CCLOG("PictogramNode::purgePool() %u nodes", g_pool_count_);
+    
+    CC_SAFE_RELEASE_NULL(g_pool_);
+    g_pool_count_ = 0;
+}
+
 PictogramNode::PictogramNode() :
 data_(NULL),
 ignore_touches_(false),
-speaker_background_(NULL),
+card_(NULL),
+card_generation_(0),
+parts_(NULL),
 speaker_button_(NULL),
-speaker_icon_(NULL),
-speaker_label_(NULL) {}
+speaker_highlight_(NULL),
+receiver_(NULL),
+selector_(NULL) {}
 
 PictogramNode::~PictogramNode() {
     
     CC_SAFE_RELEASE_NULL(data_);
+    detachCard();
     removeAllChildrenWithCleanup(true);
     removeFromParentAndCleanup(true);
-    CCTextureCache::purgeSharedTextureCache();
 }
 
-bool PictogramNode::init(PictogramObject* pictogram, const CCSize& size) {
+bool PictogramNode::init(PictogramObject* pictogram, const CCSize& size, CCSpriteFrame* card) {
     
     //////////////////////////////
     // 1. super init first
     
-    if ( !CCLayerColor::initWithColor(ccc4(255, 255, 255, 0), size.width, size.height) ) {
+    if ( !CCLayer::init() ) {
         return false;
     }
     
-    CCTextureCache::sharedTextureCache()->removeUnusedTextures();
-    CCTextureCache::sharedTextureCache()->purgeSharedTextureCache();
+    setContentSize(size);
     
     data_ = pictogram;
     CC_SAFE_RETAIN(data_);
@@ -83,71 +180,117 @@ bool PictogramNode::init(PictogramObject* pictogram, const CCSize& size) {
     ignoreAnchorPointForPosition(false);
     setTouchEnabled(true);
     
-    // Background
-    CCSprite* background = CCSprite::create("white_frame.png");
-    background->setAnchorPoint(ccp(0.5, 0.5));
-    background->setPosition(ccp(0.5*size.width, 0.5*size.height));
-    background->setScale(size.width / background->getContentSize().width);
-    addChild(background);
-    
-    // Image sprite
-    CCSize image_size = CCSizeMake(4*size.height/5, 4*size.height/5);
-    CCSprite* image = NULL;
-    
-    if (image_size.width <= 128) {
-        image = CCSprite::create(pictogram->getThumb()->getCString());
-    } else {
-        image = CCSprite::create(pictogram->getImage()->getCString());
-    }
-    
-    image->setAnchorPoint(ccp(0.5, 0.5));
-    image->setPosition(ccp(0.5*size.width, 3*size.height/5));
-    image->setScale(image_size.width/image->getContentSize().width);
-    addChild(image);
+    // Frame, image, speaker button and label, baked in a single texture
+    // when the node gets a card frame
+    card_ = CCSprite::create();
+    card_->setAnchorPoint(ccp(0.5, 0.5));
+    card_->setPosition(ccp(0.5*size.width, 0.5*size.height));
+    setCard(card);
+    addChild(card_);
     
     //////////////////
     // Speaker button
     
+    CCRect speaker_rect = PictoCardCache::speakerRect(size);
     speaker_button_ = CCLayer::create();
-    speaker_button_->setContentSize(CCSizeMake(size.width -0.04*size.width, size.height/5 -0.03*size.width));
+    speaker_button_->setContentSize(speaker_rect.size);
     speaker_button_->ignoreAnchorPointForPosition(false);
     speaker_button_->setAnchorPoint(ccp(0.5, 0.5));
-    speaker_button_->setPosition(ccp(0.5*size.width, 0.5*size.height/5.0));
-    
-    // Speaker background rounded frame
-    speaker_background_ = CCSprite::create("speaker_background.png");
-    speaker_background_->setScaleX(speaker_button_->getContentSize().width / speaker_background_->getContentSize().width);
-    speaker_background_->setScaleY(speaker_button_->getContentSize().height / speaker_background_->getContentSize().height);
-    speaker_background_->ignoreAnchorPointForPosition(false);
-    speaker_background_->setAnchorPoint(CCPointZero);
-    speaker_background_->setPosition(CCPointZero);
-    speaker_button_->addChild(speaker_background_);
-    
-    // Speaker icon sprite
-    speaker_icon_ = CCSprite::create("speaker.png");
-    speaker_icon_->setPosition(ccp(0.1*speaker_button_->getContentSize().height,
-                                   0.5*speaker_button_->getContentSize().height));
-    speaker_icon_->setAnchorPoint(ccp(0, 0.5));
-    speaker_icon_->setScale(0.5*speaker_button_->getContentSize().height / speaker_icon_->getContentSize().height);
-    speaker_button_->addChild(speaker_icon_);
-    
-    // Title label
-    float font_size = 0.7*speaker_button_->getContentSize().height;
-    speaker_label_ = picto::cocos2d_utils::createLabel(pictogram->getName()->getCString(), font_size);
-    speaker_label_->ignoreAnchorPointForPosition(false);
-    speaker_label_->setAnchorPoint(ccp(0.5, 0.5));
-    speaker_label_->setPosition(ccp(0.5*speaker_button_->getContentSize().width,
-                                    0.5*speaker_button_->getContentSize().height));
-    
-    // Scale the label to not overlap the speaker icon
-    speaker_label_->setScale(MIN(1, 0.75*speaker_button_->getContentSize().width / speaker_label_->getContentSize().width));
-    speaker_button_->addChild(speaker_label_);
+    speaker_button_->setPosition(ccp(speaker_rect.getMidX(), speaker_rect.getMidY()));
+    
+    // Highlight over the baked button while the sound plays
+    speaker_highlight_ = CCSprite::create("speaker_background.png");
+    speaker_highlight_->setScaleX(speaker_rect.size.width / speaker_highlight_->getContentSize().width);
+    speaker_highlight_->setScaleY(speaker_rect.size.height / speaker_highlight_->getContentSize().height);
+    speaker_highlight_->setAnchorPoint(CCPointZero);
+    speaker_highlight_->setPosition(CCPointZero);
+    speaker_highlight_->setOpacity(0);
+    speaker_highlight_->setVisible(false);
+    speaker_button_->addChild(speaker_highlight_);
     
     addChild(speaker_button_);
     
     return true;
 }
 
+void PictogramNode::setData(PictogramObject* pictogram, CCSpriteFrame* card) {
+    
+    CC_SAFE_RETAIN(pictogram);
+    CC_SAFE_RELEASE(data_);
+    data_ = pictogram;
+    
+    setCard(card);
+}
+
+void PictogramNode::attachCard(CCSpriteBatchNode* batch) {
+    
+    if (card_->getParent() != batch) {
+        card_->retain();
+        card_->removeFromParentAndCleanup(false);
+        batch->addChild(card_);
+        card_->release();
+    }
+    card_->setPosition(getPosition());
+}
+
+void PictogramNode::setCard(CCSpriteFrame* card) {
+    
+    removeParts();
+    
+    if (card) {
+        card_->setDisplayFrame(card);
+        card_->setScale(getContentSize().width / card_->getContentSize().width);
+        card_->setVisible(true);
+        
+        // Names that would be rasterized aren't baked, they arrive later
+        if (data_ && !PictoCardCache::bakesName(data_)) {
+            parts_ = PictoCardCache::name(data_, getContentSize(), true);
+            addChild(parts_, 1);
+        }
+    } else if (data_) {
+        
+        // A card of its own would be baked for this node only, drawing its
+        // parts costs less than rendering and storing it
+        card_->setVisible(false);
+        parts_ = PictoCardCache::compose(data_, getContentSize(), false);
+        addChild(parts_, -1);
+    }
+    card_generation_ = PictoTheme::generation();
+}
+
+void PictogramNode::removeParts() {
+    
+    if (parts_) {
+        parts_->removeFromParentAndCleanup(true);
+        parts_ = NULL;
+    }
+}
+
+void PictogramNode::detachCard() {
+    
+    if (card_ && card_->getParent() != this) {
+        card_->retain();
+        card_->removeFromParentAndCleanup(false);
+        card_->setPosition(ccp(0.5*getContentSize().width, 0.5*getContentSize().height));
+        addChild(card_);
+        card_->release();
+    }
+}
+
+void PictogramNode::themeChanged(CCObject* theme) {
+    
+    // Adjust colors, the rest of the card was baked with the theme colors
+    speaker_highlight_->setColor(picto::resources::speakerButtonTextColor());
+    
+    // A card baked with the previous colors is drawn again from its parts,
+    // out of the sheet it may share with other cards. Also on enter, for the
+    // themes selected while the node was off the stage
+    if (data_ && card_generation_ != PictoTheme::generation()) {
+        detachCard();
+        setCard(NULL);
+    }
+}
+
 void PictogramNode::ignoreTouches(bool ignore) {
     ignore_touches_ = ignore;
 }
@@ -167,6 +310,11 @@ bool PictogramNode::ccTouchBegan(CCTouch *touch, CCEvent *event) {
             speaker_button_->runAction(CCSequence::create(CCScaleBy::create(0.3f, 1.05),
                                                       CCScaleTo::create(0.7f, 1),
                                                       NULL));
+            speaker_highlight_->runAction(CCSequence::create(CCShow::create(),
+                                                         CCFadeTo::create(0.3f, 96),
+                                                         CCFadeTo::create(0.7f, 0),
+                                                         CCHide::create(),
+                                                         NULL));
         }
         
         return true;
@@ -184,19 +332,18 @@ bool PictogramNode::ccTouchBegan(CCTouch *touch, CCEvent *event) {
 }
 
 void PictogramNode::onEnter() {
-    CCLayerColor::onEnter();
+    CCLayer::onEnter();
     setTouchEnabled(true);
     setTouchPriority(1);
     CCDirector::sharedDirector()->getTouchDispatcher()->addTargetedDelegate(this, 0, true);
     
-    // Adjust colors
-    speaker_background_->setColor(picto::resources::speakerButtonBackgroundColor());
-    speaker_label_->setColor(picto::resources::speakerButtonTextColor());
-    speaker_icon_->setColor(picto::resources::speakerButtonTextColor());
+    themeChanged(NULL);
+    PictoTheme::subscribe(this, callfuncO_selector(PictogramNode::themeChanged));
 }
 
 void PictogramNode::onExit() {
-    CCLayerColor::onExit();
+    PictoTheme::unsubscribe(this);
+    CCLayer::onExit();
     setTouchEnabled(false);
     CCDirector::sharedDirector()->getTouchDispatcher()->removeDelegate(this);
 }
\ No newline at end of file
@@ -35,31 +35,55 @@
 
 #include "PictogramObject.h"
 
-class PictogramNode : public cocos2d::CCLayerColor
+class PictogramNode : public cocos2d::CCLayer
 {
     
 public: // constructors and creators
     
-    static PictogramNode* create(PictogramObject *pictogram, const cocos2d::CCSize& size);
+    // Without a card frame the node draws the parts of the card
+    static PictogramNode* create(PictogramObject *pictogram, const cocos2d::CCSize& size, cocos2d::CCSpriteFrame* card = NULL);
+    
+    // A pooled node of the same size rebound to the pictogram, or a new one
+    static PictogramNode* dequeue(PictogramObject *pictogram, const cocos2d::CCSize& size, cocos2d::CCSpriteFrame* card = NULL);
+    
+    // Detaches the node and keeps it for a later dequeue
+    static void recycle(PictogramNode* node);
+    
+    // Recycles every pictogram node under parent
+    static void recycleChildren(cocos2d::CCNode* parent);
+    
+    static void purgePool();
     
     PictogramNode();
     ~PictogramNode();
     
 private: // init methods
     
-    bool init(PictogramObject *pictogram, const cocos2d::CCSize& size);
+    bool init(PictogramObject *pictogram, const cocos2d::CCSize& size, cocos2d::CCSpriteFrame* card);
     
 public: // public methods
     
     void ignoreTouches(bool ignore);
     void setTarget(cocos2d::CCObject *receiver, cocos2d::SEL_MenuHandler selector);
     
+    // Rebinds the node to another pictogram, keeping its size
+    void setData(PictogramObject *pictogram, cocos2d::CCSpriteFrame* card = NULL);
+    
+    // Draws the card through a batch node, which must be a sibling of the
+    // node placed at the origin of their parent
+    void attachCard(cocos2d::CCSpriteBatchNode* batch);
+    
 private: // private methods
     
+    void setCard(cocos2d::CCSpriteFrame* card);
+    void detachCard();
+    void removeParts();
+    
     bool ccTouchBegan(cocos2d::CCTouch *touch, cocos2d::CCEvent *event);
     void onEnter();
     void onExit();
     void speakerCallback(cocos2d::CCObject* sender);
+    void themeChanged(cocos2d::CCObject* theme);
     
 public: // public variables
     
@@ -69,10 +93,17 @@ private: // private variables
     
     bool ignore_touches_;
     
+    cocos2d::CCSprite* card_;
+    
+    // Theme generation the card was baked in
+    unsigned int card_generation_;
+    
+    // Frame, image, speaker button and label when there is no card frame,
+    // or the label when the card frame leaves it out
+    cocos2d::CCNode* parts_;
+    
     cocos2d::CCLayer* speaker_button_;
-    cocos2d::CCSprite* speaker_background_;
-    cocos2d::CCSprite* speaker_icon_;
-    cocos2d::CCLabelTTF* speaker_label_;
+    cocos2d::CCSprite* speaker_highlight_;
     
     cocos2d::CCObject* receiver_;
     cocos2d::SEL_MenuHandler selector_;
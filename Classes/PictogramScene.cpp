@@ -31,11 +31,14 @@
 #include "PictogramScene.h"
 
 #include "AppDelegate.h"
-#include "NavigationBar.h"
+#include "PictoChrome.h"
 #include "PictoDatabase.h"
 #include "PictogramGridScene.h"
 #include "PictogramNode.h"
 #include "PictoDefs.h"
+#include "PictoSettings.h"
+#include "PictoTextureCache.h"
+#include "PictoTheme.h"
 
 USING_NS_CC;
 
@@ -62,8 +65,6 @@ CCScene* Pictogram::scene(CCArray* pictograms, int enter_animation)
 }
 
 Pictogram::Pictogram() :
-back_button_(NULL),
-back_button_overlay_(NULL),
 pictogram_node_(NULL),
 pictogram_node_left_(NULL),
 pictogram_node_right_(NULL),
@@ -76,12 +77,11 @@ Pictogram::~Pictogram() {
     CC_SAFE_RELEASE_NULL(pictograms_);
     removeAllChildrenWithCleanup(true);
     removeFromParentAndCleanup(true);
-    CCTextureCache::purgeSharedTextureCache();
 }
 
 bool Pictogram::init(CCArray* pictograms, int enter_animation) {
     
-    ccColor4B color = picto::conversions::int2color4B(CCUserDefault::sharedUserDefault()->getIntegerForKey("color_theme", DEFAULT_COLOR_THEME));
+    ccColor4B color = picto::conversions::int2color4B(PictoSettings::sharedSettings()->getInteger("color_theme", DEFAULT_COLOR_THEME));
     
     //////////////////////////////
     // 1. super init first
@@ -89,8 +89,7 @@ bool Pictogram::init(CCArray* pictograms, int enter_animation) {
         return false;
     }
     
-    CCTextureCache::sharedTextureCache()->removeUnusedTextures();
-    CCTextureCache::sharedTextureCache()->purgeSharedTextureCache();
+    PictoTextureCache::trim();
     
     pictograms_ = pictograms;
     CC_SAFE_RETAIN(pictograms_);
@@ -104,19 +103,11 @@ bool Pictogram::init(CCArray* pictograms, int enter_animation) {
     
     // Compute some UI parameters
     CCSize visible_size = CCDirector::sharedDirector()->getVisibleSize();
-    CCPoint origin = CCDirector::sharedDirector()->getVisibleOrigin();
     
-    CCSize bottom_bar_size(visible_size.width, 0.2*MIN(visible_size.width, visible_size.height));
-    
-    if (pictograms_->count() > 1)
-        initBottomBar(bottom_bar_size, origin);
-    
-    CCSize top_bar_size(visible_size.width, 0.1*MIN(visible_size.width, visible_size.height));
-    CCPoint top_bar_origin = ccp(origin.x, origin.y + visible_size.height - top_bar_size.height);
-    initTopBar(top_bar_size, top_bar_origin);
-    
-    CCSize grid_size(visible_size.width, visible_size.height - bottom_bar_size.height - top_bar_size.height);
-    CCPoint grid_origin = ccp(origin.x, bottom_bar_size.height);
+    // Room for the back button is kept even when there is none
+    CCSize grid_size;
+    CCPoint grid_origin;
+    PictoChrome::contentArea(true, grid_size, grid_origin);
     initContent(grid_size, grid_origin, pictogram);
     
     if (enter_animation < 0) {
@@ -136,46 +127,6 @@ bool Pictogram::init(CCArray* pictograms, int enter_animation) {
     return true;
 }
 
-void Pictogram::initBottomBar(const CCSize& size, const CCPoint& origin) {
-    
-    CCSprite* normal = CCSprite::create("back_button_background_normal.png");
-    CCSprite* normal_overlay = CCSprite::create("back_button_normal.png");
-    normal_overlay->setAnchorPoint(ccp(0.5, 0.5));
-    normal_overlay->setPosition(ccp(0.5*normal->getContentSize().width,
-                                    0.5*normal->getContentSize().height));
-    normal->addChild(normal_overlay);
-    
-    CCSprite* selected = CCSprite::create("back_button_background_pressed.png");
-    selected->setPosition(ccp(0.5*(normal->getContentSize().width - selected->getContentSize().width),
-                              0.5*(normal->getContentSize().height - selected->getContentSize().height)));
-    selected->setOpacity(160);
-    CCSprite* selected_overlay = CCSprite::create("back_button_pressed.png");
-    selected_overlay->setAnchorPoint(ccp(0.5, 0.5));
-    selected_overlay->setPosition(ccp(0.5*selected->getContentSize().width,
-                                      0.5*selected->getContentSize().height));
-    selected->addChild(selected_overlay);
-    
-    back_button_ = CCMenuItemSprite::create(normal,
-                                                      selected,
-                                                      this,
-                                                      menu_selector(Pictogram::backPressed));
-    back_button_->setAnchorPoint(ccp(0.5, 0.5));
-    back_button_->setContentSize(normal->getContentSize());
-    back_button_->setPosition(ccp(0.5*size.width, 0.5*size.height));
-    
-    CCMenu* menu = CCMenu::create(back_button_, NULL);
-    menu->setPosition(origin);
-    addChild(menu);
-}
-
-void Pictogram::initTopBar(const CCSize& size, const CCPoint& origin) {
-    
-    NavigationBar* navigation_bar = NavigationBar::create(size, pictograms_);
-    navigation_bar->setPosition(origin);
-    
-    addChild(navigation_bar);
-}
-
 void Pictogram::initContent(const CCSize& size, const CCPoint& origin, PictogramObject* pictogram) {
     
     // Compute node visible size
@@ -189,7 +140,7 @@ void Pictogram::initContent(const CCSize& size, const CCPoint& origin, Pictogram
     node_size.height = MIN(node_size.height, node_size.width * ratio);
     node_size.width = node_size.height / ratio;
     
-    pictogram_node_ = PictogramNode::create(pictogram, node_size);
+    pictogram_node_ = PictogramNode::dequeue(pictogram, node_size);
     pictogram_node_->ignoreTouches(true);
     pictogram_node_->setPosition(center.x, center.y);
     addChild(pictogram_node_, 1);
@@ -200,28 +151,41 @@ void Pictogram::keyBackClicked() {
 }
 
 void Pictogram::onEnter() {
+    
+    // Back from a pushed scene, the node went to the pool on exit
+    if (!pictogram_node_) {
+        CCSize grid_size;
+        CCPoint grid_origin;
+        PictoChrome::contentArea(true, grid_size, grid_origin);
+        initContent(grid_size, grid_origin, picto::database::pictogram(((CCString*)pictograms_->lastObject())->getCString()));
+    }
+    
     CCLayerColor::onEnter();
     
-    setColor(picto::resources::backgroundColor());
     setTouchEnabled(true);
     setTouchPriority(0);
     CCDirector::sharedDirector()->getTouchDispatcher()->addTargetedDelegate(this, 1, true);
     
-    if (back_button_) {
-        back_button_->setColor(picto::resources::navigationBarBackgroundColor());
-    }
+    themeChanged(NULL);
+    PictoTheme::subscribe(this, callfuncO_selector(Pictogram::themeChanged));
     
-    if (back_button_overlay_) {
-        back_button_overlay_->setColor(picto::resources::navigationBarTextColor());
-    }
+    CCObject* back_target = pictograms_->count() > 1? this : NULL;
+    PictoChrome::sharedChrome()->show(pictograms_, back_target, menu_selector(Pictogram::backPressed));
 }
 
 void Pictogram::onExit() {
+    PictoTheme::unsubscribe(this);
     CCLayerColor::onExit();
+    PictogramNode::recycle(pictogram_node_);
+    pictogram_node_ = NULL;
     setTouchEnabled(false);
     CCDirector::sharedDirector()->getTouchDispatcher()->removeDelegate(this);
 }
 
+void Pictogram::themeChanged(CCObject* theme) {
+    setColor(picto::resources::backgroundColor());
+}
+
 // default implements are used to call script callback if exist
 bool Pictogram::ccTouchBegan(cocos2d::CCTouch *touch, cocos2d::CCEvent *event) {
     
@@ -291,21 +255,12 @@ void Pictogram::onSlideLeftwardsAnimationEnded() {
     pictograms_->removeLastObject();
     CCString* parent_pictogram = dynamic_cast<CCString*>(pictograms_->lastObject());
     
-    CCArray* childs = picto::database::childs(parent_pictogram->getCString());
-    if (childs->count() <= 1)
+    if (picto::database::countChilds(parent_pictogram->getCString()) <= 1)
         return;
     
-    size_t i=0;
-    CCObject *it;
-    CCARRAY_FOREACH(childs, it) {
-        PictogramObject *pictogram_object = dynamic_cast<PictogramObject*>(it);
-        if (strcmp(pictogram->getCString(), pictogram_object->getIdentifier()->getCString()) == 0)
-            break;
-        i++;
-    }
-    
-    i = (i-1 + childs->count()) % childs->count();
-    PictogramObject *pictogram_object = dynamic_cast<PictogramObject*>(childs->objectAtIndex(i));
+    PictogramObject *pictogram_object = picto::database::sibling(parent_pictogram->getCString(), pictogram->getCString(), -1);
+    if (pictogram_object == NULL)
+        return;
     pictograms_->addObject(CCString::create(pictogram_object->getIdentifier()->getCString()));
     CCDirector::sharedDirector()->replaceScene(Pictogram::scene(pictograms_, 1));
 }
@@ -317,21 +272,12 @@ void Pictogram::onSlideRightwardsAnimationEnded() {
     pictograms_->removeLastObject();
     CCString* parent_pictogram = dynamic_cast<CCString*>(pictograms_->lastObject());
     
-    CCArray* childs = picto::database::childs(parent_pictogram->getCString());
-    if (childs->count() <= 1)
+    if (picto::database::countChilds(parent_pictogram->getCString()) <= 1)
         return;
     
-    size_t i=0;
-    CCObject *it;
-    CCARRAY_FOREACH(childs, it) {
-        PictogramObject *pictogram_object = dynamic_cast<PictogramObject*>(it);
-        if (strcmp(pictogram->getCString(), pictogram_object->getIdentifier()->getCString()) == 0)
-            break;
-        i++;
-    }
-    
-    i = (i+1) % childs->count();
-    PictogramObject *pictogram_object = dynamic_cast<PictogramObject*>(childs->objectAtIndex(i));
+    PictogramObject *pictogram_object = picto::database::sibling(parent_pictogram->getCString(), pictogram->getCString(), 1);
+    if (pictogram_object == NULL)
+        return;
     pictograms_->addObject(CCString::create(pictogram_object->getIdentifier()->getCString()));
     CCDirector::sharedDirector()->replaceScene(Pictogram::scene(pictograms_, -1));
 }
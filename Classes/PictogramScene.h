@@ -49,8 +49,6 @@ public: // constructors and creators
 private: // initializers
     
     bool init(cocos2d::CCArray* pictograms, int enter_animation);
-    void initBottomBar(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
-    void initTopBar(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
     void initContent(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin, PictogramObject* pictogram);
     
 private: // private methods
@@ -66,11 +64,10 @@ private: // private methods
     void onExit();
     void onSlideLeftwardsAnimationEnded();
     void onSlideRightwardsAnimationEnded();
+    void themeChanged(cocos2d::CCObject* theme);
     
 private: // private variables
     
-    cocos2d::CCMenuItem* back_button_;
-    cocos2d::CCSprite* back_button_overlay_;
     PictogramNode* pictogram_node_;
     PictogramNode* pictogram_node_left_;
     PictogramNode* pictogram_node_right_;
@@ -30,11 +30,17 @@
 
 #include "SettingsScene.h"
 
-#include "NavigationBar.h"
 #include "PickThemeScene.h"
+#include "PictoChrome.h"
+#include "PictoDatabase.h"
 #include "PictoDefs.h"
+#include "PictoSettings.h"
+#include "PictoTextureCache.h"
+#include "PictoTheme.h"
+#include "PictogramGridScene.h"
 
 USING_NS_CC;
+USING_NS_CC_EXT;
 
 CCScene* Settings::scene()
 {
@@ -52,8 +58,9 @@ CCScene* Settings::scene()
 }
 
 Settings::Settings() :
-back_button_(NULL),
-labels_(NULL) {
+labels_(NULL),
+board_box_(NULL),
+search_box_(NULL) {
     
 }
 
@@ -63,7 +70,7 @@ Settings::~Settings() {
 
 bool Settings::init() {
     
-    ccColor4B color = picto::conversions::int2color4B(CCUserDefault::sharedUserDefault()->getIntegerForKey("color_theme", DEFAULT_COLOR_THEME));
+    ccColor4B color = picto::conversions::int2color4B(PictoSettings::sharedSettings()->getInteger("color_theme", DEFAULT_COLOR_THEME));
     
     ////////////////////
     // super init first
@@ -71,8 +78,7 @@ bool Settings::init() {
         return false;
     }
     
-    CCTextureCache::sharedTextureCache()->removeUnusedTextures();
-    CCTextureCache::sharedTextureCache()->purgeSharedTextureCache();
+    PictoTextureCache::trim();
     
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
     setKeypadEnabled(true);
@@ -81,73 +87,21 @@ bool Settings::init() {
     labels_ = CCArray::create();
     CC_SAFE_RETAIN(labels_);
     
-    // Compute some UI parameters
-    CCSize visibleSize = CCDirector::sharedDirector()->getVisibleSize();
-    CCPoint origin = CCDirector::sharedDirector()->getVisibleOrigin();
-    
-    CCSize bottomBarSize = visibleSize;
-    bottomBarSize.height = 0.2*MIN(visibleSize.width, visibleSize.height);
-    
-    initBottomBar(bottomBarSize, origin);
-    
-    CCSize topBarSize = visibleSize;
-    topBarSize.height = 0.1*MIN(visibleSize.width, visibleSize.height);
-    CCPoint topBarOrigin = ccp(origin.x, origin.y + visibleSize.height - topBarSize.height);
-    initTopBar(topBarSize, topBarOrigin);
-    
-    CCSize menuSize = visibleSize;
-    menuSize.height = visibleSize.height - bottomBarSize.height - topBarSize.height;
-    CCPoint menuOrigin = ccp(origin.x, bottomBarSize.height);
+    // The bars are drawn by the chrome
+    CCSize menuSize;
+    CCPoint menuOrigin;
+    PictoChrome::contentArea(true, menuSize, menuOrigin);
     initMenu(menuSize, menuOrigin);
     
     return true;
 }
 
-void Settings::initBottomBar(const CCSize& size, const CCPoint& origin) {
-    
-    CCSprite* normal = CCSprite::create("back_button_background_normal.png");
-    CCSprite* normal_overlay = CCSprite::create("back_button_normal.png");
-    normal_overlay->setAnchorPoint(ccp(0.5, 0.5));
-    normal_overlay->setPosition(ccp(0.5*normal->getContentSize().width,
-                                    0.5*normal->getContentSize().height));
-    normal->addChild(normal_overlay);
-    
-    CCSprite* selected = CCSprite::create("back_button_background_pressed.png");
-    selected->setPosition(ccp(0.5*(normal->getContentSize().width - selected->getContentSize().width),
-                              0.5*(normal->getContentSize().height - selected->getContentSize().height)));
-    selected->setOpacity(160);
-    CCSprite* selected_overlay = CCSprite::create("back_button_pressed.png");
-    selected_overlay->setAnchorPoint(ccp(0.5, 0.5));
-    selected_overlay->setPosition(ccp(0.5*selected->getContentSize().width,
-                                      0.5*selected->getContentSize().height));
-    selected->addChild(selected_overlay);
-    
-    back_button_ = CCMenuItemSprite::create(normal,
-                                            selected,
-                                            CCDirector::sharedDirector(),
-                                            menu_selector(CCDirector::popScene));
-    back_button_->setAnchorPoint(ccp(0.5, 0.5));
-    back_button_->setContentSize(normal->getContentSize());
-    back_button_->setPosition(ccp(0.5*size.width, 0.5*size.height));
-    
-    CCMenu* menu = CCMenu::create(back_button_, NULL);
-    menu->setPosition(origin);
-    addChild(menu);
-}
-
-void Settings::initTopBar(const CCSize& size, const CCPoint& origin) {
-    
-    NavigationBar* navigation_bar = NavigationBar::create(size, "Ajustes");
-    navigation_bar->setPosition(origin);
-    addChild(navigation_bar);
-}
-
 void Settings::initMenu(const CCSize& size, const CCPoint& origin) {
     
     float scale = 1.0f;
     
     float font_size = MIN(size.width/8, size.height/8);
-    CCLabelTTF* pick_theme_label = picto::cocos2d_utils::createLabel("Seleccionar tema", font_size);
+    PictoLabel* pick_theme_label = picto::cocos2d_utils::createLabel("Seleccionar tema", font_size);
     scale = MIN(scale, 0.7*size.width/pick_theme_label->getContentSize().width);
     labels_->addObject(pick_theme_label);
     CCMenuItemLabel *pick_theme = CCMenuItemLabel::create(pick_theme_label,
@@ -155,9 +109,50 @@ void Settings::initMenu(const CCSize& size, const CCPoint& origin) {
                                                          menu_selector(Settings::pickTheme));
     pick_theme->ignoreAnchorPointForPosition(false);
     pick_theme->setAnchorPoint(ccp(0.5, 0.5));
-    pick_theme->setPosition(ccp(0.5*size.width, 0.5*size.height));
-    
-    CCMenu* menu = CCMenu::create(pick_theme, NULL); // TODO menuCapitals
+    pick_theme->setPosition(ccp(0.5*size.width, 0.85*size.height));
+    
+    // Boards and searches are virtual categories, of the pictograms matching
+    // a tag filter or a name
+    CCSize box_size(0.7*size.width, 1.2*font_size);
+    board_box_ = CCEditBox::create(box_size, CCScale9Sprite::create("extensions/green_edit.png"));
+    board_box_->setAnchorPoint(ccp(0.5, 0.5));
+    board_box_->setPosition(ccp(origin.x + 0.5*size.width, origin.y + 0.65*size.height));
+    board_box_->setFontColor(ccBLACK);
+    board_box_->setPlaceHolder("food&level<=1");
+    board_box_->setInputMode(kEditBoxInputModeSingleLine);
+    board_box_->setReturnType(kKeyboardReturnTypeDone);
+    addChild(board_box_);
+    
+    PictoLabel* open_board_label = picto::cocos2d_utils::createLabel("Abrir tablero", font_size);
+    scale = MIN(scale, 0.7*size.width/open_board_label->getContentSize().width);
+    labels_->addObject(open_board_label);
+    CCMenuItemLabel *open_board = CCMenuItemLabel::create(open_board_label,
+                                                         this,
+                                                         menu_selector(Settings::openBoard));
+    open_board->ignoreAnchorPointForPosition(false);
+    open_board->setAnchorPoint(ccp(0.5, 0.5));
+    open_board->setPosition(ccp(0.5*size.width, 0.5*size.height));
+    
+    search_box_ = CCEditBox::create(box_size, CCScale9Sprite::create("extensions/green_edit.png"));
+    search_box_->setAnchorPoint(ccp(0.5, 0.5));
+    search_box_->setPosition(ccp(origin.x + 0.5*size.width, origin.y + 0.3*size.height));
+    search_box_->setFontColor(ccBLACK);
+    search_box_->setPlaceHolder("galleta");
+    search_box_->setInputMode(kEditBoxInputModeSingleLine);
+    search_box_->setReturnType(kKeyboardReturnTypeSearch);
+    addChild(search_box_);
+    
+    PictoLabel* search_label = picto::cocos2d_utils::createLabel("Buscar", font_size);
+    scale = MIN(scale, 0.7*size.width/search_label->getContentSize().width);
+    labels_->addObject(search_label);
+    CCMenuItemLabel *search = CCMenuItemLabel::create(search_label,
+                                                     this,
+                                                     menu_selector(Settings::openSearch));
+    search->ignoreAnchorPointForPosition(false);
+    search->setAnchorPoint(ccp(0.5, 0.5));
+    search->setPosition(ccp(0.5*size.width, 0.15*size.height));
+    
+    CCMenu* menu = CCMenu::create(pick_theme, open_board, search, NULL); // TODO menuCapitals
     menu->ignoreAnchorPointForPosition(false);
     menu->setAnchorPoint(ccp(0, 0));
     menu->setPosition(ccp(origin.x, origin.y));
@@ -171,22 +166,51 @@ void Settings::keyBackClicked() {
 
 void Settings::onEnter() {
     CCLayerColor::onEnter();
+    themeChanged(NULL);
+    PictoTheme::subscribe(this, callfuncO_selector(Settings::themeChanged));
     
-    // Adjust colors to theme
-    
+    PictoChrome::sharedChrome()->show("Ajustes", CCDirector::sharedDirector(), menu_selector(CCDirector::popScene));
+}
+
+void Settings::onExit() {
+    PictoTheme::unsubscribe(this);
+    CCLayerColor::onExit();
+}
+
+void Settings::themeChanged(CCObject* theme) {
     setColor(picto::resources::backgroundColor());
     
     CCObject* it;
     CCARRAY_FOREACH(labels_, it) {
-        CCLabelTTF* label = dynamic_cast<CCLabelTTF*>(it);
+        PictoLabel* label = dynamic_cast<PictoLabel*>(it);
         label->setColor(picto::resources::menuTextColor());
     }
-    
-    if (back_button_) {
-        back_button_->setColor(picto::resources::navigationBarBackgroundColor());
-    }
+
 }
 
 void Settings::pickTheme(cocos2d::CCObject *sender) {
     CCDirector::sharedDirector()->pushScene(PickTheme::scene());
+}
+
+void Settings::openBoard(cocos2d::CCObject *sender) {
+    openCategory(VIRTUAL_CATEGORY_PREFIX, board_box_->getText());
+}
+
+void Settings::openSearch(cocos2d::CCObject *sender) {
+    openCategory(SEARCH_CATEGORY_PREFIX, search_box_->getText());
+}
+
+void Settings::openCategory(char prefix, const char* text) {
+    
+    std::string query = text;
+    if (query.empty())
+        return;
+    
+    CCArray* pictograms = CCArray::create(CCString::create(ROOT_PICTOGRAM),
+                                          CCString::create(std::string(1, prefix) + query),
+                                          NULL);
+    
+    // Settings is pushed over a grid, which the board replaces
+    CCDirector::sharedDirector()->popScene();
+    CCDirector::sharedDirector()->replaceScene(PictogramGrid::scene(pictograms));
 }
\ No newline at end of file
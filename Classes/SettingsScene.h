@@ -32,6 +32,7 @@
 #define __SETTINGS_SCENE_H__
 
 #include "cocos2d.h"
+#include "cocos-ext.h"
 
 class Settings : public cocos2d::CCLayerColor
 {
@@ -48,20 +49,28 @@ public: // constructors and creators
 private: // initializers
     
     bool init();
-    void initBottomBar(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
-    void initTopBar(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
     void initMenu(const cocos2d::CCSize& size, const cocos2d::CCPoint& origin);
     
 private: // private methods
     
     void keyBackClicked();
     void onEnter();
+    void onExit();
     void pickTheme(cocos2d::CCObject* sender);
+    void openBoard(cocos2d::CCObject* sender);
+    void openSearch(cocos2d::CCObject* sender);
+    void openCategory(char prefix, const char* text);
+    void themeChanged(cocos2d::CCObject* theme);
     
 private: // private variables
     
-    cocos2d::CCMenuItem* back_button_;
     cocos2d::CCArray* labels_;
+    
+    // Tag filter of the board to open, e.g. "food&level<=1"
+    cocos2d::extension::CCEditBox* board_box_;
+    
+    // Name to search for, misspellings included
+    cocos2d::extension::CCEditBox* search_box_;
 };
 
 #endif // __PICTOGRAM_WITH_CHILDS_SCENE_H__
\ No newline at end of file
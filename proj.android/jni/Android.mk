@@ -11,17 +11,48 @@ LOCAL_SRC_FILES := hellocpp/main.cpp \
                    ../../Classes/CustomMenuItemLabel.cpp \
                    ../../Classes/NavigationBar.cpp \
                    ../../Classes/PickThemeScene.cpp \
+                   ../../Classes/PictoBitset.cpp \
+                   ../../Classes/PictoCardCache.cpp \
+                   ../../Classes/PictoCatalogShard.cpp \
+                   ../../Classes/PictoChrome.cpp \
                    ../../Classes/PictoDatabase.cpp \
+                   ../../Classes/PictoDecoder.cpp \
                    ../../Classes/PictoDefs.cpp \
                    ../../Classes/PictogramGalleryScene.cpp \
                    ../../Classes/PictogramGridScene.cpp \
                    ../../Classes/PictogramNode.cpp \
                    ../../Classes/PictogramObject.cpp \
                    ../../Classes/PictogramScene.cpp \
+                   ../../Classes/PictoGridLayout.cpp \
+                   ../../Classes/PictoImagePyramid.cpp \
+                   ../../Classes/PictoLabel.cpp \
+                   ../../Classes/PictoNameIndex.cpp \
+                   ../../Classes/PictoPrefetcher.cpp \
+                   ../../Classes/PictoPremultiply.cpp \
+                   ../../Classes/PictoRawTexture.cpp \
+                   ../../Classes/PictoSDFLabel.cpp \
+                   ../../Classes/PictoSettings.cpp \
+                   ../../Classes/PictoSQLiteProfile.cpp \
+                   ../../Classes/PictoTagIndex.cpp \
+                   ../../Classes/PictoTextureCache.cpp \
                    ../../Classes/PictoTheme.cpp \
+                   ../../Classes/PictoUpperCase.cpp \
                    ../../Classes/SettingsScene.cpp \
                    ../../Classes/sqlite3.c
 
+# SQLite profile for a single connection with a read-mostly workload. The page
+# cache and heap arena used by this profile are set up in picto::database::load
+LOCAL_CFLAGS := -DSQLITE_THREADSAFE=0 \
+                -DSQLITE_DEFAULT_MEMSTATUS=0 \
+                -DSQLITE_ENABLE_MEMSYS5 \
+                -DSQLITE_TEMP_STORE=3 \
+                -DSQLITE_OMIT_AUTOINIT \
+                -DSQLITE_OMIT_DECLTYPE \
+                -DSQLITE_OMIT_DEPRECATED \
+                -DSQLITE_OMIT_LOAD_EXTENSION \
+                -DSQLITE_OMIT_PROGRESS_CALLBACK \
+                -DSQLITE_OMIT_SHARED_CACHE
+
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/../../Classes \
 					$(LOCAL_PATH)/../../../boost_1_55_0 \
 					$(LOCAL_PATH)/../../../utf8_v2_3_4/source
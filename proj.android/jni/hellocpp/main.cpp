@@ -41,6 +41,10 @@ void Java_org_cocos2dx_lib_Cocos2dxRenderer_nativeInit(JNIEnv*  env, jobject thi
     }
 }
 
+void Java_org_aantea_PictoConnection_PictoConnection_nativeOnLowMemory(JNIEnv*  env, jclass clazz) {
+    AppDelegate::applicationDidReceiveMemoryWarning();
+}
+
 bool Java_org_aantea_PictoConnection_onNativeBackPressed(JNIEnv*  env, jobject thiz) {
     CCScene* scene = CCDirector::sharedDirector()->getRunningScene();
     
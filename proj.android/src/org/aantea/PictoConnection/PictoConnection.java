@@ -44,6 +44,21 @@ public class PictoConnection extends Cocos2dxActivity {
 		return glSurfaceView;
 	}
 
+	@Override
+	public void onLowMemory() {
+		super.onLowMemory();
+
+		// Native caches are only touched from the GL thread
+		runOnGLThread(new Runnable() {
+			@Override
+			public void run() {
+				nativeOnLowMemory();
+			}
+		});
+	}
+
+	private static native void nativeOnLowMemory();
+
 	static {
 		System.loadLibrary("cocos2dcpp");
 	}
@@ -0,0 +1,167 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoBitsetTest.cpp
+ * @brief Checks the bitset against a vector of bools
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include <vector>
+
+#include "PictoBitset.h"
+#include "PictoTest.h"
+
+namespace {
+    
+    typedef std::vector<bool> Model;
+    
+    unsigned int g_seed_ = 4242;
+    
+    unsigned int next_random(unsigned int range) {
+        g_seed_ = g_seed_*1103515245 + 12345;
+        return (g_seed_ >> 16) % range;
+    }
+    
+    // Random bits, sparse, dense or in between
+    void randomize(PictoBitset& bits, Model& model) {
+        
+        unsigned int density = next_random(4);
+        for (size_t i=0; i < bits.size(); i++) {
+            bool value = (density == 0)? next_random(50) == 0 : (density == 3)? next_random(50) != 0 : next_random(2) == 0;
+            if (value)
+                bits.set(i);
+            else
+                bits.reset(i);
+            model[i] = value;
+        }
+    }
+    
+    bool equal(const PictoBitset& bits, const Model& model) {
+        
+        if (bits.size() != model.size())
+            return false;
+        
+        size_t count = 0;
+        for (size_t i=0; i < model.size(); i++) {
+            if (bits.test(i) != model[i])
+                return false;
+            count += model[i];
+        }
+        if (bits.count() != count)
+            return false;
+        
+        // Walking the set bits visits exactly those of the model
+        size_t expected = 0;
+        for (size_t i=bits.next(0); i < bits.size(); i=bits.next(i + 1)) {
+            while (expected < model.size() && !model[expected])
+                expected++;
+            if (i != expected)
+                return false;
+            expected++;
+        }
+        while (expected < model.size() && !model[expected])
+            expected++;
+        
+        return expected == model.size() && bits.next(bits.size()) == bits.size();
+    }
+    
+    void check_size(size_t size) {
+        
+        PictoBitset empty(size);
+        PictoBitset full(size, true);
+        PICTO_CHECK(equal(empty, Model(size, false)));
+        PICTO_CHECK(equal(full, Model(size, true)));
+        
+        // Padding stays clear, or counts would include it
+        PictoBitset flipped(size);
+        flipped.flip();
+        PICTO_CHECK(equal(flipped, Model(size, true)));
+        flipped.fill(false);
+        PICTO_CHECK(equal(flipped, Model(size, false)));
+        
+        for (int round=0; round < 8; round++) {
+            
+            // The other operand may be shorter, as tag bitsets grow lazily
+            size_t other_size = (round % 2 == 0)? size : next_random(size + 1);
+            
+            PictoBitset a(size), b(other_size);
+            Model model_a(size), model_b(other_size);
+            randomize(a, model_a);
+            randomize(b, model_b);
+            
+            PictoBitset result = a;
+            Model expected = model_a;
+            switch (round % 4) {
+                case 0:
+                    result &= b;
+                    for (size_t i=0; i < size; i++)
+                        expected[i] = model_a[i] && i < other_size && model_b[i];
+                    break;
+                case 1:
+                    result |= b;
+                    for (size_t i=0; i < size; i++)
+                        expected[i] = model_a[i] || (i < other_size && model_b[i]);
+                    break;
+                case 2:
+                    result.andNot(b);
+                    for (size_t i=0; i < size; i++)
+                        expected[i] = model_a[i] && !(i < other_size && model_b[i]);
+                    break;
+                case 3:
+                    result.flip();
+                    for (size_t i=0; i < size; i++)
+                        expected[i] = !model_a[i];
+                    break;
+            }
+            
+            if (!PICTO_CHECK(equal(result, expected)))
+                fprintf(stderr, "  size=%lu other=%lu operation=%d\n", (unsigned long)size, (unsigned long)other_size, round % 4);
+        }
+        
+        // next() from every position
+        PictoBitset bits(size);
+        Model model(size);
+        randomize(bits, model);
+        for (size_t from=0; from <= size; from++) {
+            size_t expected = from;
+            while (expected < size && !model[expected])
+                expected++;
+            PICTO_CHECK_EQUAL(bits.next(from), expected);
+        }
+    }
+}
+
+int main() {
+    
+    // Every size around the word and block boundaries, then big ones
+    for (size_t size=0; size <= 300; size++)
+        check_size(size);
+    
+    const size_t sizes[] = { 1000, 4095, 4096, 4097, 65536 + 17, 2048*128*4 + 5 };
+    for (size_t i=0; i < sizeof(sizes)/sizeof(sizes[0]); i++)
+        check_size(sizes[i]);
+    
+    return picto_test::result();
+}
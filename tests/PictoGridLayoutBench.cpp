@@ -0,0 +1,96 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoGridLayoutBench.cpp
+ * @brief Times the grid solver against an exhaustive search, and the node rects
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include <vector>
+
+#include "PictoGridLayout.h"
+#include "PictoGridLayoutReference.h"
+#include "PictoTest.h"
+
+namespace {
+    
+    // Keeps the compiler from dropping the solver calls
+    int g_sink_ = 0;
+    
+    template <typename Solver>
+    double time_grids(Solver solver, int num_elements, int rounds) {
+        
+        double start = picto_test::now();
+        for (int i=0; i < rounds; i++) {
+            PictoGridLayout::Grid grid = solver(num_elements, 2048, 1300 + (i & 1), 1, 41);
+            g_sink_ += grid.rows + grid.cols;
+        }
+        return (picto_test::now() - start)*1000.0/rounds;
+    }
+}
+
+int main() {
+    
+    const int counts[] = { 12, 60, 500, 2000 };
+    
+    printf("%8s %14s %14s %14s\n", "nodes", "original (us)", "compute (us)", "solve (us)");
+    for (size_t i=0; i < sizeof(counts)/sizeof(counts[0]); i++) {
+        int n = counts[i];
+        
+        // The memoized solver alternates between two heights, both cached
+        double search = time_grids(picto_test::reference, n, 200);
+        double compute = time_grids(PictoGridLayout::compute, n, 20000);
+        double solve = time_grids(PictoGridLayout::solve, n, 200000);
+        printf("%8d %14.2f %14.3f %14.3f\n", n, search, compute, solve);
+    }
+    
+    // Rects of a whole grid and of the three gallery pages, as scenes ask
+    // for them on every layout
+    PictoGridLayout::Rect viewport = { 0, 260, 2048, 1229 };
+    PictoGridLayout::Style style = PictoGridLayout::defaultStyle(viewport);
+    std::vector<PictoGridLayout::Rect> rects;
+    
+    printf("\n%8s %14s\n", "nodes", "arrange (us)");
+    for (size_t i=0; i < sizeof(counts)/sizeof(counts[0]); i++) {
+        int n = counts[i];
+        int rounds = 2000000 / n;
+        
+        double start = picto_test::now();
+        for (int j=0; j < rounds; j++) {
+            PictoGridLayout::arrange(n, viewport, style, rects);
+            g_sink_ += (int)rects.back().x;
+        }
+        printf("%8d %14.3f\n", n, (picto_test::now() - start)*1000.0/rounds);
+    }
+    
+    double start = picto_test::now();
+    for (int j=0; j < 1000000; j++) {
+        PictoGridLayout::pages(-1, 3, viewport, style, rects);
+        g_sink_ += (int)rects.back().x;
+    }
+    printf("\n%8s %14.3f\n", "pages", (picto_test::now() - start)/1000.0);
+    
+    return g_sink_ == 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoGridLayoutReference.h
+ * @brief Grid search the app shipped before the solver, checked and timed against
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_GRID_LAYOUT_REFERENCE_H__
+#define __PICTO_GRID_LAYOUT_REFERENCE_H__
+
+#include "PictoGridLayout.h"
+
+namespace picto_test {
+    
+    namespace baseline {
+        
+        // Just enough of cocos2d for the original function to build as is
+        namespace cocos2d {
+            struct CCSize {
+                float width;
+                float height;
+                CCSize(float w=0, float h=0): width(w), height(h) {}
+            };
+        }
+        using cocos2d::CCSize;
+        
+        inline float MIN(float a, float b) { return a < b? a : b; }
+        
+        // Copied verbatim from PictogramGridScene.cpp as of 5516c13
+        inline CCSize computeOptimumGrid(const int num_elements, const cocos2d::CCSize gridSize, const float nodeRatio, const float margin) {
+            
+            CCSize bestGrid(1, num_elements);
+            float maxArea = 0;
+            float maxCompactness = 0;
+            
+            for (int i=1; i <= num_elements; i++) {
+                
+                float maxHeight = (gridSize.height - (i+1)*margin) / i;
+                float maxWidth = maxHeight / nodeRatio;
+                
+                if (maxHeight*maxWidth > maxArea) {
+                    for (int j=num_elements; j >=1; j--) {
+                        if (i*j < num_elements)
+                            break;
+                        
+                        float width = MIN((gridSize.width - (j+1)*margin) / j, maxWidth);
+                        float height = MIN(width * nodeRatio, maxHeight);
+                        float area = width*height;
+                        if (area > maxArea) {
+                            
+                            maxCompactness = (float)num_elements/(float)(i*j);
+                            maxArea = area;
+                            bestGrid.height = i;
+                            bestGrid.width = j;
+                            
+                        } else if (area == maxArea) {
+                            
+                            float compactness = (float)num_elements/(float)(i*j);
+                            
+                            if (compactness > maxCompactness) {
+                                maxCompactness = compactness;
+                                maxArea = area;
+                                bestGrid.height = i;
+                                bestGrid.width = j;
+                            }
+                        }
+                    }
+                }
+            }
+            
+            return bestGrid;
+        }
+    }
+    
+    /**
+     * The original search, rows and columns as the solver returns them
+     */
+    inline PictoGridLayout::Grid reference(int num_elements, float width, float height, float node_ratio, float margin) {
+        
+        baseline::CCSize grid = baseline::computeOptimumGrid(num_elements, baseline::CCSize(width, height), node_ratio, margin);
+        PictoGridLayout::Grid best = { (int)grid.height, (int)grid.width };
+        return best;
+    }
+    
+    /**
+     * Whether the nodes of a grid have any room, sized like the original
+     * scene did. The original search ranks grids without room by the product
+     * of two negative sizes and can pick them.
+     */
+    inline bool fits(const PictoGridLayout::Grid& grid, float width, float height, float node_ratio, float margin) {
+        
+        float node_width = (width - (grid.cols + 1)*margin) / grid.cols;
+        float node_height = (height - (grid.rows + 1)*margin) / grid.rows;
+        if (node_height > node_width * node_ratio)
+            node_height = node_width * node_ratio;
+        return node_height > 0 && node_height / node_ratio > 0;
+    }
+}
+
+#endif // __PICTO_GRID_LAYOUT_REFERENCE_H__
@@ -0,0 +1,233 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoGridLayoutTest.cpp
+ * @brief Checks the grid solver against an exhaustive search, and the node rects
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include <algorithm>
+
+#include "PictoGridLayout.h"
+#include "PictoGridLayoutReference.h"
+#include "PictoTest.h"
+
+// Biggest number of nodes checked, more than a category ever holds
+#define PICTO_TEST_MAX_ELEMENTS 2000
+
+// Biggest number of nodes also checked against the original search, which
+// takes quadratic time
+#define PICTO_TEST_MAX_REFERENCE 600
+
+namespace {
+    
+    // Content areas of the supported screens, in points
+    const float g_sizes_[][2] = {
+        { 480, 256 }, { 320, 384 }, { 1024, 614 }, { 768, 819 },
+        { 2048, 1229 }, { 1536, 1638 }, { 1280, 576 }, { 800, 1152 },
+        { 960, 560 }, { 100, 80 }
+    };
+    
+    const float g_ratios_[] = { 1, 0.75, 1.5 };
+    
+    // Fractions of the longest side
+    const float g_margins_[] = { 0.02, 0.005, 0 };
+    
+    void check_reference(const PictoGridLayout::Grid& grid, int num_elements, float width, float height, float node_ratio, float margin) {
+        
+        PictoGridLayout::Grid expected = picto_test::reference(num_elements, width, height, node_ratio, margin);
+        
+        // Where the original search picked nodes without room the solver
+        // picks any grid with room, or a single row when there is none
+        bool same = grid.rows == expected.rows && grid.cols == expected.cols;
+        if (!picto_test::fits(expected, width, height, node_ratio, margin))
+            same = picto_test::fits(grid, width, height, node_ratio, margin) || (grid.rows == 1 && grid.cols == num_elements);
+        
+        if (!PICTO_CHECK(same)) {
+            fprintf(stderr, "  n=%d %gx%g ratio=%g margin=%g: %dx%d, expected %dx%d\n",
+                    num_elements, width, height, node_ratio, margin,
+                    grid.rows, grid.cols, expected.rows, expected.cols);
+        }
+    }
+    
+    void check_grid(int num_elements, float width, float height, float node_ratio, float margin) {
+        
+        PictoGridLayout::Grid grid = PictoGridLayout::compute(num_elements, width, height, node_ratio, margin);
+        
+        if (num_elements <= PICTO_TEST_MAX_REFERENCE)
+            check_reference(grid, num_elements, width, height, node_ratio, margin);
+        
+        // Every node has a cell, and no row or column is left empty
+        PICTO_CHECK(grid.rows*grid.cols >= num_elements);
+        PICTO_CHECK((grid.rows - 1)*grid.cols < num_elements);
+        PICTO_CHECK(grid.rows*(grid.cols - 1) < num_elements || grid.rows == 1);
+        
+        // Memoized grids are the computed ones, also when asked again
+        for (int i=0; i < 2; i++) {
+            PictoGridLayout::Grid solved = PictoGridLayout::solve(num_elements, width, height, node_ratio, margin);
+            PICTO_CHECK(solved.rows == grid.rows && solved.cols == grid.cols);
+        }
+    }
+    
+    bool near(float a, float b) {
+        return a - b < 1e-2 && b - a < 1e-2;
+    }
+    
+    void check_arrange(size_t count, const PictoGridLayout::Rect& viewport) {
+        
+        PictoGridLayout::Style style = PictoGridLayout::defaultStyle(viewport);
+        PictoGridLayout::Grid grid = PictoGridLayout::solve((int)count, viewport.width, viewport.height, style.node_ratio, style.margin);
+        PictoGridLayout::Rect node = PictoGridLayout::node(grid, viewport, style);
+        
+        // Stale rects are dropped
+        std::vector<PictoGridLayout::Rect> rects(3);
+        PictoGridLayout::arrange(count, viewport, style, rects);
+        if (!PICTO_CHECK_EQUAL(rects.size(), count))
+            return;
+        
+        float right = viewport.x + viewport.width;
+        float top = viewport.y + viewport.height;
+        
+        for (size_t i=0; i < count; i++) {
+            const PictoGridLayout::Rect& rect = rects[i];
+            size_t row = i / grid.cols;
+            size_t col = i % grid.cols;
+            size_t row_begin = row*grid.cols;
+            size_t row_end = std::min(row_begin + grid.cols, count);
+            
+            PICTO_CHECK(rect.width == node.width && rect.height == node.height);
+            PICTO_CHECK(rect.x >= viewport.x + style.margin - 1e-2 && rect.x + rect.width <= right - style.margin + 1e-2);
+            PICTO_CHECK(rect.y >= viewport.y + style.margin - 1e-2 && rect.y + rect.height <= top - style.margin + 1e-2);
+            
+            // Rows from the top, nodes from the left, a margin apart
+            if (col > 0) {
+                PICTO_CHECK(near(rect.y, rects[i - 1].y));
+                PICTO_CHECK(near(rect.x - rects[i - 1].x, node.width + style.margin));
+            } else if (row > 0) {
+                PICTO_CHECK(near(rects[i - grid.cols].y - rect.y, node.height + style.margin));
+            }
+            
+            // Every row is centered, also an incomplete last one
+            if (i == row_end - 1) {
+                float left_gap = rects[row_begin].x - viewport.x;
+                float right_gap = right - (rect.x + rect.width);
+                PICTO_CHECK(near(left_gap, right_gap));
+            }
+        }
+        
+        // And so are the rows
+        float top_gap = top - (rects[0].y + rects[0].height);
+        float bottom_gap = rects[count - 1].y - viewport.y;
+        PICTO_CHECK(near(top_gap, bottom_gap));
+        
+        // A given grid with a spare row is centered as a whole, the spare
+        // cells are left at the bottom
+        PictoGridLayout::Grid bigger = { grid.rows + 1, grid.cols };
+        PictoGridLayout::arrange(count, bigger, viewport, style, rects);
+        PICTO_CHECK_EQUAL(rects.size(), count);
+        
+        float block_height = bigger.rows*rects[0].height + (bigger.rows - 1)*style.margin;
+        PICTO_CHECK(near(top - (rects[0].y + rects[0].height), 0.5*(viewport.height - block_height)));
+    }
+    
+    void check_pages(int first, int count, const PictoGridLayout::Rect& viewport) {
+        
+        PictoGridLayout::Style style = PictoGridLayout::defaultStyle(viewport);
+        PictoGridLayout::Grid single = { 1, 1 };
+        PictoGridLayout::Rect node = PictoGridLayout::node(single, viewport, style);
+        
+        std::vector<PictoGridLayout::Rect> rects;
+        PictoGridLayout::pages(first, count, viewport, style, rects);
+        if (!PICTO_CHECK_EQUAL(rects.size(), (size_t)count))
+            return;
+        
+        for (int i=0; i < count; i++) {
+            const PictoGridLayout::Rect& rect = rects[i];
+            int page = first + i;
+            
+            // Centered in the viewport once shifted back by its page
+            float x = rect.x - page*viewport.width;
+            PICTO_CHECK(rect.width == node.width && rect.height == node.height);
+            PICTO_CHECK(near(x - viewport.x, viewport.x + viewport.width - (x + rect.width)));
+            PICTO_CHECK(near(rect.y - viewport.y, viewport.y + viewport.height - (rect.y + rect.height)));
+        }
+    }
+}
+
+int main() {
+    
+    for (size_t s=0; s < sizeof(g_sizes_)/sizeof(g_sizes_[0]); s++) {
+        float width = g_sizes_[s][0];
+        float height = g_sizes_[s][1];
+        
+        for (size_t r=0; r < sizeof(g_ratios_)/sizeof(g_ratios_[0]); r++) {
+            for (size_t m=0; m < sizeof(g_margins_)/sizeof(g_margins_[0]); m++) {
+                float margin = g_margins_[m]*(width > height? width : height);
+                
+                for (int n=1; n <= PICTO_TEST_MAX_ELEMENTS; n++)
+                    check_grid(n, width, height, g_ratios_[r], margin);
+            }
+        }
+    }
+    
+    // Ties the original search kept on the first grid found
+    PictoGridLayout::Grid tied = PictoGridLayout::compute(67, 960, 560, 1, 0);
+    PICTO_CHECK(tied.rows == 6 && tied.cols == 12);
+    tied = PictoGridLayout::compute(241, 100, 80, 1.5, 2);
+    PICTO_CHECK(tied.rows == 12 && tied.cols == 21);
+    
+    // Nodes fill the viewport along one side at least
+    PictoGridLayout::Rect viewport = { 0, 0, 1024, 614 };
+    PictoGridLayout::Style style = PictoGridLayout::defaultStyle(viewport);
+    for (int n=1; n <= 200; n++) {
+        PictoGridLayout::Grid grid = PictoGridLayout::solve(n, viewport.width, viewport.height, style.node_ratio, style.margin);
+        PictoGridLayout::Rect node = PictoGridLayout::node(grid, viewport, style);
+        
+        float used_width = grid.cols*node.width + (grid.cols + 1)*style.margin;
+        float used_height = grid.rows*node.height + (grid.rows + 1)*style.margin;
+        PICTO_CHECK(used_width <= viewport.width + 1e-3 && used_height <= viewport.height + 1e-3);
+        PICTO_CHECK(used_width >= viewport.width - 1e-3 || used_height >= viewport.height - 1e-3);
+    }
+    
+    for (size_t s=0; s < sizeof(g_sizes_)/sizeof(g_sizes_[0]); s++) {
+        PictoGridLayout::Rect viewport = { 12, 34, g_sizes_[s][0], g_sizes_[s][1] };
+        
+        std::vector<PictoGridLayout::Rect> rects(1);
+        PictoGridLayout::arrange(0, viewport, PictoGridLayout::defaultStyle(viewport), rects);
+        PICTO_CHECK(rects.empty());
+        
+        for (size_t n=1; n <= 300; n++)
+            check_arrange(n, viewport);
+        
+        check_pages(-1, 3, viewport);
+        check_pages(0, 1, viewport);
+        check_pages(5, 4, viewport);
+        check_pages(0, 0, viewport);
+    }
+    
+    PictoGridLayout::purge();
+    
+    return picto_test::result();
+}
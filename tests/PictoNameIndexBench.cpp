@@ -0,0 +1,114 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoNameIndexBench.cpp
+ * @brief Fuzzy name search over a big catalog
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include <string>
+#include <vector>
+
+#include "PictoNameIndex.h"
+#include "PictoTest.h"
+
+// Target is under 10 ms per query on a single core
+#define BENCH_NAMES 20000
+#define BENCH_QUERIES 500
+
+namespace {
+    
+    unsigned int g_seed_ = 77;
+    
+    unsigned int next_random(unsigned int range) {
+        g_seed_ = g_seed_*1103515245 + 12345;
+        return (g_seed_ >> 16) % range;
+    }
+    
+    const char* g_syllables_[] = {
+        "ca", "sa", "ma", "pa", "ta", "la", "ga", "ba", "ne", "re", "te", "lle", "ye", "mi", "ri",
+        "ti", "co", "lo", "to", "ño", "ro", "cu", "tu", "ru", "llo", "ción", "sión", "rra", "bre", "tra"
+    };
+    
+    std::string random_word() {
+        
+        std::string word;
+        size_t syllables = 2 + next_random(3);
+        for (size_t i=0; i < syllables; i++)
+            word += g_syllables_[next_random(sizeof(g_syllables_)/sizeof(g_syllables_[0]))];
+        return word;
+    }
+    
+    // Names of one to three words, like the catalog
+    std::string random_name() {
+        
+        std::string name = random_word();
+        if (next_random(3) == 0)
+            name += " de " + random_word();
+        return name;
+    }
+    
+    std::string misspell(std::string text) {
+        
+        size_t at = next_random(text.size());
+        if (next_random(2) == 0)
+            text[at] = 'y';
+        else
+            text.erase(at, 1);
+        return text;
+    }
+}
+
+int main() {
+    
+    std::vector<std::string> names;
+    double start = picto_test::now();
+    PictoNameIndex index;
+    for (int i=0; i < BENCH_NAMES; i++) {
+        char identifier[16];
+        snprintf(identifier, sizeof(identifier), "p%05d", i);
+        names.push_back(random_name());
+        index.add(identifier, names.back());
+    }
+    printf("%-28s %10.2f ms\n", "build, 20000 names", picto_test::now() - start);
+    
+    std::vector<std::string> queries;
+    for (int i=0; i < BENCH_QUERIES; i++) {
+        const std::string& name = names[next_random(names.size())];
+        queries.push_back(misspell(name.substr(0, name.find(' '))));
+    }
+    
+    size_t found = 0;
+    for (unsigned int edits=0; edits <= 2; edits++) {
+        start = picto_test::now();
+        for (size_t i=0; i < queries.size(); i++)
+            found += index.search(queries[i], edits, 50).size();
+        char label[32];
+        snprintf(label, sizeof(label), "search, %u edits", edits);
+        printf("%-28s %10.3f ms per query\n", label, (picto_test::now() - start)/queries.size());
+    }
+    
+    return found == 0;
+}
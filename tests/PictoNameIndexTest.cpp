@@ -0,0 +1,175 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoNameIndexTest.cpp
+ * @brief Tests of name folding, edit distances and search ranking
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "PictoNameIndex.h"
+#include "PictoTest.h"
+
+namespace {
+    
+    unsigned int g_seed_ = 2929;
+    
+    unsigned int next_random(unsigned int range) {
+        g_seed_ = g_seed_*1103515245 + 12345;
+        return (g_seed_ >> 16) % range;
+    }
+    
+    // Full Wagner-Fischer matrix, the textbook definition
+    unsigned int reference(const std::string& a, const std::string& b) {
+        
+        std::vector< std::vector<unsigned int> > d(a.size() + 1, std::vector<unsigned int>(b.size() + 1));
+        for (size_t i=0; i <= a.size(); i++)
+            d[i][0] = i;
+        for (size_t j=0; j <= b.size(); j++)
+            d[0][j] = j;
+        for (size_t i=1; i <= a.size(); i++)
+            for (size_t j=1; j <= b.size(); j++)
+                d[i][j] = std::min(std::min(d[i - 1][j] + 1, d[i][j - 1] + 1),
+                                   d[i - 1][j - 1] + (a[i - 1] == b[j - 1]? 0 : 1));
+        return d[a.size()][b.size()];
+    }
+    
+    // Few letters, so random strings share many of them
+    std::string random_text(size_t length) {
+        
+        std::string text;
+        for (size_t i=0; i < length; i++)
+            text += (char)('A' + next_random(4));
+        return text;
+    }
+    
+    // Up to edits random insertions, deletions and substitutions
+    std::string misspell(std::string text, unsigned int edits) {
+        
+        for (unsigned int i=0; i < edits; i++) {
+            size_t at = next_random(text.size() + 1);
+            switch (next_random(3)) {
+                case 0:
+                    text.insert(at, 1, (char)('A' + next_random(4)));
+                    break;
+                case 1:
+                    if (at < text.size())
+                        text.erase(at, 1);
+                    break;
+                default:
+                    if (at < text.size())
+                        text[at] = (char)('A' + next_random(4));
+                    break;
+            }
+        }
+        return text;
+    }
+    
+    void check_distance(const std::string& a, const std::string& b, unsigned int max) {
+        
+        unsigned int expected = std::min(reference(a, b), max + 1);
+        if (!PICTO_CHECK_EQUAL(PictoNameIndex::distance(a, b, max), expected))
+            fprintf(stderr, "  \"%s\" \"%s\" max=%u: %u, expected %u\n", a.c_str(), b.c_str(), max,
+                    PictoNameIndex::distance(a, b, max), expected);
+    }
+    
+    std::vector<std::string> search(const PictoNameIndex& index, const char* query, unsigned int max_edits) {
+        
+        std::vector<PictoNameIndex::Match> matches = index.search(query, max_edits, 10);
+        std::vector<std::string> identifiers;
+        for (size_t i=0; i < matches.size(); i++)
+            identifiers.push_back(index.identifier(matches[i].entry));
+        return identifiers;
+    }
+}
+
+int main() {
+    
+    // Accents, the sharp s, and punctuation splitting words
+    PICTO_CHECK_EQUAL(PictoNameIndex::fold("Galletas"), std::string("GALLETAS"));
+    PICTO_CHECK_EQUAL(PictoNameIndex::fold("Ñandú"), std::string("NANDU"));
+    PICTO_CHECK_EQUAL(PictoNameIndex::fold("Camión"), std::string("CAMION"));
+    PICTO_CHECK_EQUAL(PictoNameIndex::fold("Straße"), std::string("STRASSE"));
+    PICTO_CHECK_EQUAL(PictoNameIndex::fold("Łódź"), std::string("LODZ"));
+    PICTO_CHECK_EQUAL(PictoNameIndex::fold("¿Qué?"), std::string(" QUE "));
+    PICTO_CHECK_EQUAL(PictoNameIndex::fold("radio-cd 2"), std::string("RADIO CD 2"));
+    
+    // Myers' kernel for patterns of up to 32 bytes, dynamic programming past
+    // them, both against the full matrix
+    for (int i=0; i < 20000; i++) {
+        size_t length = next_random(48);
+        std::string a = random_text(length);
+        std::string b = (i % 2 == 0)? misspell(a, next_random(6)) : random_text(next_random(48));
+        check_distance(a, b, next_random(8));
+        check_distance(a, b, 64);
+    }
+    
+    // Around the word size of the kernel
+    for (size_t length=30; length <= 34; length++) {
+        for (int i=0; i < 200; i++) {
+            std::string a = random_text(length);
+            check_distance(a, misspell(a, next_random(4)), 3);
+        }
+    }
+    
+    PictoNameIndex index;
+    index.add("bread", "Pan");
+    index.add("trouser", "Pantalón");
+    index.add("pana", "Pana");
+    index.add("cookie", "Galleta");
+    index.add("cookies", "Galletas");
+    index.add("shirt", "Camiseta de manga larga");
+    index.add("police", "Policía");
+    
+    // Exact words first, then prefixes, shorter names first
+    std::vector<std::string> results = search(index, "pan", 0);
+    PICTO_CHECK(results.size() == 3 && results[0] == "bread" && results[1] == "pana" && results[2] == "trouser");
+    
+    // Words past the first and accents in the query
+    results = search(index, "MANGA", 0);
+    PICTO_CHECK(results.size() == 1 && results[0] == "shirt");
+    results = search(index, "policia", 0);
+    PICTO_CHECK(results.size() == 1 && results[0] == "police");
+    
+    // Misspellings match only with enough edits, closest first
+    PICTO_CHECK(search(index, "gayeta", 1).empty());
+    results = search(index, "gayeta", 2);
+    PICTO_CHECK(results.size() == 1 && results[0] == "cookie");
+    results = search(index, "gayeta", 3);
+    PICTO_CHECK(results.size() == 2 && results[0] == "cookie" && results[1] == "cookies");
+    
+    // A query longer than 32 bytes, matched against the whole name
+    results = search(index, "camiseta de manga largaa con botones", 0);
+    PICTO_CHECK(results.empty());
+    results = search(index, "camiseta de mamga larga", 1);
+    PICTO_CHECK(results.size() == 1 && results[0] == "shirt");
+    results = search(index, "camiseta de manga larga azul y blanca", 14);
+    PICTO_CHECK(!results.empty() && results[0] == "shirt");
+    
+    return picto_test::result();
+}
@@ -0,0 +1,82 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoPremultiplyBench.cpp
+ * @brief Times premultiply with and without vector instructions
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include <vector>
+
+#include "PictoPremultiply.h"
+#include "PictoTest.h"
+
+namespace {
+    
+    unsigned int g_sink_ = 0;
+    
+    // Premultiplies copies of the image, as decoded images are premultiplied
+    // once each
+    double time_image(void (*function)(unsigned char*, size_t), const std::vector<unsigned char>& image, int rounds) {
+        
+        std::vector<unsigned char> pixels(image.size());
+        double ms = 0;
+        for (int i=0; i < rounds; i++) {
+            pixels = image;
+            double start = picto_test::now();
+            function(&pixels[0], pixels.size()/4);
+            ms += picto_test::now() - start;
+            g_sink_ += pixels[(i*4099) % pixels.size()];
+        }
+        return ms;
+    }
+}
+
+int main() {
+    
+    printf("%-24s %14s %14s\n", "", "scalar (ms)", "vector (ms)");
+    
+    // Pictogram images go from thumbnails to full screen pyramid levels
+    const int sides[] = { 128, 512, 1024, 2048 };
+    for (size_t s=0; s < sizeof(sides)/sizeof(sides[0]); s++) {
+        int side = sides[s];
+        std::vector<unsigned char> image(4*side*side);
+        unsigned int seed = 17;
+        for (size_t i=0; i < image.size(); i++) {
+            seed = seed*1103515245 + 12345;
+            image[i] = (unsigned char)(seed >> 16);
+        }
+        
+        // About 256 MB of pixels for every size
+        int rounds = 64*1024*1024 / (side*side);
+        char label[32];
+        snprintf(label, sizeof(label), "%dx%d x %d", side, side, rounds);
+        printf("%-24s %14.1f %14.1f\n", label,
+               time_image(picto::conversions::premultiplyScalar, image, rounds),
+               time_image(picto::conversions::premultiply, image, rounds));
+    }
+    
+    return g_sink_ == 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoPremultiplyTest.cpp
+ * @brief Checks premultiply against the scalar rounding of cocos2d
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include <string.h>
+#include <vector>
+
+#include "PictoPremultiply.h"
+#include "PictoTest.h"
+
+namespace {
+    
+    // CC_RGB_PREMULTIPLY_ALPHA, as CCImage premultiplies
+    unsigned char reference(unsigned char color, unsigned char alpha) {
+        return (unsigned char)(((unsigned int)color*(alpha + 1)) >> 8);
+    }
+}
+
+int main() {
+    
+    // Every color and alpha pair, with the vector paths and the scalar tail
+    // covering different pixels as the count and the offset change
+    std::vector<unsigned char> pixels(4*256*256);
+    for (unsigned int alpha=0; alpha < 256; alpha++) {
+        for (unsigned int color=0; color < 256; color++) {
+            unsigned char* pixel = &pixels[4*(alpha*256 + color)];
+            pixel[0] = color;
+            pixel[1] = 255 - color;
+            pixel[2] = color ^ 0x5a;
+            pixel[3] = alpha;
+        }
+    }
+    
+    for (size_t offset=0; offset < 9; offset++) {
+        size_t count = pixels.size()/4 - offset;
+        std::vector<unsigned char> vector(pixels.begin() + 4*offset, pixels.end());
+        std::vector<unsigned char> scalar(vector);
+        picto::conversions::premultiply(&vector[0], count);
+        picto::conversions::premultiplyScalar(&scalar[0], count);
+        
+        PICTO_CHECK(memcmp(&vector[0], &scalar[0], vector.size()) == 0);
+        for (size_t i=0; i < count; i++) {
+            const unsigned char* source = &pixels[4*(offset + i)];
+            const unsigned char* pixel = &vector[4*i];
+            PICTO_CHECK_EQUAL(pixel[0], reference(source[0], source[3]));
+            PICTO_CHECK_EQUAL(pixel[1], reference(source[1], source[3]));
+            PICTO_CHECK_EQUAL(pixel[2], reference(source[2], source[3]));
+            PICTO_CHECK_EQUAL(pixel[3], source[3]);
+        }
+    }
+    
+    // Short runs only take the scalar tail
+    for (size_t count=0; count < 9; count++) {
+        std::vector<unsigned char> vector(pixels.begin() + 4*1000, pixels.begin() + 4*(1000 + count) + 1);
+        std::vector<unsigned char> scalar(vector);
+        picto::conversions::premultiply(&vector[0], count);
+        picto::conversions::premultiplyScalar(&scalar[0], count);
+        PICTO_CHECK(vector == scalar);
+        
+        // The byte past the last pixel is left alone
+        PICTO_CHECK_EQUAL(vector[4*count], pixels[4*(1000 + count)]);
+    }
+    
+    return picto_test::result();
+}
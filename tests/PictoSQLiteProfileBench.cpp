@@ -0,0 +1,179 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoSQLiteProfileBench.cpp
+ * @brief Lookup latency and peak RSS of the SQLite profile against the default one
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include <stdlib.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "PictoSQLiteProfile.h"
+#include "PictoTest.h"
+
+// Built twice: PictoSQLiteProfileBench sets up the static memory of the app,
+// PictoSQLiteDefaultBench leaves SQLite as it comes
+
+// A catalog far bigger than the bundled one, with its page size
+#define BENCH_CATEGORIES 500
+#define BENCH_CHILDS 100
+#define BENCH_LOOKUPS 20000
+
+namespace {
+    
+    int g_rows_ = 0;
+    
+    int count_callback(void*, int, char**, char**) {
+        g_rows_++;
+        return 0;
+    }
+    
+    void exec(sqlite3* db, const std::string& sql) {
+        
+        char* error = NULL;
+        if (sqlite3_exec(db, sql.c_str(), count_callback, NULL, &error) != SQLITE_OK) {
+            fprintf(stderr, "SQL error: %s\n", error);
+            exit(1);
+        }
+    }
+    
+    std::string identifier(int category, int child) {
+        
+        char text[32];
+        snprintf(text, sizeof(text), "picto_%03d_%03d", category, child);
+        return text;
+    }
+    
+    // Same schema as the bundled catalog
+    void create_catalog(const char* path) {
+        
+        sqlite3* db = NULL;
+        sqlite3_initialize();
+        if (sqlite3_open(path, &db) != SQLITE_OK)
+            exit(1);
+        
+        char pragma[64];
+        snprintf(pragma, sizeof(pragma), "PRAGMA page_size=%d", PICTO_SQLITE_PAGE_SIZE);
+        exec(db, pragma);
+        exec(db, "CREATE TABLE \"relationships\" (\"parent\" VARCHAR NOT NULL , \"child\" VARCHAR NOT NULL , PRIMARY KEY (\"parent\", \"child\"))");
+        exec(db, "CREATE TABLE \"pictograms\" (\"id\" VARCHAR NOT NULL , \"locale\" VARCHAR NOT NULL , \"name\" VARCHAR NOT NULL , \"image\" VARCHAR NOT NULL , \"sound\" VARCHAR NOT NULL , \"thumb\" VARCHAR NOT NULL, PRIMARY KEY (\"id\", \"locale\"))");
+        exec(db, "BEGIN");
+        
+        for (int c=0; c < BENCH_CATEGORIES; c++) {
+            std::string category = identifier(c, 0);
+            exec(db, "INSERT INTO relationships VALUES ('root', '" + category + "')");
+            for (int i=0; i <= BENCH_CHILDS; i++) {
+                std::string id = identifier(c, i);
+                if (i > 0)
+                    exec(db, "INSERT INTO relationships VALUES ('" + category + "', '" + id + "')");
+                exec(db, "INSERT INTO pictograms VALUES ('" + id + "', 'es', 'Nombre " + id + "', 'images/"
+                     + id + ".png', 'sounds/" + id + ".mp3', 'thumbs/" + id + "-thumb.png')");
+            }
+        }
+        
+        exec(db, "COMMIT");
+        sqlite3_close(db);
+        sqlite3_shutdown();
+    }
+}
+
+int main(int argc, char** argv) {
+    
+    const char* path = (argc > 1)? argv[1] : "picto_bench_catalog.db";
+    
+    // Built in another process, so it doesn't count in the peak RSS
+    if (access(path, F_OK) != 0) {
+        pid_t child = fork();
+        if (child == 0) {
+            create_catalog(path);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        if (status != 0)
+            return 1;
+    }
+    
+#ifdef PICTO_SQLITE_BENCH_PROFILE
+    const char* build = "profile";
+    int rc = picto::sqlite_profile::configure();
+    if (rc != SQLITE_OK)
+        fprintf(stderr, "SQLite memory couldn't be configured [rc=%d]\n", rc);
+    if (picto::sqlite_profile::pageSize(path) != PICTO_SQLITE_PAGE_SIZE)
+        fprintf(stderr, "Catalog pages don't fit the page cache\n");
+#else
+    const char* build = "default";
+#endif
+    
+    double start = picto_test::now();
+    sqlite3_initialize();
+    sqlite3* db = NULL;
+    if (sqlite3_open(path, &db) != SQLITE_OK)
+        return 1;
+#ifdef PICTO_SQLITE_BENCH_PROFILE
+    picto::sqlite_profile::limit(db);
+#endif
+    
+    // The first query reads the schema
+    exec(db, "SELECT * FROM pictograms WHERE id='root'");
+    double open_ms = picto_test::now() - start;
+    
+    // Single pictograms, as query_pictogram looks them up
+    unsigned int seed = 17;
+    start = picto_test::now();
+    for (int i=0; i < BENCH_LOOKUPS; i++) {
+        seed = seed*1103515245 + 12345;
+        int category = (seed >> 8) % BENCH_CATEGORIES;
+        int child = (seed >> 20) % (BENCH_CHILDS + 1);
+        exec(db, "SELECT * FROM pictograms WHERE id='" + identifier(category, child) + "'");
+    }
+    double lookup_us = (picto_test::now() - start)*1000.0/BENCH_LOOKUPS;
+    
+    // Whole categories, as a shard loads them: childs, then their rows
+    start = picto_test::now();
+    for (int c=0; c < BENCH_CATEGORIES; c++) {
+        exec(db, "SELECT parent, child FROM relationships WHERE parent IN ('" + identifier(c, 0) + "')");
+        std::string in;
+        for (int i=1; i <= BENCH_CHILDS; i++)
+            in += (i > 1? ", '" : "'") + identifier(c, i) + "'";
+        exec(db, "SELECT * FROM pictograms WHERE id IN (" + in + ")");
+    }
+    double category_ms = (picto_test::now() - start)/BENCH_CATEGORIES;
+    
+    sqlite3_close(db);
+    
+    // Kilobytes on Linux, bytes on macOS
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    
+    printf("%-8s open %.2f ms, lookup %.2f us, category %.3f ms, peak RSS %ld KB, %d rows\n",
+           build, open_ms, lookup_us, category_ms, usage.ru_maxrss, g_rows_);
+    
+    return 0;
+}
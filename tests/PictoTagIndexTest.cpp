@@ -0,0 +1,185 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoTagIndexTest.cpp
+ * @brief Checks tag filters against their matches computed one by one
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include <set>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "PictoTagIndex.h"
+#include "PictoTest.h"
+
+#define PICTO_TEST_PICTOGRAMS 3000
+#define PICTO_TEST_LEVELS 5
+
+namespace {
+    
+    const char* g_tags_[] = { "food", "drink", "hidden", "animal", "home" };
+    const size_t g_num_tags_ = sizeof(g_tags_)/sizeof(g_tags_[0]);
+    
+    struct Pictogram {
+        std::string identifier;
+        std::set<std::string> tags;
+        std::set<int> levels;
+    };
+    
+    unsigned int g_seed_ = 777;
+    
+    unsigned int next_random(unsigned int range) {
+        g_seed_ = g_seed_*1103515245 + 12345;
+        return (g_seed_ >> 16) % range;
+    }
+    
+    struct Item {
+        bool negated;
+        bool level;
+        int bound;
+        std::string tag;
+    };
+    
+    typedef std::vector<std::vector<Item> > Filter;
+    
+    bool matches(const Pictogram& pictogram, const Item& item) {
+        
+        bool result = false;
+        if (item.level) {
+            for (std::set<int>::const_iterator it=pictogram.levels.begin(); it != pictogram.levels.end(); ++it)
+                result = result || *it <= item.bound;
+        } else {
+            result = pictogram.tags.count(item.tag) > 0;
+        }
+        return result != item.negated;
+    }
+    
+    bool matches(const Pictogram& pictogram, const Filter& filter) {
+        
+        for (size_t i=0; i < filter.size(); i++) {
+            bool any = false;
+            for (size_t j=0; j < filter[i].size(); j++)
+                any = any || matches(pictogram, filter[i][j]);
+            if (!any)
+                return false;
+        }
+        return true;
+    }
+    
+    // Random filter and its text, with stray spaces the parser trims
+    Filter random_filter(std::string& text) {
+        
+        Filter filter(1 + next_random(3));
+        text.clear();
+        
+        for (size_t i=0; i < filter.size(); i++) {
+            if (i > 0)
+                text += next_random(2)? "&" : " & ";
+            
+            filter[i].resize(1 + next_random(3));
+            for (size_t j=0; j < filter[i].size(); j++) {
+                Item& item = filter[i][j];
+                item.negated = next_random(4) == 0;
+                item.level = next_random(4) == 0;
+                item.bound = (int)next_random(PICTO_TEST_LEVELS + 1) - 1;
+                
+                // Unknown tags match nothing
+                item.tag = next_random(10) == 0? "unknown" : g_tags_[next_random(g_num_tags_)];
+                
+                if (j > 0)
+                    text += next_random(2)? "|" : " | ";
+                if (item.negated)
+                    text += next_random(2)? "!" : "! ";
+                if (item.level) {
+                    char bound[32];
+                    sprintf(bound, "level<=%d", item.bound);
+                    text += bound;
+                } else {
+                    text += item.tag;
+                }
+            }
+        }
+        
+        return filter;
+    }
+}
+
+int main() {
+    
+    std::vector<Pictogram> pictograms(PICTO_TEST_PICTOGRAMS);
+    PictoTagIndex index;
+    
+    // Tags and levels come while pictograms are still being added, so some
+    // bitsets are shorter than the index
+    for (size_t i=0; i < pictograms.size(); i++) {
+        char identifier[32];
+        sprintf(identifier, "p%lu", (unsigned long)i);
+        pictograms[i].identifier = identifier;
+        
+        PICTO_CHECK_EQUAL(index.add(identifier), i);
+        
+        for (size_t t=0; t < g_num_tags_; t++) {
+            if (next_random(t + 2) == 0) {
+                pictograms[i].tags.insert(g_tags_[t]);
+                index.tag(identifier, g_tags_[t]);
+            }
+        }
+        
+        if (next_random(3) != 0) {
+            int level = next_random(PICTO_TEST_LEVELS);
+            pictograms[i].levels.insert(level);
+            index.level(identifier, level);
+        }
+    }
+    
+    // Adding again keeps the ordinal, negative levels are ignored
+    PICTO_CHECK_EQUAL(index.add("p7"), (size_t)7);
+    index.level("p7", -1);
+    PICTO_CHECK_EQUAL(index.size(), pictograms.size());
+    for (size_t i=0; i < pictograms.size(); i++)
+        PICTO_CHECK(index.identifier(i) == pictograms[i].identifier);
+    
+    // An empty filter matches everything
+    PICTO_CHECK_EQUAL(index.evaluate("").count(), pictograms.size());
+    PICTO_CHECK_EQUAL(index.evaluate(" & ").count(), pictograms.size());
+    
+    for (int round=0; round < 500; round++) {
+        std::string text;
+        Filter filter = random_filter(text);
+        PictoBitset result = index.evaluate(text);
+        
+        size_t mismatches = 0;
+        for (size_t i=0; i < pictograms.size(); i++)
+            mismatches += result.test(i) != matches(pictograms[i], filter);
+        
+        if (!PICTO_CHECK_EQUAL(mismatches, (size_t)0))
+            fprintf(stderr, "  \"%s\": %lu mismatches\n", text.c_str(), (unsigned long)mismatches);
+        PICTO_CHECK_EQUAL(result.size(), pictograms.size());
+    }
+    
+    return picto_test::result();
+}
@@ -0,0 +1,80 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoTest.h
+ * @brief Minimal checks and timing shared by the tests and benchmarks
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#ifndef __PICTO_TEST_H__
+#define __PICTO_TEST_H__
+
+#include <stdio.h>
+#include <sys/time.h>
+
+// Only the first failures are printed, a broken invariant usually breaks
+// for thousands of inputs
+#define PICTO_TEST_MAX_REPORTS 20
+
+#define PICTO_CHECK(condition) \
+    picto_test::check((condition), #condition, __FILE__, __LINE__)
+
+#define PICTO_CHECK_EQUAL(a, b) \
+    picto_test::check((a) == (b), #a " == " #b, __FILE__, __LINE__)
+
+namespace picto_test {
+    
+    static int g_checks_ = 0;
+    static int g_failures_ = 0;
+    
+    inline bool check(bool passed, const char* condition, const char* file, int line) {
+        
+        g_checks_++;
+        if (!passed) {
+            if (g_failures_ < PICTO_TEST_MAX_REPORTS)
+                fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+            g_failures_++;
+        }
+        
+        return passed;
+    }
+    
+    // Exit status of a test, after a summary of the checks
+    inline int result() {
+        
+        printf("%d checks, %d failed\n", g_checks_, g_failures_);
+        return g_failures_ == 0? 0 : 1;
+    }
+    
+    // Milliseconds from an arbitrary point, for benchmarks
+    inline double now() {
+        
+        struct timeval time;
+        gettimeofday(&time, NULL);
+        return time.tv_sec*1000.0 + time.tv_usec/1000.0;
+    }
+}
+
+#endif // __PICTO_TEST_H__
@@ -0,0 +1,138 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoUpperCaseBench.cpp
+ * @brief Times toupper against the conversion it replaced
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include <clocale>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string>
+#include <wctype.h>
+
+#include "PictoTest.h"
+#include "PictoUpperCase.h"
+
+namespace baseline {
+    
+    // toupper before the case table: the C library, then a search in a
+    // literal string of accented letters, on the text converted to wide
+    // characters and back. mbstowcs and wcstombs stand in for utfcpp here.
+    std::wstring toupper(wchar_t in) {
+        wchar_t out = towupper(in);
+        std::wstring wsout;
+        
+        if (out != in || iswupper(in) || iswspace(in) || iswdigit(in))
+            wsout = out;
+        else {
+            const std::wstring lowercase = L"áàâäãéèêëíìîïóòôöõúùûüçñ";
+            const std::wstring uppercase = L"ÁÀÂÄÃÉÈÊËÍÌÎÏÓÒÔÖÕÚÙÛÜÇÑ";
+            size_t pos = lowercase.find(in);
+            if (pos != std::string::npos) {
+                wsout = uppercase[pos];
+            } else if(in == L'ß')
+                wsout = L"SS";
+            else {
+                wsout = out;
+            }
+        }
+        
+        return wsout;
+    }
+    
+    std::string toupper(const std::string& in) {
+        
+        std::wstring win(in.size() + 1, L'\0');
+        win.resize(mbstowcs(&win[0], in.c_str(), win.size()));
+        
+        std::wstring wout;
+        wout.reserve(win.size());
+        for (size_t i=0; i < win.size(); i++)
+            wout += toupper(win[i]);
+        
+        std::string out(4*wout.size() + 1, '\0');
+        out.resize(wcstombs(&out[0], wout.c_str(), out.size()));
+        return out;
+    }
+}
+
+namespace {
+    
+    const char* g_names_[] = {
+        "casa", "pequeño", "árbol", "niña", "camión", "acción", "pingüino", "cigüeña",
+        "plátano", "leche", "pan", "agua", "zumo de naranja", "comer", "beber",
+        "jugar al fútbol", "hola ¿qué tal?", "sí", "dormir", "baño", "ducha",
+        "lavarse los dientes", "mamá", "papá", "abuela", "perro", "gato", "león",
+        "cumpleaños", "autobús"
+    };
+    
+    size_t g_sink_ = 0;
+    
+    template <typename Function>
+    double time_strings(Function function, const std::string* strings, size_t count, int rounds) {
+        
+        double start = picto_test::now();
+        for (int i=0; i < rounds; i++) {
+            for (size_t j=0; j < count; j++)
+                g_sink_ += function(strings[j]).size();
+        }
+        return picto_test::now() - start;
+    }
+    
+    std::string table(const std::string& text) {
+        return picto::conversions::toupper(text);
+    }
+    
+    std::string previous(const std::string& text) {
+        return baseline::toupper(text);
+    }
+}
+
+int main() {
+    
+    if (setlocale(LC_ALL, "C.UTF-8") == NULL && setlocale(LC_ALL, "C.utf8") == NULL) {
+        fprintf(stderr, "No UTF-8 locale\n");
+        return 1;
+    }
+    
+    size_t count = sizeof(g_names_)/sizeof(g_names_[0]);
+    std::string names[sizeof(g_names_)/sizeof(g_names_[0])];
+    for (size_t i=0; i < count; i++)
+        names[i] = g_names_[i];
+    
+    std::string ascii(200, ' ');
+    for (size_t i=0; i < ascii.size(); i++)
+        ascii[i] = 'a' + i % 26;
+    
+    printf("%-24s %14s %14s\n", "", "previous (ms)", "table (ms)");
+    printf("%-24s %14.1f %14.1f\n", "30 names x 20000",
+           time_strings(previous, names, count, 20000), time_strings(table, names, count, 20000));
+    printf("%-24s %14.1f %14.1f\n", "200 ASCII x 100000",
+           time_strings(previous, &ascii, 1, 100000), time_strings(table, &ascii, 1, 100000));
+    
+    return g_sink_ == 0;
+}
@@ -0,0 +1,191 @@
+/**
+ * PictoConnection
+ *
+ * @file PictoUpperCaseTest.cpp
+ * @brief Checks the uppercase table and conversions against the C library
+ *
+ * @author Javier Alvargonzález <javier.alvargonzalez@itiox.com>
+ *
+ * @copyright Original work Copyright (C) 2014 ITIOX <itiox@itiox.com>
+ *
+ * @section LICENSE
+ *
+ * This file is part of PictoConnection.
+ *
+ * PictoConnection is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PictoConnection is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @license GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+ **/
+
+#include <clocale>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include <wctype.h>
+
+#include "PictoTest.h"
+#include "PictoUpperCase.h"
+
+using picto::conversions::g_upper_;
+
+namespace {
+    
+    // Uppercase the table should hold, from the case mappings of the C library
+    wchar_t reference(wchar_t c) {
+        
+        wint_t upper = towupper(c);
+        return (c < PICTO_UPPER_TABLE_SIZE && upper < PICTO_UPPER_TABLE_SIZE)? upper : c;
+    }
+    
+    std::string encode(const std::wstring& text) {
+        
+        std::string out(4*text.size() + 1, '\0');
+        size_t length = wcstombs(&out[0], text.c_str(), out.size());
+        out.resize(length);
+        return out;
+    }
+    
+    std::wstring decode(const std::string& text) {
+        
+        std::wstring out(text.size() + 1, L'\0');
+        size_t length = mbstowcs(&out[0], text.c_str(), out.size());
+        out.resize(length);
+        return out;
+    }
+    
+    std::string reference(const std::string& text) {
+        
+        std::wstring in = decode(text);
+        std::wstring out;
+        for (size_t i=0; i < in.size(); i++) {
+            if (in[i] == 0xdf)
+                out += L"SS";
+            else
+                out += reference(in[i]);
+        }
+        return encode(out);
+    }
+    
+    // Letters of pictogram names and some past the table, which stay as they are
+    const wchar_t g_alphabet_[] = {
+        'a', 'z', 'A', 'Z', '0', ' ', '?', '~', 0x7f,
+        0xe1, 0xe9, 0xed, 0xf3, 0xfa, 0xfc, 0xf1, 0xe7, 0xc1, 0xd1, 0xdf, 0xb5, 0xff, 0xf7, 0xa0,
+        0x101, 0x131, 0x149, 0x153, 0x17f, 0x178, 0x17e,
+        0x180, 0x3b1, 0x430, 0x1e9e, 0x20ac, 0x4e2d, 0x1f600
+    };
+    
+    unsigned int g_seed_ = 12345;
+    
+    unsigned int next_random(unsigned int range) {
+        g_seed_ = g_seed_*1103515245 + 12345;
+        return (g_seed_ >> 16) % range;
+    }
+    
+    // Texts and their uppercase, more than the cache holds
+    typedef std::vector<std::pair<std::string, std::string> > Cases;
+    
+    // Uppercases every case a few times, returns how many came out wrong
+    void* uppercase_cases(void* data) {
+        
+        const Cases& cases = *static_cast<const Cases*>(data);
+        size_t wrong = 0;
+        for (int round=0; round < 20; round++) {
+            for (size_t i=0; i < cases.size(); i++) {
+                if (picto::conversions::toupper(cases[i].first) != cases[i].second)
+                    wrong++;
+            }
+        }
+        return (void*)wrong;
+    }
+}
+
+int main() {
+    
+    if (!PICTO_CHECK(setlocale(LC_ALL, "C.UTF-8") != NULL || setlocale(LC_ALL, "C.utf8") != NULL))
+        return picto_test::result();
+    
+    // The generated table against the C library
+    for (wchar_t c=0; c < PICTO_UPPER_TABLE_SIZE; c++) {
+        if (!PICTO_CHECK_EQUAL((wchar_t)g_upper_[c], reference(c)))
+            fprintf(stderr, "  U+%04x: U+%04x, expected U+%04x\n", (unsigned int)c, g_upper_[c], (unsigned int)reference(c));
+    }
+    
+    // Single characters
+    for (wchar_t c=0; c < 0x800; c++) {
+        std::wstring expected = (c == 0xdf)? L"SS" : std::wstring(1, reference(c));
+        PICTO_CHECK(picto::conversions::toupper(c) == expected);
+    }
+    
+    // Random UTF-8 strings, twice to go through the cache too
+    size_t letters = sizeof(g_alphabet_)/sizeof(g_alphabet_[0]);
+    for (int i=0; i < 5000; i++) {
+        std::wstring text;
+        
+        // Long ASCII prefixes take the vectorized path
+        size_t prefix = (i % 4 == 0)? next_random(40) : 0;
+        for (size_t j=0; j < prefix; j++)
+            text += (wchar_t)(' ' + next_random(95));
+        
+        size_t length = next_random(24);
+        for (size_t j=0; j < length; j++)
+            text += g_alphabet_[next_random(letters)];
+        
+        std::string utf8 = encode(text);
+        std::string expected = reference(utf8);
+        for (int j=0; j < 2; j++) {
+            if (!PICTO_CHECK(picto::conversions::toupper(utf8) == expected))
+                fprintf(stderr, "  \"%s\": \"%s\", expected \"%s\"\n", utf8.c_str(), picto::conversions::toupper(utf8).c_str(), expected.c_str());
+        }
+        
+        PICTO_CHECK(picto::conversions::toupper(text) == decode(expected));
+    }
+    
+    // Every ASCII length around the 16 byte blocks
+    for (size_t length=0; length <= 70; length++) {
+        std::string text;
+        for (size_t j=0; j < length; j++)
+            text += (char)(' ' + (j*7) % 95);
+        PICTO_CHECK(picto::conversions::toupper(text) == reference(text));
+    }
+    
+    // Threads sharing the cache, which fills up and is cleared under them
+    Cases cases;
+    for (int i=0; i < 1000; i++) {
+        std::wstring text;
+        text += g_alphabet_[9 + i % 15];
+        for (int n=i; n > 0; n /= 10)
+            text += (wchar_t)('a' + n % 10);
+        std::string utf8 = encode(text);
+        cases.push_back(std::make_pair(utf8, reference(utf8)));
+    }
+    
+    pthread_t threads[4];
+    for (int i=0; i < 4; i++)
+        PICTO_CHECK(pthread_create(&threads[i], NULL, uppercase_cases, &cases) == 0);
+    for (int i=0; i < 4; i++) {
+        void* wrong = NULL;
+        pthread_join(threads[i], &wrong);
+        PICTO_CHECK_EQUAL((size_t)wrong, (size_t)0);
+    }
+    
+    // Bytes that aren't valid UTF-8 are kept
+    PICTO_CHECK(picto::conversions::toupper("a\xc3") == "A\xc3");
+    PICTO_CHECK(picto::conversions::toupper("\xc3z") == "\xc3Z");
+    PICTO_CHECK(picto::conversions::toupper("\xff\xfe\xb1") == "\xff\xfe\xb1");
+    PICTO_CHECK(picto::conversions::toupper("\xc3\xb1\xe4\xb8") == "\xc3\x91\xe4\xb8");
+    
+    return picto_test::result();
+}
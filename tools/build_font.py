@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+#
+# PictoConnection
+#
+# Renders the glyphs the app shows into a bitmap font, so labels are quads
+# over a shared texture instead of strings rasterized one by one.
+#
+#   tools/build_font.py --font Arial.ttf --db proj.android/assets/picto_connection.db \
+#       --out proj.android/assets/fonts/picto
+#   tools/build_font.py --font Arial.ttf --db proj.android/assets/picto_connection.db \
+#       --out proj.android/assets/fonts/picto_sdf --sdf
+#
+# The iOS bundle takes its copy of the fonts from Resources/fonts.
+#
+# Covers printable ASCII, Latin-1 and Latin Extended-A, plus every character
+# in the pictogram names and their uppercase forms. Writes <out>.fnt (BMFont
+# text format, as read by CCLabelBMFont) and <out>.png. Requires Pillow.
+#
+# With --sdf the alpha of the atlas is a signed distance field instead of
+# coverage: 0.5 on the outline of a glyph, rising to 1 inside and falling to
+# 0 outside over SDF_SPREAD pixels. Glyphs are rendered SDF_UPSCALE times
+# bigger and the distances sampled down, and PictoSDFLabel draws them at any
+# size with a threshold shader.
+#
+# Copyright (C) 2014 ITIOX <itiox@itiox.com>
+# License GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+
+import argparse
+import math
+import os
+import sqlite3
+import sys
+
+from PIL import Image, ImageDraw, ImageFont
+
+# Must match PICTO_LABEL_FONT_SIZE in PictoLabel.cpp
+FONT_SIZE = 64
+
+# Must match PictoSDFLabel.cpp
+SDF_FONT_SIZE = 32
+SDF_SPREAD = 4
+SDF_UPSCALE = 4
+
+INF = 1e20
+
+
+def charset(db):
+    chars = set(chr(c) for c in range(0x20, 0x7f))
+    chars.update(chr(c) for c in range(0xa0, 0x180))
+    if db:
+        for (name,) in db.execute('SELECT name FROM pictograms WHERE name IS NOT NULL'):
+            chars.update(name)
+            chars.update(name.upper())
+    return sorted(c for c in chars if c.isprintable())
+
+
+def power_of_two(n):
+    p = 1
+    while p < n:
+        p *= 2
+    return p
+
+
+def layout(boxes, width, padding):
+    """Shelf packing in reading order. Returns positions and the height used."""
+    positions = []
+    x, y, shelf = padding, padding, 0
+    for w, h in boxes:
+        if x + w + padding > width:
+            x, y, shelf = padding, y + shelf + padding, 0
+        positions.append((x, y))
+        x += w + padding
+        shelf = max(shelf, h)
+    return positions, y + shelf + padding
+
+
+def edt_1d(f):
+    """Squared distance transform of a sampled function (Felzenszwalb and Huttenlocher)."""
+    n = len(f)
+    d = [0.0]*n
+    v = [0]*n
+    z = [0.0]*(n + 1)
+    k = 0
+    z[0], z[1] = -INF, INF
+    for q in range(1, n):
+        s = ((f[q] + q*q) - (f[v[k]] + v[k]*v[k])) / (2*q - 2*v[k])
+        while s <= z[k]:
+            k -= 1
+            s = ((f[q] + q*q) - (f[v[k]] + v[k]*v[k])) / (2*q - 2*v[k])
+        k += 1
+        v[k], z[k], z[k + 1] = q, s, INF
+    k = 0
+    for q in range(n):
+        while z[k + 1] < q:
+            k += 1
+        d[q] = (q - v[k])**2 + f[v[k]]
+    return d
+
+
+def edt(seeds, w, h):
+    """Squared distance from every pixel to the nearest seed pixel."""
+    rows = []
+    for y in range(h):
+        rows.append(edt_1d([0.0 if seeds[y*w + x] else INF for x in range(w)]))
+    out = [0.0]*(w*h)
+    for x in range(w):
+        column = edt_1d([rows[y][x] for y in range(h)])
+        for y in range(h):
+            out[y*w + x] = column[y]
+    return out
+
+
+def bitmap_glyph(font, c):
+    left, top, right, bottom = font.getbbox(c)
+    w, h = max(0, right - left), max(0, bottom - top)
+    mask = Image.new('L', (w, h), 0)
+    if w and h:
+        ImageDraw.Draw(mask).text((-left, -top), c, font=font, fill=255)
+    return mask, left, top, int(round(font.getlength(c)))
+
+
+def sdf_glyph(font, c):
+    scale = SDF_UPSCALE
+    left, top, right, bottom = font.getbbox(c)
+    advance = int(round(font.getlength(c) / scale))
+    if right <= left or bottom <= top:
+        return Image.new('L', (0, 0), 0), 0, 0, advance
+
+    # Glyph box in atlas pixels, grown by the spread
+    x0, y0 = left // scale - SDF_SPREAD, top // scale - SDF_SPREAD
+    w = -(-right // scale) + SDF_SPREAD - x0
+    h = -(-bottom // scale) + SDF_SPREAD - y0
+
+    big = Image.new('L', (w*scale, h*scale), 0)
+    ImageDraw.Draw(big).text((-x0*scale, -y0*scale), c, font=font, fill=255)
+    pixels = big.tobytes()
+    inside = [p >= 128 for p in pixels]
+    outside = [not p for p in inside]
+
+    bw, bh = w*scale, h*scale
+    to_inside = edt(inside, bw, bh)
+    to_outside = edt(outside, bw, bh)
+
+    # Sample the signed distance at the center of every atlas pixel
+    field = bytearray(w*h)
+    spread = float(SDF_SPREAD*scale)
+    for y in range(h):
+        for x in range(w):
+            i = (y*scale + scale//2)*bw + x*scale + scale//2
+            distance = math.sqrt(to_outside[i]) - math.sqrt(to_inside[i])
+            value = 0.5 + 0.5*distance / spread
+            field[y*w + x] = max(0, min(255, int(round(value*255))))
+    return Image.frombytes('L', (w, h), bytes(field)), x0, y0, advance
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Renders a bitmap font for the app labels")
+    parser.add_argument('--font', required=True, help='TrueType font to render')
+    parser.add_argument('--db', help='database whose pictogram names must be covered')
+    parser.add_argument('--out', required=True, help='output path without extension')
+    parser.add_argument('--sdf', action='store_true', help='store a distance field instead of coverage')
+    parser.add_argument('--width', type=int, default=1024)
+    parser.add_argument('--padding', type=int, default=2)
+    args = parser.parse_args()
+
+    size = SDF_FONT_SIZE if args.sdf else FONT_SIZE
+    scale = SDF_UPSCALE if args.sdf else 1
+    font = ImageFont.truetype(args.font, size*scale)
+    ascent, descent = (int(round(float(m) / scale)) for m in font.getmetrics())
+    try:
+        chars = charset(sqlite3.connect('file:%s?mode=ro' % args.db, uri=True) if args.db else None)
+    except sqlite3.OperationalError as error:
+        sys.exit('%s: %s' % (args.db, error))
+
+    glyphs = [(c,) + (sdf_glyph(font, c) if args.sdf else bitmap_glyph(font, c)) for c in chars]
+
+    positions, height = layout([g[1].size for g in glyphs], args.width, args.padding)
+    height = power_of_two(height)
+
+    mask = Image.new('L', (args.width, height), 0)
+    for (c, glyph, left, top, advance), position in zip(glyphs, positions):
+        mask.paste(glyph, position)
+
+    # White glyphs, colored by the labels
+    atlas = Image.new('RGBA', mask.size, (255, 255, 255, 0))
+    atlas.putalpha(mask)
+    atlas.save(args.out + '.png', optimize=True)
+
+    texture = os.path.basename(args.out) + '.png'
+    spread = SDF_SPREAD if args.sdf else 0
+    with open(args.out + '.fnt', 'w', encoding='utf-8') as f:
+        f.write('info face="%s" size=%d bold=0 italic=0 charset="" unicode=1 stretchH=100 smooth=1 aa=1 '
+                'padding=%d,%d,%d,%d spacing=%d,%d\n'
+                % (os.path.basename(args.out), size, spread, spread, spread, spread, args.padding, args.padding))
+        f.write('common lineHeight=%d base=%d scaleW=%d scaleH=%d pages=1 packed=0\n'
+                % (ascent + descent, ascent, args.width, height))
+        f.write('page id=0 file="%s"\n' % texture)
+        f.write('chars count=%d\n' % len(glyphs))
+        for (c, glyph, left, top, advance), (x, y) in zip(glyphs, positions):
+            f.write('char id=%d x=%d y=%d width=%d height=%d xoffset=%d yoffset=%d xadvance=%d page=0 chnl=0\n'
+                    % (ord(c), x, y, glyph.size[0], glyph.size[1], left, top, advance))
+        f.write('kernings count=0\n')
+
+    print('%d glyphs in a %dx%d texture' % (len(glyphs), args.width, height))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+#
+# PictoConnection
+#
+# Writes a pyramid of downscaled copies of every pictogram image, so the
+# app decodes and uploads an image close to its size on screen instead of
+# the full one.
+#
+#   tools/build_pyramid.py --db proj.android/assets/picto_connection.db \
+#       --resources proj.android/assets/images
+#
+# Levels are written next to the image as <name>@<level>.png, with their
+# longest side being the level size. Levels as big as the image or bigger
+# are skipped, the image itself serves them. Requires Pillow.
+#
+# Copyright (C) 2014 ITIOX <itiox@itiox.com>
+# License GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+
+import argparse
+import os
+import sqlite3
+import sys
+
+from PIL import Image
+
+# Must match PictoImagePyramid.cpp
+LEVELS = (64, 128, 256, 512)
+
+
+def level_path(image, level):
+    # Must match PictoImagePyramid::level
+    return '%s@%d.png' % (os.path.splitext(image)[0], level)
+
+
+def images(db):
+    return sorted(set(image for (image,) in db.execute('SELECT image FROM pictograms WHERE image IS NOT NULL')))
+
+
+def build(path, force):
+    source = Image.open(path).convert('RGBA')
+    longest = max(source.size)
+    written = 0
+    for level in LEVELS:
+        if level >= longest:
+            break
+        out = level_path(path, level)
+        if not force and os.path.exists(out) and os.path.getmtime(out) >= os.path.getmtime(path):
+            continue
+        scale = float(level) / longest
+        size = (max(1, int(round(source.size[0]*scale))), max(1, int(round(source.size[1]*scale))))
+        source.resize(size, Image.LANCZOS).save(out, optimize=True)
+        written += 1
+    return written
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Builds the image pyramid of every pictogram")
+    parser.add_argument('--db', required=True)
+    parser.add_argument('--resources', required=True)
+    parser.add_argument('--force', action='store_true', help='rebuild levels newer than their image')
+    args = parser.parse_args()
+
+    try:
+        db = sqlite3.connect('file:%s?mode=ro' % args.db, uri=True)
+        names = images(db)
+    except sqlite3.OperationalError as error:
+        sys.exit('%s: %s' % (args.db, error))
+
+    written = 0
+    for image in names:
+        path = os.path.join(args.resources, image)
+        if not os.path.exists(path):
+            print('missing image %s' % image, file=sys.stderr)
+            continue
+        written += build(path, args.force)
+    print('%d levels written' % written)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+#
+# PictoConnection
+#
+# Writes the tags and difficulty levels of every pictogram into the catalog,
+# the data behind the tag filters of picto::database::filter.
+#
+#   tools/build_tags.py --db proj.android/assets/picto_connection.db
+#
+# Pictograms are tagged with every category they're found under, renamed
+# through CATEGORY_TAGS, plus the tags listed in TAGS. Categories are tagged
+# "category". Levels go from 1 to 3 with the number of words of the name in
+# the locale, a first guess meant to be edited by hand in the tables.
+#
+# Copyright (C) 2014 ITIOX <itiox@itiox.com>
+# License GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+
+import argparse
+import sqlite3
+import sys
+
+ROOT = 'picto_connection'
+
+CATEGORY_TAGS = {
+    'activity': 'activity',
+    'clothing': 'clothing',
+    'feeding': 'food',
+    'grooming': 'grooming',
+    'help': 'help',
+    'home': 'home',
+    'outdoors': 'outdoors',
+}
+
+TAGS = {
+    'verb': ('blow_dry_your_hair', 'brushing_teeth', 'change_pad', 'combing', 'cut_paper', 'dressing_up',
+             'paint', 'read', 'shave', 'shit', 'shower', 'stick', 'toweling', 'undress', 'write'),
+    'person': ('firefighters', 'police'),
+    'place': ('bowling', 'home', 'outdoors', 'park', 'school', 'street'),
+    'sport': ('basketball', 'bicycle', 'bowling', 'skates', 'soccer', 'swimming', 'tennis'),
+    'transport': ('ambulance', 'bicycle', 'bus', 'taxi', 'train'),
+    # Navigation pictograms, never part of a board
+    'hidden': ('back', 'picto_connection', 'settings'),
+}
+
+MAX_LEVEL = 3
+
+
+def ancestors(parents, identifier):
+    found, pending = set(), list(parents.get(identifier, ()))
+    while pending:
+        parent = pending.pop()
+        if parent not in found:
+            found.add(parent)
+            pending.extend(parents.get(parent, ()))
+    return found
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Writes pictogram tags and levels into the catalog")
+    parser.add_argument('--db', required=True, help='catalog to update')
+    parser.add_argument('--locale', default='es', help='locale whose names set the levels')
+    args = parser.parse_args()
+
+    try:
+        db = sqlite3.connect('file:%s?mode=rw' % args.db, uri=True)
+    except sqlite3.OperationalError as error:
+        sys.exit('%s: %s' % (args.db, error))
+
+    parents, childs = {}, set()
+    for parent, child in db.execute('SELECT parent, child FROM relationships'):
+        parents.setdefault(child, set()).add(parent)
+        childs.add(parent)
+
+    tags = set()
+    names = dict(db.execute('SELECT id, name FROM pictograms WHERE locale=?', (args.locale,)))
+    for identifier in names:
+        for category in ancestors(parents, identifier):
+            if category in CATEGORY_TAGS:
+                tags.add((identifier, CATEGORY_TAGS[category]))
+        if identifier in childs and identifier != ROOT:
+            tags.add((identifier, 'category'))
+    for tag, identifiers in TAGS.items():
+        tags.update((identifier, tag) for identifier in identifiers if identifier in names)
+
+    levels = [(identifier, min(MAX_LEVEL, len(name.split()))) for identifier, name in names.items()]
+
+    with db:
+        db.execute('CREATE TABLE IF NOT EXISTS "tags" ("pictogram" VARCHAR NOT NULL , "tag" VARCHAR NOT NULL , '
+                   'PRIMARY KEY ("pictogram", "tag"))')
+        db.execute('CREATE TABLE IF NOT EXISTS "levels" ("pictogram" VARCHAR PRIMARY KEY NOT NULL , '
+                   '"level" INTEGER NOT NULL)')
+        db.execute('DELETE FROM tags')
+        db.execute('DELETE FROM levels')
+        db.executemany('INSERT INTO tags VALUES (?, ?)', sorted(tags))
+        db.executemany('INSERT INTO levels VALUES (?, ?)', sorted(levels))
+    db.execute('VACUUM')
+
+    print('%d tags and %d levels for %d pictograms' % (len(tags), len(levels), len(names)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+#
+# PictoConnection
+#
+# Converts the pictogram images, thumbnails and pyramid levels into raw
+# texture blobs the app uploads without decoding a PNG.
+#
+#   tools/convert_textures.py --db proj.android/assets/picto_connection.db \
+#       --resources proj.android/assets/images --resources proj.android/assets/thumbs [--lz4]
+#
+# Each <name>.png gets a <name>.ptex next to it: a 16 byte header and the
+# premultiplied pixels in the format the image needs, RGB565 for opaque
+# images, RGBA4444 when it loses little and RGBA8888 otherwise. With --lz4
+# the pixels are stored as an LZ4 block when that makes the blob smaller.
+# Requires Pillow.
+#
+# Header, little endian:
+#   char[4] "PTEX", u8 version, u8 format, u8 flags, u8 reserved,
+#   u16 width, u16 height, u32 size of the pixels
+#
+# Copyright (C) 2014 ITIOX <itiox@itiox.com>
+# License GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+
+import argparse
+import glob
+import math
+import os
+import sqlite3
+import struct
+import sys
+
+# Must match PictoRawTexture.cpp
+VERSION = 1
+FORMAT_RGBA8888 = 0
+FORMAT_RGBA4444 = 1
+FORMAT_RGB565 = 2
+FLAG_LZ4 = 1
+
+# RGBA4444 is used when quantizing keeps the image above this PSNR
+MIN_PSNR_4444 = 38.0
+
+# LZ4 blocks must save at least this fraction of the pixels
+MIN_LZ4_SAVING = 0.1
+
+
+def premultiply(pixels):
+    # Same rounding as CC_RGB_PREMULTIPLY_ALPHA
+    out = bytearray(pixels)
+    for i in range(0, len(out), 4):
+        a = out[i + 3] + 1
+        out[i] = (out[i]*a) >> 8
+        out[i + 1] = (out[i + 1]*a) >> 8
+        out[i + 2] = (out[i + 2]*a) >> 8
+    return out
+
+
+def psnr_4444(pixels):
+    error = 0
+    for value in pixels:
+        quantized = (value >> 4)*17
+        error += (value - quantized)**2
+    if error == 0:
+        return float('inf')
+    return 10*math.log10(255.0**2*len(pixels) / error)
+
+
+def pack_4444(pixels):
+    out = bytearray()
+    for i in range(0, len(pixels), 4):
+        r, g, b, a = pixels[i:i + 4]
+        out += struct.pack('<H', (r >> 4) << 12 | (g >> 4) << 8 | (b >> 4) << 4 | a >> 4)
+    return out
+
+
+def pack_565(pixels):
+    out = bytearray()
+    for i in range(0, len(pixels), 4):
+        r, g, b = pixels[i:i + 3]
+        out += struct.pack('<H', (r >> 3) << 11 | (g >> 2) << 5 | b >> 3)
+    return out
+
+
+def lz4_compress(data):
+    """LZ4 block, greedy matching on 4 byte hashes."""
+    out = bytearray()
+
+    def length(n):
+        while n >= 255:
+            out.append(255)
+            n -= 255
+        out.append(n)
+
+    def sequence(literals, offset=0, match=0):
+        token = min(len(literals), 15) << 4
+        if offset:
+            token |= min(match - 4, 15)
+        out.append(token)
+        if len(literals) >= 15:
+            length(len(literals) - 15)
+        out.extend(literals)
+        if offset:
+            out.extend(struct.pack('<H', offset))
+            if match - 4 >= 15:
+                length(match - 4 - 15)
+
+    n = len(data)
+    table = {}
+    anchor = 0
+    i = 0
+    # The last match starts 12 bytes before the end, the last 5 are literals
+    while i < n - 12:
+        key = bytes(data[i:i + 4])
+        candidate = table.get(key)
+        table[key] = i
+        if candidate is None or i - candidate > 65535:
+            i += 1
+            continue
+        match = 4
+        while i + match < n - 5 and data[candidate + match] == data[i + match]:
+            match += 1
+        sequence(data[anchor:i], i - candidate, match)
+        i += match
+        anchor = i
+    sequence(data[anchor:])
+    return bytes(out)
+
+
+def convert(path, lz4):
+    from PIL import Image
+
+    image = Image.open(path).convert('RGBA')
+    width, height = image.size
+    pixels = image.tobytes()
+    opaque = all(pixels[i] == 255 for i in range(3, len(pixels), 4))
+
+    if opaque:
+        fmt, data = FORMAT_RGB565, pack_565(pixels)
+    else:
+        pixels = premultiply(pixels)
+        if psnr_4444(pixels) >= MIN_PSNR_4444:
+            fmt, data = FORMAT_RGBA4444, pack_4444(pixels)
+        else:
+            fmt, data = FORMAT_RGBA8888, bytes(pixels)
+
+    flags = 0
+    stored = data
+    if lz4:
+        compressed = lz4_compress(data)
+        if len(compressed) <= (1 - MIN_LZ4_SAVING)*len(data):
+            flags, stored = FLAG_LZ4, compressed
+
+    with open(os.path.splitext(path)[0] + '.ptex', 'wb') as f:
+        f.write(b'PTEX')
+        f.write(struct.pack('<BBBBHHI', VERSION, fmt, flags, 0, width, height, len(data)))
+        f.write(stored)
+    return fmt, flags
+
+
+def find(name, resources):
+    # First directory holding the file, like the app's search paths
+    for directory in resources:
+        path = os.path.join(directory, name)
+        if os.path.exists(path):
+            return path
+    return os.path.join(resources[0], name)
+
+
+def images(db, resources):
+    paths = set()
+    for image, thumb in db.execute('SELECT image, thumb FROM pictograms'):
+        for name in (image, thumb):
+            if name:
+                paths.add(find(name, resources))
+    # Pyramid levels written by build_pyramid.py
+    for path in list(paths):
+        paths.update(glob.glob(glob.escape(os.path.splitext(path)[0]) + '@*.png'))
+    return sorted(paths)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Converts pictogram images into raw texture blobs")
+    parser.add_argument('--db', required=True)
+    parser.add_argument('--resources', required=True, action='append', help='directory of the images, repeated for each one')
+    parser.add_argument('--lz4', action='store_true', help='store the pixels as LZ4 blocks when smaller')
+    args = parser.parse_args()
+
+    try:
+        db = sqlite3.connect('file:%s?mode=ro' % args.db, uri=True)
+        paths = images(db, args.resources)
+    except sqlite3.OperationalError as error:
+        sys.exit('%s: %s' % (args.db, error))
+
+    counts = {}
+    for path in paths:
+        if not os.path.exists(path):
+            print('missing image %s' % path, file=sys.stderr)
+            continue
+        key = convert(path, args.lz4)
+        counts[key] = counts.get(key, 0) + 1
+
+    names = {FORMAT_RGBA8888: 'RGBA8888', FORMAT_RGBA4444: 'RGBA4444', FORMAT_RGB565: 'RGB565'}
+    for (fmt, flags), count in sorted(counts.items()):
+        print('%s%s: %d' % (names[fmt], ' LZ4' if flags & FLAG_LZ4 else '', count))
+
+
+if __name__ == '__main__':
+    main()
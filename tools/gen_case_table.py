@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+#
+# PictoConnection
+#
+# Prints the uppercase table used by picto::conversions::toupper, and the
+# folding table used by PictoNameIndex::fold, from the Unicode data of the
+# running Python.
+#
+#   tools/gen_case_table.py
+#
+# Covers U+0000 to U+017F, Basic Latin, Latin-1 and Latin Extended-A, the
+# glyphs of tools/build_font.py. Characters whose uppercase is more than
+# one character or falls outside the range map to themselves; toupper
+# handles the German sharp s apart.
+#
+# The folding table maps letters to their uppercase without diacritics,
+# keeps digits and maps every other character to a space. Letters with no
+# decomposition, like the Nordic ones, are folded through FOLD_EXTRA.
+#
+# Copyright (C) 2014 ITIOX <itiox@itiox.com>
+# License GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+
+import unicodedata
+
+# Must match PICTO_UPPER_TABLE_SIZE in PictoUpperCase.h
+SIZE = 0x180
+
+PER_LINE = 8
+
+FOLD_EXTRA = {
+    'Æ': 'A', 'Ð': 'D', 'Ø': 'O', 'Þ': 'T', 'Đ': 'D', 'Ħ': 'H', 'ı': 'I',
+    'ĸ': 'K', 'Ŀ': 'L', 'Ł': 'L', 'Ŋ': 'N', 'Œ': 'O', 'Ŧ': 'T',
+}
+
+
+def upper(c):
+    u = chr(c).upper()
+    if len(u) != 1 or ord(u) >= SIZE:
+        return c
+    return ord(u)
+
+
+def fold(c):
+    if c == 0xdf:
+        return c
+    if not unicodedata.category(chr(c))[0] in 'LN':
+        return ord(' ')
+    u = chr(upper(c))
+    if u in FOLD_EXTRA:
+        return ord(FOLD_EXTRA[u])
+    base = unicodedata.normalize('NFD', u)[0]
+    return ord(base) if ord(base) < SIZE else ord(u)
+
+
+def table(name, values):
+    print('        const unsigned short %s[PICTO_UPPER_TABLE_SIZE] = {' % name)
+    for i in range(0, SIZE, PER_LINE):
+        line = ', '.join('0x%04x' % v for v in values[i:i + PER_LINE])
+        print('            %s%s' % (line, ',' if i + PER_LINE < SIZE else ''))
+    print('        };')
+
+
+def main():
+    print('        // Generated by tools/gen_case_table.py')
+    table('g_upper_', [upper(c) for c in range(SIZE)])
+    print('        ')
+    print('        // Generated by tools/gen_case_table.py')
+    table('g_fold_', [fold(c) for c in range(SIZE)])
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+#
+# PictoConnection
+#
+# Compares, for every category grid, what drawing and loading it costs with
+# a card per node against the card sheets and thumbnail atlases.
+#
+#   tools/measure_sheets.py --db proj.android/assets/picto_connection.db \
+#       --resources proj.android/assets/thumbs
+#
+# Load time is the time to read and decode the PNGs a grid needs, measured
+# on this machine with Pillow: one thumbnail per node before, the atlas pages
+# written by pack_atlases.py after. Draw calls follow from the node tree:
+# before, every node drew its CCLayerColor, its card and the hidden speaker
+# highlight; now the cards of a grid are one batch and the highlight is only
+# visible while a sound plays. Names the glyph atlas doesn't cover add a
+# draw per node on both sides and are left out. On a device, the counts can
+# be checked with CCDirector::setDisplayStats(true).
+#
+# Copyright (C) 2014 ITIOX <itiox@itiox.com>
+# License GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+
+import argparse
+import os
+import sqlite3
+import sys
+import time
+
+from PIL import Image
+
+import pack_atlases
+
+DRAWS_PER_NODE = 3
+
+
+def decode_time(paths, rounds):
+    """Best time over rounds to read and decode every path, in ms."""
+    best = None
+    for _ in range(rounds):
+        start = time.perf_counter()
+        for path in paths:
+            with open(path, 'rb') as f:
+                Image.open(f).convert('RGBA').load()
+        elapsed = (time.perf_counter() - start)*1000.0
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measures grids drawn with card sheets against a card per node")
+    parser.add_argument('--db', required=True)
+    parser.add_argument('--resources', required=True)
+    parser.add_argument('--atlases', help='defaults to <resources>/atlases')
+    parser.add_argument('--rounds', type=int, default=20)
+    args = parser.parse_args()
+
+    atlases = args.atlases or os.path.join(args.resources, 'atlases')
+
+    try:
+        db = sqlite3.connect('file:%s?mode=ro' % args.db, uri=True)
+        thumb_of = pack_atlases.thumbs(db)
+        categories = pack_atlases.categories(db)
+    except sqlite3.OperationalError as error:
+        sys.exit('%s: %s' % (args.db, error))
+
+    print('%-18s %5s %7s %7s %7s %7s %9s %9s' % ('category', 'nodes', 'pngs', 'pages',
+                                                 'draws', 'draws', 'load ms', 'load ms'))
+    print('%-18s %5s %7s %7s %7s %7s %9s %9s' % ('', '', 'before', 'after', 'before', 'after', 'before', 'after'))
+
+    totals = [0]*6
+    for category, children in sorted(categories.items()):
+        thumbs = [os.path.join(args.resources, thumb_of[child]) for child in children
+                  if child in thumb_of and os.path.exists(os.path.join(args.resources, thumb_of[child]))]
+
+        pages = []
+        while True:
+            page = os.path.join(atlases, '%s-%d.png' % (pack_atlases.atlas_name(category), len(pages)))
+            if not os.path.exists(page):
+                break
+            pages.append(page)
+        if not thumbs or not pages:
+            continue
+
+        row = [len(thumbs), len(pages), DRAWS_PER_NODE*len(children), 1,
+               decode_time(thumbs, args.rounds), decode_time(pages, args.rounds)]
+        totals = [a + b for a, b in zip(totals, row)]
+        print('%-18s %5d %7d %7d %7d %7d %9.2f %9.2f' % ((category, len(children)) + tuple(row)))
+
+    print('%-18s %5s %7d %7d %7d %7d %9.2f %9.2f' % (('total', '') + tuple(totals)))
+
+
+if __name__ == '__main__':
+    main()
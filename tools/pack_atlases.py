@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+#
+# PictoConnection
+#
+# Packs the thumbnails of the children of every category in the database
+# into atlas pages, with cocos2d plist metadata, so a grid loads a texture
+# per page instead of a PNG per pictogram.
+#
+#   tools/pack_atlases.py --db proj.android/assets/picto_connection.db \
+#       --resources proj.android/assets/thumbs
+#
+# Writes <resources>/atlases/<category>-<page>.png and .plist, found by the
+# app through the thumbs search path. Frames are named after the pictogram
+# identifiers. Requires Pillow.
+#
+# Copyright (C) 2014 ITIOX <itiox@itiox.com>
+# License GPL-3.0+ <http://spdx.org/licenses/GPL-3.0+>
+
+import argparse
+import os
+import plistlib
+import re
+import sqlite3
+import sys
+
+from PIL import Image
+
+
+def atlas_name(category):
+    # Must match PictoCardCache::atlasName
+    return re.sub(r'[^A-Za-z0-9_-]', '_', category)
+
+
+def categories(db):
+    children = {}
+    for parent, child in db.execute('SELECT parent, child FROM relationships ORDER BY rowid'):
+        children.setdefault(parent, [])
+        if child not in children[parent]:
+            children[parent].append(child)
+    return children
+
+
+def thumbs(db):
+    result = {}
+    for identifier, thumb in db.execute('SELECT id, thumb FROM pictograms WHERE thumb IS NOT NULL'):
+        result.setdefault(identifier, thumb)
+    return result
+
+
+def pack(sizes, max_size, padding):
+    """Shelf packing, tallest first. Returns pages of (index, x, y)."""
+    order = sorted(range(len(sizes)), key=lambda i: (-sizes[i][1], -sizes[i][0]))
+    pages = []
+    page, x, y, shelf = [], 0, 0, 0
+    for i in order:
+        w, h = sizes[i][0] + 2*padding, sizes[i][1] + 2*padding
+        if x + w > max_size:
+            x, y, shelf = 0, y + shelf, 0
+        if y + h > max_size:
+            pages.append(page)
+            page, x, y, shelf = [], 0, 0, 0
+        page.append((i, x + padding, y + padding))
+        x += w
+        shelf = max(shelf, h)
+    if page:
+        pages.append(page)
+    return pages
+
+
+def power_of_two(n):
+    p = 1
+    while p < n:
+        p *= 2
+    return p
+
+
+def write_page(images, names, placement, path):
+    width = power_of_two(max(x + images[i].size[0] for i, x, y in placement))
+    height = power_of_two(max(y + images[i].size[1] for i, x, y in placement))
+
+    atlas = Image.new('RGBA', (width, height), (0, 0, 0, 0))
+    frames = {}
+    for i, x, y in placement:
+        w, h = images[i].size
+        atlas.paste(images[i], (x, y))
+        frames[names[i]] = {
+            'frame': '{{%d,%d},{%d,%d}}' % (x, y, w, h),
+            'offset': '{0,0}',
+            'rotated': False,
+            'sourceColorRect': '{{0,0},{%d,%d}}' % (w, h),
+            'sourceSize': '{%d,%d}' % (w, h),
+        }
+    atlas.save(path + '.png', optimize=True)
+
+    texture = os.path.basename(path) + '.png'
+    with open(path + '.plist', 'wb') as f:
+        plistlib.dump({
+            'frames': frames,
+            'metadata': {
+                'format': 2,
+                'realTextureFileName': texture,
+                'size': '{%d,%d}' % (width, height),
+                'textureFileName': texture,
+            },
+        }, f)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Packs category thumbnails into atlas pages")
+    parser.add_argument('--db', required=True)
+    parser.add_argument('--resources', required=True)
+    parser.add_argument('--out', help='defaults to <resources>/atlases')
+    parser.add_argument('--max-size', type=int, default=1024)
+    parser.add_argument('--padding', type=int, default=1)
+    args = parser.parse_args()
+
+    out = args.out or os.path.join(args.resources, 'atlases')
+    os.makedirs(out, exist_ok=True)
+
+    try:
+        db = sqlite3.connect('file:%s?mode=ro' % args.db, uri=True)
+    except sqlite3.OperationalError as error:
+        sys.exit('%s: %s' % (args.db, error))
+    thumb_of = thumbs(db)
+
+    for category, children in sorted(categories(db).items()):
+        names, images = [], []
+        for child in children:
+            thumb = thumb_of.get(child)
+            if not thumb or not os.path.exists(os.path.join(args.resources, thumb)):
+                print('%s: no thumbnail for %s' % (category, child), file=sys.stderr)
+                continue
+            names.append(child)
+            images.append(Image.open(os.path.join(args.resources, thumb)).convert('RGBA'))
+        if not images:
+            continue
+
+        pages = pack([image.size for image in images], args.max_size, args.padding)
+        for n, placement in enumerate(pages):
+            write_page(images, names, placement, os.path.join(out, '%s-%d' % (atlas_name(category), n)))
+        print('%s: %d thumbnails in %d pages' % (category, len(images), len(pages)))
+
+
+if __name__ == '__main__':
+    main()